@@ -0,0 +1,172 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <chrono>
+#include <pthread.h>
+#include <sched.h>
+
+#include <boost/program_options.hpp>
+
+#include <handystats/chrono.hpp>
+
+using handystats::chrono::clock_source;
+using handystats::chrono::tsc_clock;
+
+uint64_t calls = 10000000;
+uint64_t threads = std::max<uint64_t>(std::thread::hardware_concurrency(), 2);
+uint64_t monotonicity_calls = 1000000;
+
+const std::pair<clock_source, const char*> sources[] = {
+	{clock_source::RDTSC, "RDTSC"},
+	{clock_source::RDTSC_LFENCE, "RDTSC_LFENCE"},
+	{clock_source::RDTSCP, "RDTSCP"},
+	{clock_source::RDTSC_MFENCE, "RDTSC_MFENCE"},
+	{clock_source::MONOTONIC, "CLOCK_MONOTONIC"},
+	{clock_source::REALTIME, "CLOCK_REALTIME"}
+};
+
+// average cost of tsc_clock::now() call in nanoseconds
+double measure_call_cost() {
+	int64_t checksum = 0;
+
+	const auto& start_time = std::chrono::steady_clock::now();
+	for (uint64_t call = 0; call < calls; ++call) {
+		checksum += tsc_clock::now().time_since_epoch().count();
+	}
+	const auto& end_time = std::chrono::steady_clock::now();
+
+	// prevent loop elimination
+	if (checksum == 42) {
+		std::cerr << "";
+	}
+
+	return double(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count()) / calls;
+}
+
+// threads pinned to different cores take timestamps ordered through shared atomic
+// timestamp taken after observing another thread's timestamp must not be less than observed one
+uint64_t measure_monotonicity_violations() {
+	std::atomic<int64_t> last_timestamp(0);
+	std::atomic<uint64_t> violations(0);
+	std::atomic<uint64_t> ready(0);
+
+	const uint64_t cpus = std::max<uint64_t>(std::thread::hardware_concurrency(), 1);
+
+	std::vector<std::thread> workers;
+	for (uint64_t thread = 0; thread < threads; ++thread) {
+		workers.push_back(std::thread(
+				[&, thread] () {
+					cpu_set_t cpu_set;
+					CPU_ZERO(&cpu_set);
+					CPU_SET(thread % cpus, &cpu_set);
+					pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+
+					ready.fetch_add(1);
+					while (ready.load() < threads) {
+					}
+
+					uint64_t local_violations = 0;
+					for (uint64_t call = 0; call < monotonicity_calls; ++call) {
+						int64_t observed = last_timestamp.load(std::memory_order_acquire);
+						const int64_t current = tsc_clock::now().time_since_epoch().count();
+						if (current < observed) {
+							++local_violations;
+						}
+						while (observed < current &&
+								!last_timestamp.compare_exchange_weak(observed, current, std::memory_order_acq_rel)
+							)
+						{
+						}
+					}
+
+					violations.fetch_add(local_violations);
+				}
+			));
+	}
+
+	for (auto& worker : workers) {
+		worker.join();
+	}
+
+	return violations.load();
+}
+
+int main(int argc, char** argv) {
+	namespace po = boost::program_options;
+	po::options_description desc("Options");
+	desc.add_options()
+		("help", "Print help messages")
+		("calls", po::value<uint64_t>(&calls)->default_value(calls),
+			"Number of calls to measure call cost"
+		)
+		("threads", po::value<uint64_t>(&threads)->default_value(threads),
+			"Number of threads (pinned to different cores) to check monotonicity"
+		)
+		("monotonicity-calls", po::value<uint64_t>(&monotonicity_calls)->default_value(monotonicity_calls),
+			"Number of calls per thread to check monotonicity"
+		)
+	;
+
+	po::variables_map vm;
+	try {
+		po::store(po::parse_command_line(argc, argv, desc), vm);
+		if (vm.count("help")) {
+			std::cout << desc << std::endl;
+			return 0;
+		}
+		po::notify(vm);
+	}
+	catch(po::error& e) {
+		std::cerr << "ERROR: " << e.what() << std::endl << std::endl;
+		std::cerr << desc << std::endl;
+		return 1;
+	}
+
+	if (calls == 0) {
+		std::cerr << "ERROR: number of calls must be greater than 0" << std::endl;
+		return 1;
+	}
+
+	std::cout << std::setw(16) << std::left << "source"
+		<< std::setw(12) << std::right << "ns/call"
+		<< std::setw(16) << std::right << "violations"
+		<< std::endl;
+
+	for (const auto& source : sources) {
+		std::cout << std::setw(16) << std::left << source.second;
+
+		if (!tsc_clock::set_source(source.first)) {
+			std::cout << std::setw(28) << std::right << "not supported" << std::endl;
+			continue;
+		}
+
+		const double call_cost = measure_call_cost();
+		const uint64_t violations = measure_monotonicity_violations();
+
+		std::cout << std::setw(12) << std::right << std::fixed << std::setprecision(2) << call_cost
+			<< std::setw(16) << std::right << violations
+			<< std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,166 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+
+#include <boost/program_options.hpp>
+
+#include <handystats/core.hpp>
+#include <handystats/metrics_dump.hpp>
+#include <handystats/measuring_points.hpp>
+
+uint64_t readers = 4;
+uint64_t metrics = 1000;
+uint64_t dump_interval = 1;
+uint64_t duration = 5;
+
+std::atomic<bool> stop_flag(false);
+
+struct reader_stats {
+	uint64_t reads;
+	uint64_t max_latency;
+	uint64_t total_latency;
+
+	reader_stats()
+		: reads(0)
+		, max_latency(0)
+		, total_latency(0)
+	{}
+};
+
+// reader polls the dump as exporters and health checks do
+void run_reader(reader_stats& stats) {
+	const std::string metric_name("dump_readers.counter.0");
+
+	while (!stop_flag.load(std::memory_order_relaxed)) {
+		const auto& start_time = std::chrono::steady_clock::now();
+
+		const auto& metrics_dump = HANDY_METRICS_DUMP();
+		metrics_dump->find(metric_name);
+
+		const uint64_t latency =
+			std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count();
+
+		stats.reads++;
+		stats.total_latency += latency;
+		stats.max_latency = std::max(stats.max_latency, latency);
+	}
+}
+
+// writer keeps metrics changing, so that new dumps are published every dump interval
+void run_writer() {
+	uint64_t step = 0;
+	while (!stop_flag.load(std::memory_order_relaxed)) {
+		HANDY_COUNTER_INCREMENT(("dump_readers.counter.%d", step % metrics));
+		++step;
+		if (step % metrics == 0) {
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+	}
+}
+
+int main(int argc, char** argv) {
+	namespace po = boost::program_options;
+	po::options_description desc("Options");
+	desc.add_options()
+		("help", "Print help messages")
+		("readers", po::value<uint64_t>(&readers)->default_value(readers),
+			"Number of threads polling metrics dump"
+		)
+		("metrics", po::value<uint64_t>(&metrics)->default_value(metrics),
+			"Number of metrics changed by the writer"
+		)
+		("dump-interval", po::value<uint64_t>(&dump_interval)->default_value(dump_interval),
+			"Metrics dump interval (in milliseconds)"
+		)
+		("duration", po::value<uint64_t>(&duration)->default_value(duration),
+			"Benchmark duration (in seconds)"
+		)
+	;
+
+	po::variables_map vm;
+	try {
+		po::store(po::parse_command_line(argc, argv, desc), vm);
+		if (vm.count("help")) {
+			std::cout << desc << std::endl;
+			return 0;
+		}
+		po::notify(vm);
+	}
+	catch(po::error& e) {
+		std::cerr << "ERROR: " << e.what() << std::endl << std::endl;
+		std::cerr << desc << std::endl;
+		return 1;
+	}
+
+	if (metrics == 0 || dump_interval == 0) {
+		std::cerr << "ERROR: number of metrics and dump interval must be greater than 0" << std::endl;
+		return 1;
+	}
+
+	HANDY_CONFIG_JSON(("{\"dump-interval\": " + std::to_string(dump_interval) + "}").c_str());
+	HANDY_INIT();
+
+	std::vector<reader_stats> stats(readers);
+	std::vector<std::thread> threads;
+
+	std::thread writer(run_writer);
+	for (uint64_t index = 0; index < readers; ++index) {
+		threads.push_back(std::thread(run_reader, std::ref(stats[index])));
+	}
+
+	const uint64_t start_version = HANDY_METRICS_DUMP()->version();
+	std::this_thread::sleep_for(std::chrono::seconds(duration));
+	const auto& metrics_dump = HANDY_METRICS_DUMP();
+
+	stop_flag.store(true);
+	writer.join();
+	for (auto thread = threads.begin(); thread != threads.end(); ++thread) {
+		thread->join();
+	}
+
+	reader_stats total;
+	for (auto reader = stats.begin(); reader != stats.end(); ++reader) {
+		total.reads += reader->reads;
+		total.total_latency += reader->total_latency;
+		total.max_latency = std::max(total.max_latency, reader->max_latency);
+	}
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "reads/s:          " << double(total.reads) / duration << std::endl;
+	std::cout << "avg read (ns):    " << (total.reads ? double(total.total_latency) / total.reads : 0.0) << std::endl;
+	std::cout << "max read (ns):    " << total.max_latency << std::endl;
+	std::cout << "dumps/s:          " << double(metrics_dump->version() - start_version) / duration << std::endl;
+
+	if (metrics_dump->find("handystats.metrics_dump.dump_time") != metrics_dump->end()) {
+		const auto& dump_time =
+			boost::get<handystats::metrics::gauge>(metrics_dump->at("handystats.metrics_dump.dump_time"));
+		std::cout << "dump time (us):   "
+			<< dump_time.values().get<handystats::statistics::tag::moving_avg>() << std::endl;
+	}
+
+	HANDY_FINALIZE();
+
+	return 0;
+}
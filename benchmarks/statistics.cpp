@@ -0,0 +1,139 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include <boost/program_options.hpp>
+
+#include <handystats/chrono.hpp>
+#include <handystats/statistics.hpp>
+
+using handystats::statistics;
+
+uint64_t updates = 1000000;
+uint64_t histogram_bins = 30;
+uint64_t moving_interval = 1000;
+uint64_t update_step = 10;
+
+const std::pair<statistics::tag::type, const char*> tag_sets[] = {
+	{statistics::tag::empty, "empty"},
+	{statistics::tag::value | statistics::tag::min | statistics::tag::max | statistics::tag::count, "value,min,max,count"},
+	{statistics::tag::moving_avg, "moving-avg"},
+	{statistics::tag::moving_avg | statistics::tag::rate | statistics::tag::timestamp, "moving-avg,rate,timestamp"},
+	{statistics::tag::quantile | statistics::tag::timestamp, "quantile,timestamp"},
+	{
+		statistics::tag::value | statistics::tag::min | statistics::tag::max |
+		statistics::tag::count | statistics::tag::sum | statistics::tag::avg |
+		statistics::tag::moving_count | statistics::tag::moving_sum | statistics::tag::moving_avg |
+		statistics::tag::quantile | statistics::tag::timestamp | statistics::tag::rate,
+		"all"
+	}
+};
+
+// average cost of statistics::update() call in nanoseconds
+double measure_update_cost(const statistics::tag::type& tags, const std::vector<statistics::time_point>& timestamps) {
+	handystats::config::statistics opts;
+	opts.tags = tags;
+	opts.histogram_bins = histogram_bins;
+	opts.moving_interval = handystats::chrono::duration(moving_interval, handystats::chrono::time_unit::MSEC);
+
+	statistics stats(opts);
+
+	const auto& start_time = std::chrono::steady_clock::now();
+	for (uint64_t update = 0; update < updates; ++update) {
+		stats.update(update % 1000, timestamps[update]);
+	}
+	const auto& end_time = std::chrono::steady_clock::now();
+
+	// prevent loop elimination
+	if (stats.tags() == 42 && stats.moving_avg() == 42) {
+		std::cerr << "";
+	}
+
+	return double(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count()) / updates;
+}
+
+int main(int argc, char** argv) {
+	namespace po = boost::program_options;
+	po::options_description desc("Options");
+	desc.add_options()
+		("help", "Print help messages")
+		("updates", po::value<uint64_t>(&updates)->default_value(updates),
+			"Number of updates per tags set"
+		)
+		("histogram-bins", po::value<uint64_t>(&histogram_bins)->default_value(histogram_bins),
+			"Number of histogram bins"
+		)
+		("moving-interval", po::value<uint64_t>(&moving_interval)->default_value(moving_interval),
+			"Moving interval (in milliseconds)"
+		)
+		("step", po::value<uint64_t>(&update_step)->default_value(update_step),
+			"Time step between updates (in microseconds)"
+		)
+	;
+
+	po::variables_map vm;
+	try {
+		po::store(po::parse_command_line(argc, argv, desc), vm);
+		if (vm.count("help")) {
+			std::cout << desc << std::endl;
+			return 0;
+		}
+		po::notify(vm);
+	}
+	catch(po::error& e) {
+		std::cerr << "ERROR: " << e.what() << std::endl << std::endl;
+		std::cerr << desc << std::endl;
+		return 1;
+	}
+
+	if (updates == 0) {
+		std::cerr << "ERROR: number of updates must be greater than 0" << std::endl;
+		return 1;
+	}
+
+	// timestamps are prepared in advance, so only statistics' update is measured
+	std::vector<statistics::time_point> timestamps;
+	timestamps.reserve(updates);
+
+	const auto& step = handystats::chrono::duration::convert_to(
+			handystats::chrono::time_unit::TICK,
+			handystats::chrono::duration(update_step, handystats::chrono::time_unit::USEC)
+		);
+	auto timestamp = statistics::clock::now();
+	for (uint64_t update = 0; update < updates; ++update) {
+		timestamps.push_back(timestamp);
+		timestamp += step;
+	}
+
+	std::cout << std::setw(32) << std::left << "tags"
+		<< std::setw(12) << std::right << "ns/update"
+		<< std::endl;
+
+	for (const auto& tag_set : tag_sets) {
+		std::cout << std::setw(32) << std::left << tag_set.second
+			<< std::setw(12) << std::right << std::fixed << std::setprecision(2)
+			<< measure_update_cost(tag_set.first, timestamps)
+			<< std::endl;
+	}
+
+	return 0;
+}
@@ -1,5 +1,5 @@
 Name: handystats
-Version: 1.11.6
+Version: 2.0.0
 Release: 1%{?dist}
 Summary: C++ library for collecting user-defined in-process runtime statistics with low overhead.
 Group: System Environment/Libraries
@@ -54,5 +54,6 @@ rm -rf %{buildroot}
 %defattr(-,root,root,-)
 %{_includedir}/handystats/*
 %{_libdir}/*handystats*.so*
+%{_bindir}/handystats-dump-reader
 
 #%changelog
@@ -0,0 +1,206 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_BINARY_DUMP_HPP_
+#define HANDYSTATS_BINARY_DUMP_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+
+#include <handystats/metrics.hpp>
+#include <handystats/metrics_dump.hpp>
+#include <handystats/statistics.hpp>
+
+/*
+ * Binary format of metrics dump (all numbers are little-endian):
+ *
+ * header (48 bytes):
+ *     "HSBD", format version (u16), reserved (u16), dump version (u64), base timestamp (u64, ms),
+ *     metrics count (u32), metrics index offset (u32), strings count (u32), string table offset (u32),
+ *     total size (u32), reserved (u32)
+ * metrics index -- offsets of metric records (u32 each) in the order of names
+ * metric records -- type (u8), name's string index (varint) and type specific data
+ * string table -- offsets of strings (u32 each, strings count + 1) followed by string data
+ *
+ * Statistics are stored as tags (varint) followed by fields of enabled tags in order of tag bits:
+ * doubles in 8 bytes, count as varint, timestamp as zigzag varint delta from base timestamp,
+ * histogram as bins count (varint) and fixed 16-byte bins (center, count),
+ * quantile as 5 doubles (p25, p50, p75, p90, p95).
+ */
+
+namespace handystats { namespace binary {
+
+static const uint16_t FORMAT_VERSION = 1;
+
+// Serializes metrics dump into the buffer replacing its content
+void write(const handystats::metrics_dump::dump_map&, std::string& buffer);
+
+std::string to_string(const handystats::metrics_dump::dump_map&);
+
+// Serializes only metrics of the view (e.g. HANDY_METRICS_DUMP_PREFIX("db.")) in the same format
+void write(const handystats::metrics_dump::dump_view&, std::string& buffer);
+std::string to_string(const handystats::metrics_dump::dump_view&);
+
+// Binary dump rendered at most once per dump version and shared between callers
+const std::shared_ptr<const std::string> to_shared_string(const handystats::metrics_dump::dump_map&);
+
+
+/*
+ * Zero-copy reader of binary dump.
+ * Nothing is copied or decoded in advance, metrics are located via index on access.
+ * Data should outlive the reader and the views obtained from it.
+ * Methods throw std::invalid_argument on malformed data.
+ */
+
+class statistics_view {
+public:
+	static const size_t QUANTILES_COUNT = 5;
+	// probabilities of stored quantiles
+	static const double QUANTILES[QUANTILES_COUNT];
+
+	statistics::tag::type tags() const;
+	bool enabled(const statistics::tag::type& tag) const;
+
+	// value of double-valued tag (value, min, max, sum, avg, moving-*, rate, entropy)
+	double get(const statistics::tag::type& tag) const;
+	uint64_t count() const;
+	// system time in milliseconds
+	uint64_t timestamp() const;
+	double quantile(const size_t& index) const;
+
+	size_t histogram_size() const;
+	// (center, count) of the bin
+	std::pair<double, double> histogram_bin(const size_t& index) const;
+
+private:
+	friend class metric_view;
+
+	statistics_view(const char* data, const char* end, const uint64_t& base_timestamp);
+
+	const char* field(const statistics::tag::type& tag) const;
+
+	static const size_t TAGS_COUNT = 16;
+
+	statistics::tag::type m_tags;
+	const char* m_end;
+	uint64_t m_base_timestamp;
+	const char* m_fields[TAGS_COUNT];
+	// end of encoded statistics
+	const char* m_next;
+};
+
+class metric_view {
+public:
+	struct exemplar {
+		int64_t value;
+		uint64_t instance_id;
+		// system time in milliseconds
+		uint64_t timestamp;
+	};
+
+	struct top_entry {
+		const char* key_data;
+		size_t key_size;
+		double count;
+		double error;
+	};
+
+	const char* name_data() const;
+	size_t name_size() const;
+	std::string name() const;
+
+	metrics::metric_index type() const;
+
+	// gauge, counter and timer
+	statistics_view values() const;
+	// timer
+	std::vector<exemplar> exemplars() const;
+	// attribute
+	metrics::attribute::value_type attribute_value() const;
+	// unique (estimate, total) and topk (total)
+	double estimate() const;
+	double total() const;
+	// unique and topk, system time in milliseconds
+	uint64_t timestamp() const;
+	// topk
+	std::vector<top_entry> top() const;
+	// span
+	statistics_view inclusive() const;
+	statistics_view self() const;
+
+private:
+	friend class reader;
+
+	metric_view(const class reader* reader, const char* data);
+
+	void check_type(const metrics::metric_index& type) const;
+
+	const class reader* m_reader;
+	const char* m_data;
+	const char* m_payload;
+	metrics::metric_index m_type;
+	uint64_t m_name_index;
+};
+
+class reader {
+public:
+	reader(const char* data, const size_t& size);
+	explicit reader(const std::string& buffer);
+
+	uint16_t format_version() const;
+	uint64_t version() const;
+	// system time of serialization in milliseconds
+	uint64_t timestamp() const;
+
+	size_t size() const;
+	metric_view operator[](const size_t& index) const;
+
+	// binary search by name, returns size() if there's no such metric
+	size_t find(const std::string& name) const;
+
+private:
+	friend class metric_view;
+	friend class statistics_view;
+
+	void init();
+	std::pair<const char*, size_t> string(const uint64_t& index) const;
+
+	const char* m_data;
+	size_t m_size;
+
+	uint64_t m_version;
+	uint64_t m_timestamp;
+	uint32_t m_metrics_count;
+	const char* m_index;
+	uint32_t m_strings_count;
+	const char* m_string_offsets;
+	const char* m_string_data;
+};
+
+}} // namespace handystats::binary
+
+
+std::string HANDY_BINARY_DUMP();
+
+// Memoised binary form of the current metrics dump
+const std::shared_ptr<const std::string> HANDY_BINARY_DUMP_SHARED();
+
+#endif // HANDYSTATS_BINARY_DUMP_HPP_
@@ -41,6 +41,16 @@ enum class clock_type {
 	SYSTEM // epoch - 1970 00:00:00 UT
 };
 
+// Sources of tsc_clock
+enum class clock_source {
+	RDTSC, // plain rdtsc, could be reordered with surrounding instructions
+	RDTSC_LFENCE, // lfence; rdtsc -- waits for preceding instructions
+	RDTSCP, // rdtscp -- waits for preceding instructions
+	RDTSC_MFENCE, // mfence; rdtsc -- waits for preceding instructions and memory stores
+	MONOTONIC, // POSIX CLOCK_MONOTONIC
+	REALTIME // POSIX CLOCK_REALTIME
+};
+
 }} // namespace handystats::chrono
 
 
@@ -88,6 +98,14 @@ struct time_point;
 struct tsc_clock {
 	// will return time_point with TSC clock type and TICK time unit
 	static time_point now();
+
+	// source is selected once on startup, see HANDY_CLOCK_SOURCE environment variable
+	static clock_source source();
+
+	// returns false if source is not supported, e.g. no rdtscp instruction
+	// could be called while other threads take time points,
+	// though time points taken from TSC and POSIX sources are not comparable
+	static bool set_source(const clock_source&);
 };
 
 struct system_clock {
@@ -314,6 +332,10 @@ struct time_point {
 		return m_since_epoch;
 	}
 
+	clock_type clock() const {
+		return m_clock;
+	}
+
 	/* Compound assignments */
 	time_point& operator+=(const duration& d) {
 		if (m_clock == clock_type::TSC) {
@@ -24,6 +24,8 @@ namespace handystats { namespace config { namespace metrics {
 
 struct counter {
 	statistics values;
+	// events are timestamped by the processor on receive instead of the measuring point
+	bool receive_time;
 
 	counter();
 };
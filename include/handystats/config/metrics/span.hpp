@@ -0,0 +1,37 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_CONFIG_METRICS_SPAN_HPP_
+#define HANDYSTATS_CONFIG_METRICS_SPAN_HPP_
+
+#include <cstddef>
+
+namespace handystats { namespace config { namespace metrics {
+
+// Statistics of span metrics are configured with timer options
+struct span {
+	// spans nested deeper are accounted in their ancestor's self time
+	size_t max_depth;
+	// maximum number of distinct span nodes
+	size_t max_nodes;
+
+	span();
+};
+
+}}} // namespace handystats::config::metrics
+
+#endif // HANDYSTATS_CONFIG_METRICS_SPAN_HPP_
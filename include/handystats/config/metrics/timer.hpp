@@ -18,6 +18,8 @@
 #ifndef HANDYSTATS_CONFIG_METRICS_TIMER_HPP_
 #define HANDYSTATS_CONFIG_METRICS_TIMER_HPP_
 
+#include <cstddef>
+
 #include <handystats/chrono.hpp>
 #include <handystats/config/statistics.hpp>
 
@@ -26,6 +28,10 @@ namespace handystats { namespace config { namespace metrics {
 struct timer {
 	chrono::duration idle_timeout;
 	statistics values;
+	// track instances on the measuring side and send single set event on stop
+	bool local_instances;
+	// number of the slowest samples kept with their instance ids, zero disables exemplars
+	size_t exemplars;
 
 	timer();
 };
@@ -0,0 +1,38 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_CONFIG_METRICS_UNIQUE_HPP_
+#define HANDYSTATS_CONFIG_METRICS_UNIQUE_HPP_
+
+#include <cstddef>
+
+#include <handystats/chrono.hpp>
+
+namespace handystats { namespace config { namespace metrics {
+
+struct unique {
+	// HyperLogLog sketch consists of 2^precision registers
+	// standard error of estimation is about 1.04 / sqrt(2^precision)
+	size_t precision;
+	chrono::duration moving_interval;
+
+	unique();
+};
+
+}}} // namespace handystats::config::metrics
+
+#endif // HANDYSTATS_CONFIG_METRICS_UNIQUE_HPP_
@@ -45,7 +45,8 @@
  *         }
  *     },
  *     "metrics-dump": {
- *         "interval": <value in msec>
+ *         "interval": <value in msec>,
+ *         "shared-memory": "<path of shared memory segment>"
  *     },
  *     "<pattern>": {
  *         <statistics opts>
@@ -58,6 +59,7 @@
  * {
  *     "enable": <boolean value>,
  *     "dump-interval": <value in msec>,
+ *     "dump-shared-memory": "<path of shared memory segment>",
  *     "defaults": {
  *         "moving-interval": <value in msec>,
  *         "histogram-bins": <integer value>,
@@ -72,6 +74,7 @@
  *     },
  *     "timer": {
  *         "idle-timeout": <value in msec>,
+ *         "local-instances": <boolean value>,
  *         <statistics opts>
  *     },
  *     "<pattern>": {
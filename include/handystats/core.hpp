@@ -43,7 +43,8 @@
  *         }
  *     },
  *     "metrics-dump": {
- *         "interval": <value in msec>
+ *         "interval": <value in msec>,
+ *         "shared-memory": "<path of shared memory segment>"
  *     },
  *     "<pattern>": {
  *         <statistics opts>
@@ -56,6 +57,7 @@
  * {
  *     "enable": <boolean value>,
  *     "dump-interval": <value in msec>,
+ *     "dump-shared-memory": "<path of shared memory segment>",
  *     "defaults": {
  *         "moving-interval": <value in msec>,
  *         "histogram-bins": <integer value>,
@@ -70,6 +72,7 @@
  *     },
  *     "timer": {
  *         "idle-timeout": <value in msec>,
+ *         "local-instances": <boolean value>,
  *         <statistics opts>
  *     },
  *     "<pattern>": {
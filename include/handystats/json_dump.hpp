@@ -19,15 +19,48 @@
 #define HANDYSTATS_JSON_DUMP_HPP_
 
 #include <string>
+#include <map>
+#include <memory>
 
+#include <handystats/metrics.hpp>
 #include <handystats/metrics_dump.hpp>
 
 namespace handystats { namespace json {
 
 std::string to_string(const std::map<std::string, handystats::metrics::metric_variant>&);
+std::string to_string(const handystats::metrics_dump::dump_map&, const bool& compact = false);
+
+// Serializes metrics dump into the buffer replacing its content.
+// Buffer's capacity is reused, so repeated dumps into the same buffer don't allocate.
+void write(const handystats::metrics_dump::dump_map&, std::string& buffer, const bool& compact = false);
+
+// Serializes metrics dump into file descriptor.
+// Returns false if write has failed (errno is set by the failed write).
+bool write(const handystats::metrics_dump::dump_map&, const int& fd, const bool& compact = false);
+
+// Serializes only metrics of the view (e.g. HANDY_METRICS_DUMP_PREFIX("db.")) in the same format
+std::string to_string(const handystats::metrics_dump::dump_view&, const bool& compact = false);
+void write(const handystats::metrics_dump::dump_view&, std::string& buffer, const bool& compact = false);
+bool write(const handystats::metrics_dump::dump_view&, const int& fd, const bool& compact = false);
+
+// JSON of the metrics dump delta:
+// {"version": ..., "since": ..., "full": ..., "changed": {<metrics>}, "removed": [<names>]}
+std::string to_string(const handystats::metrics_dump::dump_delta&, const bool& compact = false);
+void write(const handystats::metrics_dump::dump_delta&, std::string& buffer, const bool& compact = false);
+
+// JSON of the metrics dump rendered at most once per dump version and shared between callers
+const std::shared_ptr<const std::string> to_shared_string(
+		const handystats::metrics_dump::dump_map&, const bool& compact = false
+	);
 
 }} // namespace handystats::json
 
 std::string HANDY_JSON_DUMP();
 
+// Memoised JSON of the current metrics dump, the same dump version is never serialized twice
+const std::shared_ptr<const std::string> HANDY_JSON_DUMP_SHARED(const bool& compact = false);
+
+// JSON of metrics changed and removed since the dump of the given version
+std::string HANDY_JSON_DUMP_SINCE(const uint64_t& version, const bool& compact = false);
+
 #endif // HANDYSTATS_JSON_DUMP_HPP_
@@ -22,5 +22,8 @@
 #include <handystats/measuring_points/counter.h>
 #include <handystats/measuring_points/timer.h>
 #include <handystats/measuring_points/attribute.h>
+#include <handystats/measuring_points/unique.h>
+#include <handystats/measuring_points/topk.h>
+#include <handystats/measuring_points/span.h>
 
 #endif // HANDYSTATS_MEASURING_POINTS_H_
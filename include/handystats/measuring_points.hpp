@@ -22,10 +22,15 @@
 #include <handystats/measuring_points/counter.hpp>
 #include <handystats/measuring_points/timer.hpp>
 #include <handystats/measuring_points/attribute.hpp>
+#include <handystats/measuring_points/unique.hpp>
+#include <handystats/measuring_points/topk.hpp>
+#include <handystats/measuring_points/span.hpp>
 
 #include <handystats/measuring_points/gauge_proxy.hpp>
 #include <handystats/measuring_points/counter_proxy.hpp>
 #include <handystats/measuring_points/timer_proxy.hpp>
 #include <handystats/measuring_points/attribute_proxy.hpp>
+#include <handystats/measuring_points/unique_proxy.hpp>
+#include <handystats/measuring_points/topk_proxy.hpp>
 
 #endif // HANDYSTATS_MEASURING_POINTS_HPP_
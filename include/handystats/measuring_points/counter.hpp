@@ -29,28 +29,30 @@
 
 namespace handystats { namespace measuring_points {
 
+// Unset timestamp (default) is replaced with current time within measuring point,
+// for metrics in receive-time mode events are timestamped by handystats core on receive
 void counter_init(
 		std::string&& counter_name,
 		const handystats::metrics::counter::value_type& init_value = handystats::metrics::counter::value_type(),
-		const handystats::metrics::counter::time_point& timestamp = handystats::metrics::counter::clock::now()
+		const handystats::metrics::counter::time_point& timestamp = handystats::metrics::counter::time_point()
 		);
 
 void counter_increment(
 		std::string&& counter_name,
 		const handystats::metrics::counter::value_type& value = 1,
-		const handystats::metrics::counter::time_point& timestamp = handystats::metrics::counter::clock::now()
+		const handystats::metrics::counter::time_point& timestamp = handystats::metrics::counter::time_point()
 		);
 
 void counter_decrement(
 		std::string&& counter_name,
 		const handystats::metrics::counter::value_type& value = 1,
-		const handystats::metrics::counter::time_point& timestamp = handystats::metrics::counter::clock::now()
+		const handystats::metrics::counter::time_point& timestamp = handystats::metrics::counter::time_point()
 		);
 
 void counter_change(
 		std::string&& counter_name,
 		const handystats::metrics::counter::value_type& value,
-		const handystats::metrics::counter::time_point& timestamp = handystats::metrics::counter::clock::now()
+		const handystats::metrics::counter::time_point& timestamp = handystats::metrics::counter::time_point()
 		);
 
 /*
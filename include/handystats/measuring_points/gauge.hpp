@@ -26,16 +26,18 @@
 
 namespace handystats { namespace measuring_points {
 
+// Unset timestamp (default) is replaced with current time within measuring point,
+// for metrics in receive-time mode events are timestamped by handystats core on receive
 void gauge_init(
 		std::string&& gauge_name,
 		const handystats::metrics::gauge::value_type& init_value,
-		const handystats::metrics::gauge::time_point& timestamp = handystats::metrics::gauge::clock::now()
+		const handystats::metrics::gauge::time_point& timestamp = handystats::metrics::gauge::time_point()
 	);
 
 void gauge_set(
 		std::string&& gauge_name,
 		const handystats::metrics::gauge::value_type& value,
-		const handystats::metrics::gauge::time_point& timestamp = handystats::metrics::gauge::clock::now()
+		const handystats::metrics::gauge::time_point& timestamp = handystats::metrics::gauge::time_point()
 	);
 
 }} // namespace handystats::measuring_points
@@ -44,7 +44,7 @@ public:
 	 */
 	gauge_proxy(const std::string& name,
 			const metrics::gauge::value_type& init_value,
-			const metrics::gauge::time_point& timestamp = metrics::gauge::clock::now()
+			const metrics::gauge::time_point& timestamp = metrics::gauge::time_point()
 		)
 		: name(name)
 	{
@@ -53,7 +53,7 @@ public:
 
 	gauge_proxy(const char* name,
 			const metrics::gauge::value_type& init_value,
-			const metrics::gauge::time_point& timestamp = metrics::gauge::clock::now()
+			const metrics::gauge::time_point& timestamp = metrics::gauge::time_point()
 		)
 		: name(name)
 	{
@@ -65,7 +65,7 @@ public:
 	 */
 	void init(
 			const metrics::gauge::value_type& init_value,
-			const metrics::gauge::time_point& timestamp = metrics::gauge::clock::now()
+			const metrics::gauge::time_point& timestamp = metrics::gauge::time_point()
 			)
 	{
 		HANDY_GAUGE_INIT(name.substr(), init_value, timestamp);
@@ -76,7 +76,7 @@ public:
 	 */
 	void set(
 			const metrics::gauge::value_type& value,
-			const metrics::gauge::time_point& timestamp = metrics::gauge::clock::now()
+			const metrics::gauge::time_point& timestamp = metrics::gauge::time_point()
 			)
 	{
 		HANDY_GAUGE_SET(name.substr(), value, timestamp);
@@ -0,0 +1,89 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_SPAN_MEASURING_POINTS_H_
+#define HANDYSTATS_SPAN_MEASURING_POINTS_H_
+
+#include <boost/preprocessor/list/cat.hpp>
+
+#include <handystats/common.h>
+#include <handystats/macros.h>
+
+HANDYSTATS_EXTERN_C
+void handystats_span_enter(
+		const char* span_name
+	);
+
+HANDYSTATS_EXTERN_C
+void handystats_span_exit(void);
+
+
+#ifndef __cplusplus
+	#ifndef HANDYSTATS_DISABLE
+
+		#define HANDY_SPAN_ENTER(...) HANDY_PP_MEASURING_POINT_WRAPPER(handystats_span_enter, __VA_ARGS__)
+
+		#define HANDY_SPAN_EXIT() handystats_span_exit()
+
+	#else
+
+		#define HANDY_SPAN_ENTER(...)
+
+		#define HANDY_SPAN_EXIT()
+
+	#endif
+
+	struct handystats_scoped_span_helper {
+		char placeholder;
+	};
+
+	static inline void handystats_scoped_span_cleanup(struct handystats_scoped_span_helper* scoped_span) {
+		(void)scoped_span;
+		handystats_span_exit();
+	}
+
+	#define C_UNIQUE_SCOPED_SPAN_NAME BOOST_PP_LIST_CAT((C_HANDY_SCOPED_SPAN_VAR_, (__LINE__, BOOST_PP_NIL)))
+
+	#ifndef HANDYSTATS_DISABLE
+
+		#define HANDY_SPAN_SCOPE(span_name) \
+			BOOST_PP_EXPAND( HANDY_PP_TUPLE_REM() \
+				BOOST_PP_IF( \
+					HANDY_PP_IS_TUPLE(span_name), \
+					( \
+						HANDY_PP_METRIC_NAME_BUFFER_SET(span_name); \
+						handystats_span_enter(HANDY_PP_METRIC_NAME_BUFFER_VAR); \
+						struct handystats_scoped_span_helper \
+						C_UNIQUE_SCOPED_SPAN_NAME __attribute__((cleanup(handystats_scoped_span_cleanup))) = {0} \
+					), \
+					( \
+						handystats_span_enter(span_name); \
+						struct handystats_scoped_span_helper \
+						C_UNIQUE_SCOPED_SPAN_NAME __attribute__((cleanup(handystats_scoped_span_cleanup))) = {0} \
+					) \
+				) \
+			)
+
+	#else
+
+		#define HANDY_SPAN_SCOPE(...)
+
+	#endif
+
+#endif
+
+#endif // HANDYSTATS_SPAN_MEASURING_POINTS_H_
@@ -0,0 +1,113 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_SPAN_MEASURING_POINTS_HPP_
+#define HANDYSTATS_SPAN_MEASURING_POINTS_HPP_
+
+#include <string>
+
+#include <boost/preprocessor/list/cat.hpp>
+
+#include <handystats/metrics/span.hpp>
+#include <handystats/macros.h>
+
+
+namespace handystats { namespace measuring_points {
+
+/*
+ * Spans form thread-local stack, entered span is nested into the current one
+ * Span's metric name is the path from the root span, e.g. "req.db.retry"
+ */
+void span_enter(
+		std::string&& span_name,
+		const metrics::span::time_point& timestamp = metrics::span::clock::now()
+	);
+
+void span_exit(
+		const metrics::span::time_point& timestamp = metrics::span::clock::now()
+	);
+
+/*
+ * Helper struct.
+ * On construction span is entered.
+ * On destruction span is exited.
+ */
+struct scoped_span_helper {
+	scoped_span_helper(std::string&& span_name) {
+		span_enter(std::move(span_name));
+	}
+
+	~scoped_span_helper() {
+		span_exit();
+	}
+};
+
+}} // namespace handystats::measuring_points
+
+
+/*
+ * Span's stack is maintained even if handystats is disabled in runtime,
+ * so enter and exit events should be balanced.
+ */
+#ifndef HANDYSTATS_DISABLE
+
+	#define HANDY_SPAN_ENTER(...) HANDY_PP_MEASURING_POINT_WRAPPER(handystats::measuring_points::span_enter, __VA_ARGS__)
+
+	#define HANDY_SPAN_EXIT(...) handystats::measuring_points::span_exit(__VA_ARGS__)
+
+#else
+
+	#define HANDY_SPAN_ENTER(...)
+
+	#define HANDY_SPAN_EXIT(...)
+
+#endif
+
+
+/*
+ * Helper scope macros.
+ */
+#define UNIQUE_SCOPED_SPAN_NAME BOOST_PP_LIST_CAT((HANDY_SCOPED_SPAN_VAR_, (__LINE__, BOOST_PP_NIL)))
+
+/*
+ * HANDY_SPAN_SCOPE event constructs scoped_span_helper named variable.
+ */
+#ifndef HANDYSTATS_DISABLE
+
+	#define HANDY_SPAN_SCOPE(span_name) \
+		BOOST_PP_EXPAND( HANDY_PP_TUPLE_REM() \
+			BOOST_PP_IF( \
+				HANDY_PP_IS_TUPLE(span_name), \
+				( \
+					HANDY_PP_METRIC_NAME_BUFFER_SET(span_name); \
+					handystats::measuring_points::scoped_span_helper UNIQUE_SCOPED_SPAN_NAME \
+						(HANDY_PP_METRIC_NAME_BUFFER_VAR) \
+				), \
+				( \
+					handystats::measuring_points::scoped_span_helper UNIQUE_SCOPED_SPAN_NAME \
+						(span_name) \
+				) \
+			) \
+		)
+
+#else
+
+	#define HANDY_SPAN_SCOPE(...)
+
+#endif
+
+#endif // HANDYSTATS_SPAN_MEASURING_POINTS_HPP_
@@ -62,6 +62,28 @@ void handystats_timer_set(
 		const int64_t measurement
 	);
 
+/*
+ * Pre-resolved timer handle.
+ * Handle is resolved once by timer's name and stays valid for the lifetime of the process.
+ * Recording measurement via handle doesn't allocate memory.
+ */
+struct handystats_timer_handle;
+
+HANDYSTATS_EXTERN_C
+struct handystats_timer_handle* handystats_timer_resolve(
+		const char* timer_name
+	);
+
+/*
+ * start_time and end_time are raw values of handystats_now()
+ */
+HANDYSTATS_EXTERN_C
+void handystats_timer_record(
+		struct handystats_timer_handle* timer_handle,
+		const int64_t start_time,
+		const int64_t end_time
+	);
+
 #ifndef __cplusplus
 	#ifndef HANDYSTATS_DISABLE
 
@@ -77,6 +99,9 @@ void handystats_timer_set(
 
 		#define HANDY_TIMER_SET(...) HANDY_PP_MEASURING_POINT_WRAPPER(handystats_timer_set, __VA_ARGS__)
 
+		/* expression macro, printf-like timer name is not supported */
+		#define HANDY_TIMER_RESOLVE(timer_name) handystats_timer_resolve(timer_name)
+
 	#else
 
 		#define HANDY_TIMER_INIT(...)
@@ -91,6 +116,8 @@ void handystats_timer_set(
 
 		#define HANDY_TIMER_SET(...)
 
+		#define HANDY_TIMER_RESOLVE(...) ((struct handystats_timer_handle*)0)
+
 	#endif
 
 	struct handystats_scoped_timer_helper {
@@ -131,6 +158,31 @@ void handystats_timer_set(
 
 	#endif
 
+	/*
+	 * Scoped timer bound to pre-resolved handle, lives on the stack.
+	 */
+	struct handystats_scoped_timer {
+		struct handystats_timer_handle* timer_handle;
+		const int64_t start_time;
+	};
+
+	static inline void handystats_scoped_timer_stop(struct handystats_scoped_timer* scoped_timer) {
+		handystats_timer_record(scoped_timer->timer_handle, scoped_timer->start_time, handystats_now());
+	}
+
+	#ifndef HANDYSTATS_DISABLE
+
+		#define HANDY_TIMER_HANDLE_SCOPE(timer_handle) \
+			struct handystats_scoped_timer \
+			C_UNIQUE_SCOPED_TIMER_NAME __attribute__((cleanup(handystats_scoped_timer_stop))) = \
+				{timer_handle, handystats_now()}
+
+	#else
+
+		#define HANDY_TIMER_HANDLE_SCOPE(...)
+
+	#endif
+
 #endif
 
 #endif // HANDYSTATS_TIMER_MEASURING_POINTS_H_
@@ -27,6 +27,8 @@
 #include <handystats/metrics/timer.hpp>
 #include <handystats/macros.h>
 
+struct handystats_timer_handle;
+
 
 namespace handystats { namespace measuring_points {
 
@@ -66,6 +68,43 @@ void timer_set(
 		const chrono::time_point& timestamp = chrono::tsc_clock::now()
 	);
 
+/*
+ * Pre-resolved timer handle.
+ * Handle is resolved once by timer's name and stays valid for the lifetime of the process.
+ * Recording measurement via handle doesn't allocate memory.
+ */
+typedef ::handystats_timer_handle* timer_handle;
+
+timer_handle timer_resolve(
+		std::string&& timer_name
+	);
+
+// start_time and end_time are raw TSC values (see tsc_clock)
+void timer_record(
+		timer_handle handle,
+		const int64_t& start_time,
+		const int64_t& end_time = chrono::tsc_clock::now().time_since_epoch().count()
+	);
+
+/*
+ * Scoped timer bound to pre-resolved handle.
+ * Holds only handle and raw start time, measurement is recorded on destruction.
+ */
+struct scoped_timer {
+	const timer_handle handle;
+	const int64_t start_time;
+
+	scoped_timer(const timer_handle& handle)
+		: handle(handle)
+		, start_time(chrono::tsc_clock::now().time_since_epoch().count())
+	{
+	}
+
+	~scoped_timer() {
+		timer_record(handle, start_time);
+	}
+};
+
 /*
  * Helper struct.
  * On construction HANDY_TIMER_START event is generated.
@@ -103,6 +142,9 @@ struct scoped_timer_helper {
 
 	#define HANDY_TIMER_SET(...) HANDY_PP_MEASURING_POINT_WRAPPER(handystats::measuring_points::timer_set, __VA_ARGS__)
 
+	// expression macro, printf-like timer name is not supported
+	#define HANDY_TIMER_RESOLVE(timer_name) handystats::measuring_points::timer_resolve(timer_name)
+
 #else
 
 	#define HANDY_TIMER_INIT(...)
@@ -117,6 +159,8 @@ struct scoped_timer_helper {
 
 	#define HANDY_TIMER_SET(...)
 
+	#define HANDY_TIMER_RESOLVE(...) (handystats::measuring_points::timer_handle())
+
 #endif
 
 
@@ -152,4 +196,18 @@ struct scoped_timer_helper {
 
 #endif
 
+/*
+ * HANDY_TIMER_HANDLE_SCOPE constructs scoped_timer variable bound to pre-resolved handle.
+ */
+#ifndef HANDYSTATS_DISABLE
+
+	#define HANDY_TIMER_HANDLE_SCOPE(timer_handle) \
+		handystats::measuring_points::scoped_timer UNIQUE_SCOPED_TIMER_NAME (timer_handle)
+
+#else
+
+	#define HANDY_TIMER_HANDLE_SCOPE(...)
+
+#endif
+
 #endif // HANDYSTATS_TIMER_MEASURING_POINTS_HPP_
@@ -0,0 +1,46 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_TOPK_MEASURING_POINTS_H_
+#define HANDYSTATS_TOPK_MEASURING_POINTS_H_
+
+#include <handystats/common.h>
+#include <handystats/macros.h>
+
+// weight should be positive, other weights are ignored
+HANDYSTATS_EXTERN_C
+void handystats_topk_add(
+		const char* topk_name,
+		const char* key,
+		const double weight
+	);
+
+
+#ifndef __cplusplus
+	#ifndef HANDYSTATS_DISABLE
+
+		#define HANDY_TOPK_ADD(...) HANDY_PP_MEASURING_POINT_WRAPPER(handystats_topk_add, __VA_ARGS__)
+
+	#else
+
+		#define HANDY_TOPK_ADD(...)
+
+	#endif
+
+#endif
+
+#endif // HANDYSTATS_TOPK_MEASURING_POINTS_H_
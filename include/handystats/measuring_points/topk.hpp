@@ -0,0 +1,50 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_TOPK_MEASURING_POINTS_HPP_
+#define HANDYSTATS_TOPK_MEASURING_POINTS_HPP_
+
+#include <string>
+
+#include <handystats/macros.h>
+#include <handystats/metrics/topk.hpp>
+
+
+namespace handystats { namespace measuring_points {
+
+// Weight should be positive, other weights are ignored
+void topk_add(
+		std::string&& topk_name,
+		const handystats::metrics::topk::key_type& key,
+		const handystats::metrics::topk::value_type& weight = 1,
+		const handystats::metrics::topk::time_point& timestamp = handystats::metrics::topk::clock::now()
+	);
+
+}} // namespace handystats::measuring_points
+
+
+#ifndef HANDYSTATS_DISABLE
+
+	#define HANDY_TOPK_ADD(...) HANDY_PP_MEASURING_POINT_WRAPPER(handystats::measuring_points::topk_add, __VA_ARGS__)
+
+#else
+
+	#define HANDY_TOPK_ADD(...)
+
+#endif
+
+#endif // HANDYSTATS_TOPK_MEASURING_POINTS_HPP_
@@ -0,0 +1,56 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_UNIQUE_MEASURING_POINTS_H_
+#define HANDYSTATS_UNIQUE_MEASURING_POINTS_H_
+
+#include <stdint.h>
+
+#include <handystats/common.h>
+#include <handystats/macros.h>
+
+HANDYSTATS_EXTERN_C
+void handystats_unique_add(
+		const char* unique_name,
+		const uint64_t key
+	);
+
+HANDYSTATS_EXTERN_C
+void handystats_unique_add_string(
+		const char* unique_name,
+		const char* key
+	);
+
+
+#ifndef __cplusplus
+	#ifndef HANDYSTATS_DISABLE
+
+		#define HANDY_UNIQUE_ADD(...) HANDY_PP_MEASURING_POINT_WRAPPER(handystats_unique_add, __VA_ARGS__)
+
+		#define HANDY_UNIQUE_ADD_STRING(...) HANDY_PP_MEASURING_POINT_WRAPPER(handystats_unique_add_string, __VA_ARGS__)
+
+	#else
+
+		#define HANDY_UNIQUE_ADD(...)
+
+		#define HANDY_UNIQUE_ADD_STRING(...)
+
+	#endif
+
+#endif
+
+#endif // HANDYSTATS_UNIQUE_MEASURING_POINTS_H_
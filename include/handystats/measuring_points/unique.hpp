@@ -0,0 +1,56 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_UNIQUE_MEASURING_POINTS_HPP_
+#define HANDYSTATS_UNIQUE_MEASURING_POINTS_HPP_
+
+#include <string>
+
+#include <handystats/macros.h>
+#include <handystats/metrics/unique.hpp>
+
+
+namespace handystats { namespace measuring_points {
+
+// key is 64-bit hash (or integer identifier) of the distinct item
+void unique_add(
+		std::string&& unique_name,
+		const handystats::metrics::unique::value_type& key,
+		const handystats::metrics::unique::time_point& timestamp = handystats::metrics::unique::clock::now()
+	);
+
+// key is hashed by the library
+void unique_add(
+		std::string&& unique_name,
+		const std::string& key,
+		const handystats::metrics::unique::time_point& timestamp = handystats::metrics::unique::clock::now()
+	);
+
+}} // namespace handystats::measuring_points
+
+
+#ifndef HANDYSTATS_DISABLE
+
+	#define HANDY_UNIQUE_ADD(...) HANDY_PP_MEASURING_POINT_WRAPPER(handystats::measuring_points::unique_add, __VA_ARGS__)
+
+#else
+
+	#define HANDY_UNIQUE_ADD(...)
+
+#endif
+
+#endif // HANDYSTATS_UNIQUE_MEASURING_POINTS_HPP_
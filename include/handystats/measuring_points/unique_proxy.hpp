@@ -0,0 +1,64 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_MEASURING_POINTS_UNIQUE_PROXY_HPP_
+#define HANDYSTATS_MEASURING_POINTS_UNIQUE_PROXY_HPP_
+
+#include <string>
+
+#include <handystats/metrics/unique.hpp>
+
+#include <handystats/measuring_points/unique.hpp>
+
+namespace handystats { namespace measuring_points {
+
+class unique_proxy {
+public:
+	unique_proxy(const std::string& name)
+		: name(name)
+	{}
+
+	unique_proxy(const char* name)
+		: name(name)
+	{}
+
+	/*
+	 * Proxy add event
+	 */
+	void add(
+			const metrics::unique::value_type& key,
+			const metrics::unique::time_point& timestamp = metrics::unique::clock::now()
+			)
+	{
+		HANDY_UNIQUE_ADD(name.substr(), key, timestamp);
+	}
+
+	void add(
+			const std::string& key,
+			const metrics::unique::time_point& timestamp = metrics::unique::clock::now()
+			)
+	{
+		HANDY_UNIQUE_ADD(name.substr(), key, timestamp);
+	}
+
+private:
+	const std::string name;
+};
+
+}} // namespace handystats::measuring_points
+
+#endif // HANDYSTATS_MEASURING_POINTS_UNIQUE_PROXY_HPP_
@@ -0,0 +1,55 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_METRIC_READER_HPP_
+#define HANDYSTATS_METRIC_READER_HPP_
+
+#include <memory>
+#include <string>
+
+#include <handystats/metrics_dump.hpp>
+
+namespace handystats { namespace metrics_dump {
+
+struct metric_slot;
+
+/*
+ * Handle to the latest published snapshot of single metric.
+ *
+ * Metric is resolved by name once on construction, after that the dump thread
+ * keeps the handle's snapshot up to date on every published dump.
+ * Reading the snapshot neither locks nor looks the metric up in the dump,
+ * so frequent health checks don't pin whole dumps.
+ * Handles of the same metric share the snapshot, copying the handle is cheap.
+ */
+class metric_reader {
+public:
+	// Metric doesn't have to exist yet, the snapshot appears with the first dump that contains it
+	explicit metric_reader(const std::string& name);
+
+	const std::string& name() const;
+
+	// Latest published snapshot of the metric, null if the current dump doesn't contain the metric
+	dump_map::entry_ptr load() const;
+
+private:
+	std::shared_ptr<const metric_slot> m_slot;
+};
+
+}} // namespace handystats::metrics_dump
+
+#endif // HANDYSTATS_METRIC_READER_HPP_
@@ -24,6 +24,9 @@
 #include <handystats/metrics/counter.hpp>
 #include <handystats/metrics/timer.hpp>
 #include <handystats/metrics/attribute.hpp>
+#include <handystats/metrics/unique.hpp>
+#include <handystats/metrics/topk.hpp>
+#include <handystats/metrics/span.hpp>
 
 namespace handystats { namespace metrics {
 
@@ -32,7 +35,10 @@ typedef boost::variant <
 		counter,
 		gauge,
 		timer,
-		attribute
+		attribute,
+		unique,
+		topk,
+		span
 	> metric_variant;
 
 
@@ -41,7 +47,10 @@ typedef boost::variant <
 		counter*,
 		gauge*,
 		timer*,
-		attribute*
+		attribute*,
+		unique*,
+		topk*,
+		span*
 	> metric_ptr_variant;
 
 
@@ -50,7 +59,10 @@ enum metric_index {
 	COUNTER = 0,
 	GAUGE,
 	TIMER,
-	ATTRIBUTE
+	ATTRIBUTE,
+	UNIQUE,
+	TOPK,
+	SPAN
 };
 
 }} // namespace handystats::metrics
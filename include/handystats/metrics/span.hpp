@@ -0,0 +1,59 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_METRICS_SPAN_HPP_
+#define HANDYSTATS_METRICS_SPAN_HPP_
+
+#include <handystats/chrono.hpp>
+#include <handystats/statistics.hpp>
+#include <handystats/config/metrics/timer.hpp>
+
+namespace handystats { namespace metrics {
+
+// Node of the spans call-tree, e.g. "req.db.retry"
+// Collects durations including nested spans (inclusive) and excluding them (self)
+struct span
+{
+	typedef chrono::duration value_type;
+	static const chrono::time_unit value_unit;
+
+	typedef chrono::tsc_clock clock;
+	typedef chrono::time_point time_point;
+
+	span(const config::metrics::timer& opts = config::metrics::timer());
+
+	void set(
+			const value_type& inclusive_measurement,
+			const value_type& self_measurement,
+			const time_point& timestamp = clock::now()
+		);
+
+	void update_statistics(const time_point& timestamp = clock::now());
+
+	const statistics& inclusive() const;
+	const statistics& self() const;
+
+private:
+	statistics m_inclusive;
+	statistics m_self;
+
+}; // struct span
+
+}} // namespace handystats::metrics
+
+
+#endif // HANDYSTATS_METRICS_SPAN_HPP_
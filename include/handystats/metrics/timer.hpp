@@ -20,8 +20,9 @@
 
 #include <cstdint>
 
-#include <utility>
-#include <unordered_map>
+#include <cstddef>
+
+#include <vector>
 
 #include <handystats/chrono.hpp>
 #include <handystats/statistics.hpp>
@@ -52,11 +53,18 @@ struct timer
 		{
 		}
 
-		bool expired(const chrono::duration& idle_timeout, const time_point& timestamp = clock::now()) {
+		bool expired(const chrono::duration& idle_timeout, const time_point& timestamp = clock::now()) const {
 			return (timestamp > heartbeat_timestamp) && (timestamp - heartbeat_timestamp > idle_timeout);
 		}
 	};
 
+	// sample captured among the slowest ones within moving interval
+	struct exemplar {
+		value_type value;
+		instance_id_type instance_id;
+		time_point timestamp;
+	};
+
 	timer(const config::metrics::timer& timer_opts = config::metrics::timer());
 
 	void start(
@@ -81,7 +89,8 @@ struct timer
 
 	void set(
 			const value_type& measurement,
-			const time_point& timestamp = clock::now()
+			const time_point& timestamp = clock::now(),
+			const instance_id_type& instance_id = DEFAULT_INSTANCE_ID
 		);
 
 	void check_idle_timeout(
@@ -93,14 +102,75 @@ struct timer
 
 	const statistics& values() const;
 
+	// number of running (not stopped and not yet expired) instances
+	size_t instances_count() const;
+
+	// slowest samples within moving interval ordered by value (the slowest first)
+	std::vector<exemplar> exemplars() const;
+
 private:
+	typedef uint32_t slot_index_type;
+	static const slot_index_type NIL_SLOT;
+
+	// Hierarchical timing wheel with 64 buckets per level
+	// Wheel tick is 1/64 of idle timeout, so instance's expiry usually lands on the first two levels
+	static const size_t WHEEL_LEVELS = 3;
+	static const size_t WHEEL_SLOT_BITS = 6;
+	static const size_t WHEEL_SLOTS = size_t(1) << WHEEL_SLOT_BITS;
+
+	// Instance states are kept in the slab, released slots are reused
+	// Slot is linked either into wheel bucket (ordered by expiry) or into the free list
+	struct instance_slot {
+		instance_id_type instance_id;
+		instance_state state;
+
+		slot_index_type prev;
+		slot_index_type next;
+		uint32_t bucket;
+	};
+
+	slot_index_type find_slot(const instance_id_type& instance_id) const;
+	slot_index_type acquire_slot(const instance_id_type& instance_id);
+	void release_slot(const slot_index_type& slot);
+
+	size_t index_position(const instance_id_type& instance_id) const;
+	void rebuild_index(const size_t& index_size);
+
+	int64_t wheel_tick(const time_point& timestamp) const;
+	void wheel_link(const slot_index_type& slot, const uint32_t& bucket);
+	void wheel_unlink(const slot_index_type& slot);
+	void wheel_schedule(const slot_index_type& slot);
+	void wheel_expire(slot_index_type slot, const time_point& timestamp);
+	void wheel_advance(const time_point& timestamp);
+
+	void capture_exemplar(const value_type& value, const instance_id_type& instance_id, const time_point& timestamp);
+	void rotate_exemplars(const time_point& timestamp);
+
 	chrono::duration m_idle_timeout;
 
 	statistics m_values;
 
-	std::unordered_map<instance_id_type, instance_state> m_instances;
-
-	time_point m_idle_check_timestamp;
+	std::vector<instance_slot> m_slots;
+	slot_index_type m_free_slot;
+	size_t m_instances_count;
+
+	// open addressing (linear probing) index from instance id to slot
+	std::vector<slot_index_type> m_index;
+
+	std::vector<slot_index_type> m_wheel;
+	// occupied buckets of the first level
+	uint64_t m_wheel_occupancy;
+	int64_t m_wheel_tick;
+	int64_t m_wheel_tick_length;
+
+	// Exemplars are kept in min-heaps (the fastest of the slowest on top) for current and previous
+	// moving interval buckets, so sample is pushed in O(log K) only if it beats the heap's minimum
+	size_t m_exemplars_size;
+	chrono::duration m_exemplars_interval;
+	time_point m_exemplars_bucket_start;
+	time_point m_exemplars_timestamp;
+	std::vector<exemplar> m_exemplars_current;
+	std::vector<exemplar> m_exemplars_previous;
 
 }; // struct timer
 
@@ -0,0 +1,88 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_METRICS_TOPK_HPP_
+#define HANDYSTATS_METRICS_TOPK_HPP_
+
+#include <cstddef>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <handystats/chrono.hpp>
+#include <handystats/config/metrics/topk.hpp>
+
+namespace handystats { namespace metrics {
+
+// Heavy hitters -- keys with the largest total weight (Space-Saving algorithm)
+// Memory usage is bounded by configured number of tracked keys
+struct topk
+{
+	typedef double value_type;
+	typedef std::string key_type;
+	typedef chrono::tsc_clock clock;
+	typedef chrono::time_point time_point;
+
+	struct entry {
+		key_type key;
+		// estimated total weight of the key
+		// it never underestimates true weight and overestimates it by at most error
+		value_type count;
+		value_type error;
+	};
+
+	typedef std::vector<entry> entries_type;
+
+	topk(const config::metrics::topk& opts = config::metrics::topk());
+
+	// Non-positive (and NaN) weights are ignored
+	void add(const key_type& key, const value_type& weight = 1, const time_point& timestamp = clock::now());
+
+	void update_statistics(const time_point& timestamp = clock::now());
+
+	// Merge summary of another metric, result keeps this metric's configuration
+	void merge(const topk& other);
+
+	// reported entries ordered by count (descending)
+	entries_type top() const;
+	// total weight of all added keys
+	value_type total() const;
+	time_point timestamp() const;
+
+private:
+	size_t m_capacity;
+	size_t m_size;
+
+	// min-heap of tracked entries by count
+	entries_type m_entries;
+	std::unordered_map<key_type, size_t> m_index;
+
+	value_type m_total;
+	time_point m_timestamp;
+
+	value_type min_count() const;
+	void swap_entries(const size_t& first, const size_t& second);
+	void sift_down(size_t index);
+	void sift_up(size_t index);
+
+}; // struct topk
+
+}} // namespace handystats::metrics
+
+
+#endif // HANDYSTATS_METRICS_TOPK_HPP_
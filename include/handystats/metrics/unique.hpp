@@ -0,0 +1,93 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_METRICS_UNIQUE_HPP_
+#define HANDYSTATS_METRICS_UNIQUE_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+#include <vector>
+#include <stdexcept>
+
+#include <handystats/chrono.hpp>
+#include <handystats/config/metrics/unique.hpp>
+
+namespace handystats { namespace metrics {
+
+// Estimation of the number of distinct keys (HyperLogLog sketch)
+// Memory usage is fixed and is determined by sketch precision
+struct unique
+{
+	typedef uint64_t value_type;
+	typedef chrono::tsc_clock clock;
+	typedef chrono::time_point time_point;
+
+	typedef std::invalid_argument incompatible_error;
+
+	// metric keeps (INTERVAL_SLICES + 2) sketches of 2^precision bytes each
+	static const size_t MIN_PRECISION = 4;
+	static const size_t MAX_PRECISION = 12;
+
+	// moving interval is covered by INTERVAL_SLICES sketches of equal time span
+	// plus the current one, sketches are dropped as moving interval shifts
+	static const size_t INTERVAL_SLICES = 4;
+
+	unique(const config::metrics::unique& opts = config::metrics::unique());
+
+	// value is 64-bit hash of the key
+	void add(const value_type& hash, const time_point& timestamp = clock::now());
+
+	void update_statistics(const time_point& timestamp = clock::now());
+
+	// Merge sketches of another metric with the same configuration
+	// Method will throw incompatible_error on configuration mismatch
+	void merge(const unique& other);
+
+	// estimated number of distinct keys over moving interval
+	double estimate() const;
+	// estimated number of distinct keys since metric creation
+	double total() const;
+
+	size_t precision() const;
+	time_point timestamp() const;
+
+private:
+	static const size_t SLOTS = INTERVAL_SLICES + 1;
+
+	size_t m_precision;
+	chrono::duration m_moving_interval;
+	// moving_interval / INTERVAL_SLICES in units of timestamps
+	chrono::duration m_slice_span;
+
+	// SLOTS moving interval sketches followed by total sketch
+	std::vector<uint8_t> m_registers;
+
+	// absolute index of the current slice (timestamp / slice span)
+	int64_t m_slice_index;
+	time_point m_timestamp;
+
+	size_t registers_count() const;
+	int64_t slice_index(const time_point& timestamp);
+	void shift_slices(const int64_t& slice_index);
+
+}; // struct unique
+
+}} // namespace handystats::metrics
+
+
+#endif // HANDYSTATS_METRICS_UNIQUE_HPP_
@@ -20,15 +20,302 @@
 
 #include <memory>
 #include <string>
-#include <map>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <cstdint>
 
+#include <handystats/chrono.hpp>
 #include <handystats/metrics.hpp>
 
-const std::shared_ptr <
-	const std::map <
-		std::string, handystats::metrics::metric_variant
-		>
-	>
-HANDY_METRICS_DUMP();
+namespace handystats { namespace metrics_dump {
+
+struct dump_delta;
+
+/*
+ * Immutable sorted map of metrics' snapshots (metrics dump).
+ *
+ * Entries are stored in blocks of up to MAX_BLOCK_SIZE entries.
+ * Consecutive dumps share unchanged entries and blocks,
+ * so the cost of the new dump is proportional to the number of changed metrics.
+ *
+ * Interface follows const std::map<std::string, metrics::metric_variant>.
+ */
+class dump_map {
+public:
+	typedef std::string key_type;
+	typedef metrics::metric_variant mapped_type;
+	typedef std::pair<const std::string, metrics::metric_variant> value_type;
+	typedef size_t size_type;
+
+	// Single metric's snapshot shared between dumps while the metric is unchanged
+	struct entry {
+		value_type value;
+		// version of the dump the snapshot has been taken for
+		uint64_t version;
+
+		entry(const std::string& name, const metrics::metric_variant& metric, const uint64_t& version)
+			: value(name, metric)
+			, version(version)
+		{}
+	};
+	typedef std::shared_ptr<const entry> entry_ptr;
+
+	static const size_t MAX_BLOCK_SIZE = 256;
+	// number of the latest removals remembered for delta()
+	static const size_t MAX_REMOVALS = 16 * 1024;
+
+	class const_iterator : public std::iterator<std::bidirectional_iterator_tag, const value_type> {
+	public:
+		const_iterator()
+			: m_map(nullptr), m_block(0), m_index(0)
+		{}
+
+		const value_type& operator*() const {
+			return (*m_map->m_blocks[m_block])[m_index]->value;
+		}
+		const value_type* operator->() const {
+			return &**this;
+		}
+
+		// version of the dump the entry has been taken for
+		uint64_t version() const {
+			return (*m_map->m_blocks[m_block])[m_index]->version;
+		}
+
+		// entry shared between dumps while the metric is unchanged
+		const entry_ptr& entry() const {
+			return (*m_map->m_blocks[m_block])[m_index];
+		}
+
+		const_iterator& operator++();
+		const_iterator operator++(int) {
+			const_iterator iter(*this);
+			++*this;
+			return iter;
+		}
+		const_iterator& operator--();
+		const_iterator operator--(int) {
+			const_iterator iter(*this);
+			--*this;
+			return iter;
+		}
+
+		bool operator==(const const_iterator& other) const {
+			return m_map == other.m_map && m_block == other.m_block && m_index == other.m_index;
+		}
+		bool operator!=(const const_iterator& other) const {
+			return !(*this == other);
+		}
+
+	private:
+		friend class dump_map;
+
+		const_iterator(const dump_map* map, const size_t& block, const size_t& index)
+			: m_map(map), m_block(block), m_index(index)
+		{}
+
+		const dump_map* m_map;
+		size_t m_block;
+		size_t m_index;
+	};
+	typedef const_iterator iterator;
+
+	dump_map();
+
+	// Version of the dump, increases with every published dump
+	uint64_t version() const;
+
+	const_iterator begin() const;
+	const_iterator end() const;
+	const_iterator cbegin() const;
+	const_iterator cend() const;
+
+	const_iterator find(const std::string& name) const;
+	size_type count(const std::string& name) const;
+
+	// The first entry with name not less (greater) than the given one
+	const_iterator lower_bound(const std::string& name) const;
+	const_iterator upper_bound(const std::string& name) const;
+
+	// Method will throw std::out_of_range if there's no such metric
+	const mapped_type& at(const std::string& name) const;
+
+	size_type size() const;
+	bool empty() const;
+
+	// Constructs new dump of the given version that shares unchanged blocks with this one.
+	// changed -- new or updated entries sorted by name
+	// removed -- names of removed metrics sorted by name
+	dump_map update(
+			const std::vector<entry_ptr>& changed,
+			const std::vector<std::string>& removed,
+			const uint64_t& version
+		) const;
+
+	// Changes of this dump relative to the dump of the given version (see dump_delta).
+	// Blocks without changes are skipped, so the cost is proportional to the number of changed metrics.
+	dump_delta delta(const uint64_t& since) const;
+
+private:
+	typedef std::vector<entry_ptr> block_type;
+	// (version, name) of removed metrics ordered by version
+	typedef std::vector<std::pair<uint64_t, std::string>> removals_type;
+
+	std::vector<std::shared_ptr<const block_type>> m_blocks;
+	// the latest version of entries in each block
+	std::vector<uint64_t> m_block_versions;
+	size_t m_size;
+	uint64_t m_version;
+
+	std::shared_ptr<const removals_type> m_removals;
+	// removals up to this version are forgotten
+	uint64_t m_removals_horizon;
+};
+
+/*
+ * Metrics changed and removed since the given dump version.
+ * Applying the delta to the dump of version `since` gives the dump of version `version`.
+ */
+struct dump_delta {
+	uint64_t since;
+	uint64_t version;
+
+	// delta can't be built relative to `since` (removals are forgotten or the version is unknown),
+	// `changed` contains the whole dump then and consumers should drop metrics they have got before
+	bool full;
+
+	// entries with versions greater than `since` sorted by name
+	std::vector<dump_map::entry_ptr> changed;
+	// names of removed metrics sorted by name
+	std::vector<std::string> removed;
+
+	dump_delta()
+		: since(0)
+		, version(0)
+		, full(false)
+	{}
+};
+
+/*
+ * Metrics of the dump with names starting with the prefix or matching the glob pattern (see fnmatch(3)).
+ *
+ * Bounds of the view are looked up in the sorted dump by the prefix (by the literal prefix of the pattern),
+ * so only the matching range of the dump is visited and nothing is copied.
+ * The view keeps the dump alive, its iterators are valid while the view exists.
+ */
+class dump_view {
+public:
+	typedef dump_map::key_type key_type;
+	typedef dump_map::mapped_type mapped_type;
+	typedef dump_map::value_type value_type;
+	typedef dump_map::size_type size_type;
+
+	class const_iterator : public std::iterator<std::forward_iterator_tag, const value_type> {
+	public:
+		const_iterator()
+			: m_view(nullptr), m_iter()
+		{}
+
+		const value_type& operator*() const {
+			return *m_iter;
+		}
+		const value_type* operator->() const {
+			return &*m_iter;
+		}
+
+		// version of the dump the entry has been taken for
+		uint64_t version() const {
+			return m_iter.version();
+		}
+
+		const_iterator& operator++() {
+			++m_iter;
+			skip();
+			return *this;
+		}
+		const_iterator operator++(int) {
+			const_iterator iter(*this);
+			++*this;
+			return iter;
+		}
+
+		bool operator==(const const_iterator& other) const {
+			return m_iter == other.m_iter;
+		}
+		bool operator!=(const const_iterator& other) const {
+			return !(*this == other);
+		}
+
+	private:
+		friend class dump_view;
+
+		const_iterator(const dump_view* view, const dump_map::const_iterator& iter)
+			: m_view(view), m_iter(iter)
+		{
+			skip();
+		}
+
+		// moves to the next entry matching the view's pattern
+		void skip();
+
+		const dump_view* m_view;
+		dump_map::const_iterator m_iter;
+	};
+	typedef const_iterator iterator;
+
+	// View of the whole dump
+	explicit dump_view(const std::shared_ptr<const dump_map>& dump);
+
+	static dump_view prefix(const std::shared_ptr<const dump_map>& dump, const std::string& prefix);
+	static dump_view glob(const std::shared_ptr<const dump_map>& dump, const std::string& pattern);
+
+	// Version of the underlying dump
+	uint64_t version() const;
+
+	const_iterator begin() const;
+	const_iterator end() const;
+	const_iterator cbegin() const;
+	const_iterator cend() const;
+
+	// Method is linear in the number of entries within the view's bounds
+	size_type size() const;
+	bool empty() const;
+
+	bool matches(const std::string& name) const;
+
+	const std::shared_ptr<const dump_map>& dump() const;
+
+private:
+	std::shared_ptr<const dump_map> m_dump;
+	dump_map::const_iterator m_first;
+	dump_map::const_iterator m_last;
+
+	// entries within the bounds are filtered by the pattern only for glob views
+	bool m_glob;
+	std::string m_pattern;
+};
+
+}} // namespace handystats::metrics_dump
+
+
+// Current metrics dump (returned std::map before 2.0, see dump_map for its std::map-like interface)
+const std::shared_ptr<const handystats::metrics_dump::dump_map> HANDY_METRICS_DUMP();
+
+// Views of the current metrics dump with names starting with the prefix or matching the glob pattern,
+// e.g. HANDY_METRICS_DUMP_PREFIX("db.") or HANDY_METRICS_DUMP_GLOB("db.*.time")
+handystats::metrics_dump::dump_view HANDY_METRICS_DUMP_PREFIX(const std::string& prefix);
+handystats::metrics_dump::dump_view HANDY_METRICS_DUMP_GLOB(const std::string& pattern);
+
+// Version of the current metrics dump, increases with every published dump
+uint64_t HANDY_METRICS_DUMP_VERSION();
+
+// Metrics changed and removed since the dump of the given version
+handystats::metrics_dump::dump_delta HANDY_METRICS_DUMP_SINCE(const uint64_t& version);
+
+// Blocks until metrics dump with version other than the given one is published or the timeout expires.
+// Returns the current metrics dump, so pollers could pass its version to the next call.
+const std::shared_ptr<const handystats::metrics_dump::dump_map>
+HANDY_METRICS_DUMP_WAIT(const uint64_t& version, const handystats::chrono::duration& timeout);
 
 #endif // HANDYSTATS_METRICS_DUMP_HPP_
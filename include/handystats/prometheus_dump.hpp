@@ -0,0 +1,45 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_PROMETHEUS_DUMP_HPP_
+#define HANDYSTATS_PROMETHEUS_DUMP_HPP_
+
+#include <string>
+#include <memory>
+
+#include <handystats/metrics_dump.hpp>
+
+namespace handystats { namespace prometheus {
+
+// Renders metrics dump in Prometheus text exposition format.
+// Rendered text of each metric is cached and reused while the metric stays unchanged between dumps.
+std::string to_string(const handystats::metrics_dump::dump_map&);
+
+// Renders metrics dump into the buffer replacing its content
+void write(const handystats::metrics_dump::dump_map&, std::string& buffer);
+
+// Prometheus text of the metrics dump rendered at most once per dump version and shared between callers
+const std::shared_ptr<const std::string> to_shared_string(const handystats::metrics_dump::dump_map&);
+
+}} // namespace handystats::prometheus
+
+std::string HANDY_PROMETHEUS_DUMP();
+
+// Memoised Prometheus text of the current metrics dump
+const std::shared_ptr<const std::string> HANDY_PROMETHEUS_DUMP_SHARED();
+
+#endif // HANDYSTATS_PROMETHEUS_DUMP_HPP_
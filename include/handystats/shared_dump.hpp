@@ -0,0 +1,71 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_SHARED_DUMP_HPP_
+#define HANDYSTATS_SHARED_DUMP_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+/*
+ * Shared memory dump
+ *
+ * When "dump-shared-memory" path is configured the dump thread copies every binary dump
+ * (see binary_dump.hpp) into the file at that path, preferably located on tmpfs (e.g. /dev/shm).
+ * Other processes map the file and read consistent dumps without any work done by the application.
+ *
+ * Segment consists of the header page followed by two data slots.
+ * The writer fills the slot that is not current under the slot's sequence counter
+ * (odd while being written) and then advances the header's generation, which selects the current slot.
+ * Readers copy the current slot and retry if its sequence counter changed meanwhile.
+ * If the dump doesn't fit the slot, the writer replaces the file with a larger one
+ * and marks the old segment stale, so that readers reopen the path.
+ */
+
+namespace handystats { namespace shared_dump {
+
+class reader {
+public:
+	explicit reader(const std::string& path);
+	~reader();
+
+	// Copies the latest published binary dump into the buffer.
+	// Returns false if the segment doesn't exist or nothing has been published yet.
+	// Throws std::system_error on I/O errors, std::invalid_argument if the file is not a dump segment
+	// and std::runtime_error if the current slot doesn't become stable within a second (the writer has died while copying it).
+	bool read(std::string& buffer);
+
+	// version of the last read dump
+	uint64_t version() const;
+
+private:
+	reader(const reader&);
+	reader& operator=(const reader&);
+
+	bool open();
+	void close();
+
+	std::string m_path;
+	void* m_segment;
+	size_t m_size;
+	uint64_t m_version;
+};
+
+}} // namespace handystats::shared_dump
+
+#endif // HANDYSTATS_SHARED_DUMP_HPP_
@@ -104,6 +104,30 @@ public:
 		, enable_if_eq<Tag, tag::entropy, double>
 	{};
 
+	// Plain data form of statistics' state.
+	// Snapshot could be serialized, transferred to another thread or process
+	// and restored back into statistics object (e.g. for further merge).
+	struct snapshot_type {
+		config::statistics config;
+
+		value_type value;
+		value_type min;
+		value_type max;
+		value_type sum;
+		uint64_t count;
+		double moving_count;
+		double moving_sum;
+		double rate;
+		histogram_type histogram;
+		time_point timestamp;
+		time_point data_timestamp;
+
+		// Binary form is host-specific (byte order, TSC epoch)
+		std::string serialize() const;
+		// Method will throw std::invalid_argument on malformed data
+		static snapshot_type deserialize(const std::string&);
+	};
+
 	// statistics is enabled from configuration
 	// but could also be computed due to data dependency
 	bool enabled(const tag::type& t) const HANDYSTATS_NOEXCEPT;
@@ -116,11 +140,29 @@ public:
 			const config::statistics& opts = config::statistics()
 		);
 
+	// Restore statistics from snapshot
+	explicit statistics(const snapshot_type&);
+
+	snapshot_type snapshot() const;
+
 	void reset();
 
+	// Merge another statistics into this one.
+	// Both objects are aligned to the latest of their timestamps before merge,
+	// result keeps this object's configuration.
+	// value -- the most recent one (other's on tie)
+	// min, max, count, sum -- combined as if both data streams were fed into this object
+	// moving_count, moving_sum, rate -- sum of aligned interval data
+	// histogram -- union of bins reduced to configured number of bins
+	void merge(const statistics& other);
+
 	void update(const value_type& value, const time_point& timestamp = clock::now());
 	void update_time(const time_point& timestamp = clock::now());
 
+	// No data is left within moving interval,
+	// so further update_time() calls change nothing but timestamp
+	bool settled() const;
+
 	// Depricated iface, use get<tag>
 	value_type value() const;
 	value_type min() const;
@@ -170,6 +212,14 @@ private:
 	// configuration (internal form)
 	config::statistics m_config;
 
+	// enabled tags with their data dependencies, resolved once on reset
+	tag::type m_computed_tags;
+
+	// moving interval in raw counts of m_interval_unit,
+	// refreshed when timestamps of another unit arrive
+	chrono::time_unit m_interval_unit;
+	int64_t m_interval_count;
+
 	template <tag::type Tag>
 	typename result_type<Tag>::type get_impl() const;
 
@@ -180,12 +230,20 @@ private:
 	size_t m_count;
 	value_type m_moving_count;
 	value_type m_moving_sum;
-	histogram_type m_histogram;
+	// histogram is stored as separate arrays of bins' centers, counts and timestamps
+	// bins' timestamps are raw counts in m_bin_unit of m_bin_clock (0 for empty bins)
+	std::vector<value_type> m_bin_centers;
+	std::vector<double> m_bin_counts;
+	std::vector<int64_t> m_bin_timestamps;
+	chrono::time_unit m_bin_unit;
+	chrono::clock_type m_bin_clock;
 	time_point m_timestamp;
 	value_type m_rate;
 
 	time_point m_data_timestamp;
 
+	int64_t moving_interval_count(const chrono::time_unit& unit);
+
 	// applicable for moving_sum, moving_count
 	double shift_interval_data(
 			const double& data, const time_point& data_timestamp,
@@ -196,8 +254,18 @@ private:
 			const value_type& value, const time_point& timestamp
 		);
 
+	int64_t to_bin_timestamp(const time_point& timestamp) const;
+	time_point from_bin_timestamp(const int64_t& bin_timestamp) const;
+
 	void shift_histogram(const time_point& timestamp);
 	void update_histogram(const value_type& value, const time_point& timestamp);
+	void compress_histogram();
+	void remove_empty_bins();
+	void merge_bins(const size_t& index);
+
+	// conversion between internal and public histogram forms
+	void set_histogram(const histogram_type& histogram, const time_point& timestamp);
+	histogram_type get_histogram() const;
 };
 
 } // namespace handystats
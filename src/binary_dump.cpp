@@ -0,0 +1,794 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+#include <handystats/chrono.hpp>
+#include <handystats/binary_dump.hpp>
+
+#include "rendered_dump_impl.hpp"
+
+namespace handystats { namespace binary {
+
+namespace {
+
+const char MAGIC[4] = {'H', 'S', 'B', 'D'};
+const size_t HEADER_SIZE = 48;
+
+// statistics' tags in order of their bits
+const statistics::tag::type DOUBLE_TAGS =
+	statistics::tag::value | statistics::tag::min | statistics::tag::max |
+	statistics::tag::sum | statistics::tag::avg |
+	statistics::tag::moving_count | statistics::tag::moving_sum | statistics::tag::moving_avg |
+	statistics::tag::rate | statistics::tag::entropy;
+
+size_t tag_bit(const statistics::tag::type& tag) {
+	size_t bit = 0;
+	while ((statistics::tag::type(1) << bit) < tag) {
+		++bit;
+	}
+	return bit;
+}
+
+/*
+ * Writer
+ */
+
+template <typename T>
+void write_fixed(std::string& buffer, const T& value) {
+	for (size_t byte = 0; byte < sizeof(T); ++byte) {
+		buffer.push_back(char((value >> (8 * byte)) & 0xff));
+	}
+}
+
+template <typename T>
+void patch_fixed(std::string& buffer, const size_t& offset, const T& value) {
+	for (size_t byte = 0; byte < sizeof(T); ++byte) {
+		buffer[offset + byte] = char((value >> (8 * byte)) & 0xff);
+	}
+}
+
+void write_double(std::string& buffer, const double& value) {
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	write_fixed<uint64_t>(buffer, bits);
+}
+
+void write_varint(std::string& buffer, uint64_t value) {
+	while (value >= 0x80) {
+		buffer.push_back(char((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	buffer.push_back(char(value));
+}
+
+void write_zigzag(std::string& buffer, const int64_t& value) {
+	write_varint(buffer, (uint64_t(value) << 1) ^ uint64_t(value >> 63));
+}
+
+uint64_t system_timestamp(const chrono::time_point& timestamp) {
+	const chrono::time_point& system_time = chrono::time_point::convert_to(chrono::clock_type::SYSTEM, timestamp);
+	return chrono::duration::convert_to(chrono::time_unit::MSEC, system_time.time_since_epoch()).count();
+}
+
+struct dump_writer {
+	dump_writer(std::string& buffer, const uint64_t& base_timestamp)
+		: buffer(buffer)
+		, base_timestamp(base_timestamp)
+	{}
+
+	uint64_t add_string(const std::string& value) {
+		string_offsets.push_back(string_data.size());
+		string_data.append(value);
+		return string_offsets.size() - 1;
+	}
+
+	void write_timestamp(const chrono::time_point& timestamp) {
+		write_zigzag(buffer, int64_t(system_timestamp(timestamp) - base_timestamp));
+	}
+
+	void write_statistics(const statistics& values) {
+		const statistics::tag::type tags = values.tags();
+		write_varint(buffer, uint64_t(tags));
+
+		for (size_t bit = 0; bit < 8 * sizeof(statistics::tag::type) - 1; ++bit) {
+			const statistics::tag::type tag = statistics::tag::type(1) << bit;
+			if (!(tags & tag)) {
+				continue;
+			}
+
+			if (tag & DOUBLE_TAGS) {
+				double value = 0;
+				switch (tag) {
+					case statistics::tag::value: value = values.get<statistics::tag::value>(); break;
+					case statistics::tag::min: value = values.get<statistics::tag::min>(); break;
+					case statistics::tag::max: value = values.get<statistics::tag::max>(); break;
+					case statistics::tag::sum: value = values.get<statistics::tag::sum>(); break;
+					case statistics::tag::avg: value = values.get<statistics::tag::avg>(); break;
+					case statistics::tag::moving_count: value = values.get<statistics::tag::moving_count>(); break;
+					case statistics::tag::moving_sum: value = values.get<statistics::tag::moving_sum>(); break;
+					case statistics::tag::moving_avg: value = values.get<statistics::tag::moving_avg>(); break;
+					case statistics::tag::rate: value = values.get<statistics::tag::rate>(); break;
+					case statistics::tag::entropy: value = values.get<statistics::tag::entropy>(); break;
+				}
+				write_double(buffer, value);
+			}
+			else if (tag == statistics::tag::count) {
+				write_varint(buffer, values.get<statistics::tag::count>());
+			}
+			else if (tag == statistics::tag::histogram) {
+				const auto& histogram = values.get<statistics::tag::histogram>();
+				write_varint(buffer, histogram.size());
+				for (auto bin = histogram.begin(); bin != histogram.end(); ++bin) {
+					write_double(buffer, std::get<statistics::BIN_CENTER>(*bin));
+					write_double(buffer, std::get<statistics::BIN_COUNT>(*bin));
+				}
+			}
+			else if (tag == statistics::tag::quantile) {
+				const auto& quantile = values.get<statistics::tag::quantile>();
+				for (size_t index = 0; index < statistics_view::QUANTILES_COUNT; ++index) {
+					write_double(buffer, quantile.at(statistics_view::QUANTILES[index]));
+				}
+			}
+			else if (tag == statistics::tag::timestamp) {
+				write_timestamp(values.get<statistics::tag::timestamp>());
+			}
+		}
+	}
+
+	void write_metric(const std::string& name, const metrics::metric_variant& metric) {
+		buffer.push_back(char(metric.which()));
+		write_varint(buffer, add_string(name));
+
+		switch (metric.which()) {
+			case metrics::metric_index::GAUGE:
+				write_statistics(boost::get<metrics::gauge>(metric).values());
+				break;
+			case metrics::metric_index::COUNTER:
+				write_statistics(boost::get<metrics::counter>(metric).values());
+				break;
+			case metrics::metric_index::TIMER:
+				{
+					const auto& timer = boost::get<metrics::timer>(metric);
+					write_statistics(timer.values());
+
+					const auto& exemplars = timer.exemplars();
+					write_varint(buffer, exemplars.size());
+					for (auto exemplar = exemplars.begin(); exemplar != exemplars.end(); ++exemplar) {
+						write_zigzag(buffer, exemplar->value.count());
+						write_varint(buffer, exemplar->instance_id);
+						write_timestamp(exemplar->timestamp);
+					}
+					break;
+				}
+			case metrics::metric_index::ATTRIBUTE:
+				{
+					const auto& value = boost::get<metrics::attribute>(metric).value();
+					buffer.push_back(char(value.which()));
+					switch (value.which()) {
+						case metrics::attribute::value_index::BOOL:
+							buffer.push_back(char(boost::get<bool>(value)));
+							break;
+						case metrics::attribute::value_index::INT:
+							write_zigzag(buffer, boost::get<int>(value));
+							break;
+						case metrics::attribute::value_index::UINT:
+							write_varint(buffer, boost::get<unsigned>(value));
+							break;
+						case metrics::attribute::value_index::INT64:
+							write_zigzag(buffer, boost::get<int64_t>(value));
+							break;
+						case metrics::attribute::value_index::UINT64:
+							write_varint(buffer, boost::get<uint64_t>(value));
+							break;
+						case metrics::attribute::value_index::DOUBLE:
+							write_double(buffer, boost::get<double>(value));
+							break;
+						case metrics::attribute::value_index::STRING:
+							write_varint(buffer, add_string(boost::get<std::string>(value)));
+							break;
+					}
+					break;
+				}
+			case metrics::metric_index::UNIQUE:
+				{
+					const auto& unique = boost::get<metrics::unique>(metric);
+					write_double(buffer, unique.estimate());
+					write_double(buffer, unique.total());
+					write_timestamp(unique.timestamp());
+					break;
+				}
+			case metrics::metric_index::TOPK:
+				{
+					const auto& topk = boost::get<metrics::topk>(metric);
+					write_double(buffer, topk.total());
+
+					const auto& top = topk.top();
+					write_varint(buffer, top.size());
+					for (auto entry = top.begin(); entry != top.end(); ++entry) {
+						write_varint(buffer, add_string(entry->key));
+						write_double(buffer, entry->count);
+						write_double(buffer, entry->error);
+					}
+					write_timestamp(topk.timestamp());
+					break;
+				}
+			case metrics::metric_index::SPAN:
+				{
+					const auto& span = boost::get<metrics::span>(metric);
+					write_statistics(span.inclusive());
+					write_statistics(span.self());
+					break;
+				}
+		}
+	}
+
+	std::string& buffer;
+	const uint64_t base_timestamp;
+	std::vector<uint32_t> string_offsets;
+	std::string string_data;
+};
+
+/*
+ * Reader
+ */
+
+void check_bounds(const char* data, const size_t& size, const char* end) {
+	if (data > end || size_t(end - data) < size) {
+		throw std::invalid_argument("binary dump: unexpected end of data");
+	}
+}
+
+template <typename T>
+T read_fixed(const char* data) {
+	T value = 0;
+	for (size_t byte = 0; byte < sizeof(T); ++byte) {
+		value |= T(uint8_t(data[byte])) << (8 * byte);
+	}
+	return value;
+}
+
+template <typename T>
+T read_fixed(const char*& data, const char* end) {
+	check_bounds(data, sizeof(T), end);
+	const T value = read_fixed<T>(data);
+	data += sizeof(T);
+	return value;
+}
+
+double read_double(const char* data) {
+	const uint64_t bits = read_fixed<uint64_t>(data);
+	double value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+double read_double(const char*& data, const char* end) {
+	check_bounds(data, sizeof(double), end);
+	const double value = read_double(data);
+	data += sizeof(double);
+	return value;
+}
+
+uint64_t read_varint(const char*& data, const char* end) {
+	uint64_t value = 0;
+	for (size_t shift = 0; shift < 64; shift += 7) {
+		check_bounds(data, 1, end);
+		const uint8_t byte = uint8_t(*data++);
+		value |= uint64_t(byte & 0x7f) << shift;
+		if (!(byte & 0x80)) {
+			return value;
+		}
+	}
+	throw std::invalid_argument("binary dump: malformed varint");
+}
+
+int64_t read_zigzag(const char*& data, const char* end) {
+	const uint64_t value = read_varint(data, end);
+	return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
+
+template<typename MetricsMap>
+void write_dump(const MetricsMap& metrics_map, std::string& buffer) {
+	const uint64_t base_timestamp =
+		chrono::duration::convert_to(chrono::time_unit::MSEC, chrono::system_clock::now().time_since_epoch()).count();
+	// size of the view is counted by iteration, so it is taken once
+	const size_t metrics_count = metrics_map.size();
+
+	buffer.clear();
+	buffer.append(MAGIC, sizeof(MAGIC));
+	write_fixed<uint16_t>(buffer, FORMAT_VERSION);
+	write_fixed<uint16_t>(buffer, 0);
+	write_fixed<uint64_t>(buffer, metrics_map.version());
+	write_fixed<uint64_t>(buffer, base_timestamp);
+	write_fixed<uint32_t>(buffer, metrics_count);
+	write_fixed<uint32_t>(buffer, HEADER_SIZE);
+	// strings count, string table offset and total size are patched later
+	write_fixed<uint32_t>(buffer, 0);
+	write_fixed<uint32_t>(buffer, 0);
+	write_fixed<uint32_t>(buffer, 0);
+	write_fixed<uint32_t>(buffer, 0);
+
+	const size_t index_offset = buffer.size();
+	buffer.resize(index_offset + sizeof(uint32_t) * metrics_count);
+
+	dump_writer writer(buffer, base_timestamp);
+
+	size_t index = 0;
+	for (auto metric_iter = metrics_map.cbegin(); metric_iter != metrics_map.cend(); ++metric_iter, ++index) {
+		patch_fixed<uint32_t>(buffer, index_offset + sizeof(uint32_t) * index, buffer.size());
+		writer.write_metric(metric_iter->first, metric_iter->second);
+	}
+
+	const size_t string_table_offset = buffer.size();
+	for (auto offset = writer.string_offsets.begin(); offset != writer.string_offsets.end(); ++offset) {
+		write_fixed<uint32_t>(buffer, *offset);
+	}
+	write_fixed<uint32_t>(buffer, writer.string_data.size());
+	buffer.append(writer.string_data);
+
+	patch_fixed<uint32_t>(buffer, 32, writer.string_offsets.size());
+	patch_fixed<uint32_t>(buffer, 36, string_table_offset);
+	patch_fixed<uint32_t>(buffer, 40, buffer.size());
+}
+
+} // unnamed namespace
+
+
+void write(const handystats::metrics_dump::dump_map& metrics_map, std::string& buffer) {
+	write_dump(metrics_map, buffer);
+}
+
+std::string to_string(const handystats::metrics_dump::dump_map& metrics_map) {
+	std::string buffer;
+	write(metrics_map, buffer);
+	return buffer;
+}
+
+void write(const handystats::metrics_dump::dump_view& metrics_view, std::string& buffer) {
+	write_dump(metrics_view, buffer);
+}
+
+std::string to_string(const handystats::metrics_dump::dump_view& metrics_view) {
+	std::string buffer;
+	write(metrics_view, buffer);
+	return buffer;
+}
+
+static metrics_dump::rendered_dump binary_dump;
+
+static
+void render(const handystats::metrics_dump::dump_map& metrics_map, std::string& buffer) {
+	write(metrics_map, buffer);
+}
+
+const std::shared_ptr<const std::string> to_shared_string(const handystats::metrics_dump::dump_map& metrics_map) {
+	return binary_dump.get(metrics_map, render);
+}
+
+
+/*
+ * statistics_view
+ */
+
+const size_t statistics_view::QUANTILES_COUNT;
+const double statistics_view::QUANTILES[statistics_view::QUANTILES_COUNT] = {0.25, 0.50, 0.75, 0.90, 0.95};
+
+statistics_view::statistics_view(const char* data, const char* end, const uint64_t& base_timestamp)
+	: m_tags(statistics::tag::empty)
+	, m_end(end)
+	, m_base_timestamp(base_timestamp)
+	, m_next(nullptr)
+{
+	const uint64_t tags = read_varint(data, end);
+	if (tags >> (TAGS_COUNT - 1)) {
+		throw std::invalid_argument("binary dump: invalid statistics tags");
+	}
+	m_tags = statistics::tag::type(tags);
+
+	for (size_t bit = 0; bit < TAGS_COUNT; ++bit) {
+		const statistics::tag::type tag = statistics::tag::type(1) << bit;
+		m_fields[bit] = nullptr;
+		if (!(m_tags & tag)) {
+			continue;
+		}
+
+		m_fields[bit] = data;
+		if (tag & DOUBLE_TAGS) {
+			check_bounds(data, sizeof(double), end);
+			data += sizeof(double);
+		}
+		else if (tag == statistics::tag::count || tag == statistics::tag::timestamp) {
+			read_varint(data, end);
+		}
+		else if (tag == statistics::tag::histogram) {
+			const uint64_t bins = read_varint(data, end);
+			if (bins > size_t(end - data) / (2 * sizeof(double))) {
+				throw std::invalid_argument("binary dump: invalid histogram size");
+			}
+			data += bins * 2 * sizeof(double);
+		}
+		else if (tag == statistics::tag::quantile) {
+			check_bounds(data, QUANTILES_COUNT * sizeof(double), end);
+			data += QUANTILES_COUNT * sizeof(double);
+		}
+	}
+
+	m_next = data;
+}
+
+const char* statistics_view::field(const statistics::tag::type& tag) const {
+	if (!(m_tags & tag)) {
+		throw std::invalid_argument("binary dump: statistics tag is not enabled");
+	}
+	return m_fields[tag_bit(tag)];
+}
+
+statistics::tag::type statistics_view::tags() const {
+	return m_tags;
+}
+
+bool statistics_view::enabled(const statistics::tag::type& tag) const {
+	return (m_tags & tag) == tag;
+}
+
+double statistics_view::get(const statistics::tag::type& tag) const {
+	if (!(tag & DOUBLE_TAGS) || (tag & (tag - 1))) {
+		throw std::invalid_argument("binary dump: statistics tag is not double-valued");
+	}
+	return read_double(field(tag));
+}
+
+uint64_t statistics_view::count() const {
+	const char* data = field(statistics::tag::count);
+	return read_varint(data, m_end);
+}
+
+uint64_t statistics_view::timestamp() const {
+	const char* data = field(statistics::tag::timestamp);
+	return m_base_timestamp + read_zigzag(data, m_end);
+}
+
+double statistics_view::quantile(const size_t& index) const {
+	if (index >= QUANTILES_COUNT) {
+		throw std::invalid_argument("binary dump: invalid quantile index");
+	}
+	return read_double(field(statistics::tag::quantile) + index * sizeof(double));
+}
+
+size_t statistics_view::histogram_size() const {
+	const char* data = field(statistics::tag::histogram);
+	return read_varint(data, m_end);
+}
+
+std::pair<double, double> statistics_view::histogram_bin(const size_t& index) const {
+	const char* data = field(statistics::tag::histogram);
+	const uint64_t bins = read_varint(data, m_end);
+	if (index >= bins) {
+		throw std::invalid_argument("binary dump: invalid histogram bin index");
+	}
+	data += index * 2 * sizeof(double);
+	return std::make_pair(read_double(data), read_double(data + sizeof(double)));
+}
+
+
+/*
+ * metric_view
+ */
+
+metric_view::metric_view(const class reader* reader, const char* data)
+	: m_reader(reader)
+	, m_data(data)
+	, m_payload(nullptr)
+	, m_type(metrics::metric_index::COUNTER)
+	, m_name_index(0)
+{
+	const char* end = m_reader->m_data + m_reader->m_size;
+
+	const uint8_t type = read_fixed<uint8_t>(data, end);
+	if (type > metrics::metric_index::SPAN) {
+		throw std::invalid_argument("binary dump: invalid metric type");
+	}
+	m_type = metrics::metric_index(type);
+	m_name_index = read_varint(data, end);
+	m_payload = data;
+}
+
+void metric_view::check_type(const metrics::metric_index& type) const {
+	if (m_type != type) {
+		throw std::invalid_argument("binary dump: unexpected metric type");
+	}
+}
+
+const char* metric_view::name_data() const {
+	return m_reader->string(m_name_index).first;
+}
+
+size_t metric_view::name_size() const {
+	return m_reader->string(m_name_index).second;
+}
+
+std::string metric_view::name() const {
+	const auto& name = m_reader->string(m_name_index);
+	return std::string(name.first, name.second);
+}
+
+metrics::metric_index metric_view::type() const {
+	return m_type;
+}
+
+statistics_view metric_view::values() const {
+	if (m_type != metrics::metric_index::GAUGE &&
+			m_type != metrics::metric_index::COUNTER &&
+			m_type != metrics::metric_index::TIMER)
+	{
+		throw std::invalid_argument("binary dump: unexpected metric type");
+	}
+	return statistics_view(m_payload, m_reader->m_data + m_reader->m_size, m_reader->m_timestamp);
+}
+
+std::vector<metric_view::exemplar> metric_view::exemplars() const {
+	check_type(metrics::metric_index::TIMER);
+
+	const char* end = m_reader->m_data + m_reader->m_size;
+	const char* data = values().m_next;
+
+	const uint64_t count = read_varint(data, end);
+	if (count > size_t(end - data)) {
+		throw std::invalid_argument("binary dump: invalid exemplars count");
+	}
+
+	std::vector<exemplar> result(count);
+	for (size_t index = 0; index < count; ++index) {
+		result[index].value = read_zigzag(data, end);
+		result[index].instance_id = read_varint(data, end);
+		result[index].timestamp = m_reader->m_timestamp + read_zigzag(data, end);
+	}
+	return result;
+}
+
+metrics::attribute::value_type metric_view::attribute_value() const {
+	check_type(metrics::metric_index::ATTRIBUTE);
+
+	const char* end = m_reader->m_data + m_reader->m_size;
+	const char* data = m_payload;
+
+	switch (read_fixed<uint8_t>(data, end)) {
+		case metrics::attribute::value_index::BOOL:
+			return bool(read_fixed<uint8_t>(data, end));
+		case metrics::attribute::value_index::INT:
+			return int(read_zigzag(data, end));
+		case metrics::attribute::value_index::UINT:
+			return unsigned(read_varint(data, end));
+		case metrics::attribute::value_index::INT64:
+			return int64_t(read_zigzag(data, end));
+		case metrics::attribute::value_index::UINT64:
+			return uint64_t(read_varint(data, end));
+		case metrics::attribute::value_index::DOUBLE:
+			return read_double(data, end);
+		case metrics::attribute::value_index::STRING:
+			{
+				const auto& value = m_reader->string(read_varint(data, end));
+				return std::string(value.first, value.second);
+			}
+		default:
+			throw std::invalid_argument("binary dump: invalid attribute value type");
+	}
+}
+
+double metric_view::estimate() const {
+	check_type(metrics::metric_index::UNIQUE);
+
+	const char* data = m_payload;
+	return read_double(data, m_reader->m_data + m_reader->m_size);
+}
+
+double metric_view::total() const {
+	const char* end = m_reader->m_data + m_reader->m_size;
+	const char* data = m_payload;
+
+	if (m_type == metrics::metric_index::UNIQUE) {
+		data += sizeof(double);
+	}
+	else {
+		check_type(metrics::metric_index::TOPK);
+	}
+	return read_double(data, end);
+}
+
+uint64_t metric_view::timestamp() const {
+	const char* end = m_reader->m_data + m_reader->m_size;
+	const char* data = m_payload;
+
+	if (m_type == metrics::metric_index::UNIQUE) {
+		data += 2 * sizeof(double);
+	}
+	else {
+		check_type(metrics::metric_index::TOPK);
+		data += sizeof(double);
+		const uint64_t count = read_varint(data, end);
+		for (uint64_t index = 0; index < count; ++index) {
+			read_varint(data, end);
+			check_bounds(data, 2 * sizeof(double), end);
+			data += 2 * sizeof(double);
+		}
+	}
+	return m_reader->m_timestamp + read_zigzag(data, end);
+}
+
+std::vector<metric_view::top_entry> metric_view::top() const {
+	check_type(metrics::metric_index::TOPK);
+
+	const char* end = m_reader->m_data + m_reader->m_size;
+	const char* data = m_payload + sizeof(double);
+
+	const uint64_t count = read_varint(data, end);
+	if (count > size_t(end - data)) {
+		throw std::invalid_argument("binary dump: invalid top size");
+	}
+
+	std::vector<top_entry> result(count);
+	for (size_t index = 0; index < count; ++index) {
+		const auto& key = m_reader->string(read_varint(data, end));
+		result[index].key_data = key.first;
+		result[index].key_size = key.second;
+		result[index].count = read_double(data, end);
+		result[index].error = read_double(data, end);
+	}
+	return result;
+}
+
+statistics_view metric_view::inclusive() const {
+	check_type(metrics::metric_index::SPAN);
+	return statistics_view(m_payload, m_reader->m_data + m_reader->m_size, m_reader->m_timestamp);
+}
+
+statistics_view metric_view::self() const {
+	return statistics_view(inclusive().m_next, m_reader->m_data + m_reader->m_size, m_reader->m_timestamp);
+}
+
+
+/*
+ * reader
+ */
+
+reader::reader(const char* data, const size_t& size)
+	: m_data(data)
+	, m_size(size)
+{
+	init();
+}
+
+reader::reader(const std::string& buffer)
+	: m_data(buffer.data())
+	, m_size(buffer.size())
+{
+	init();
+}
+
+void reader::init() {
+	if (m_size < HEADER_SIZE || memcmp(m_data, MAGIC, sizeof(MAGIC)) != 0) {
+		throw std::invalid_argument("binary dump: invalid header");
+	}
+	if (format_version() != FORMAT_VERSION) {
+		throw std::invalid_argument("binary dump: unsupported format version");
+	}
+
+	m_version = read_fixed<uint64_t>(m_data + 8);
+	m_timestamp = read_fixed<uint64_t>(m_data + 16);
+	m_metrics_count = read_fixed<uint32_t>(m_data + 24);
+	const uint32_t index_offset = read_fixed<uint32_t>(m_data + 28);
+	m_strings_count = read_fixed<uint32_t>(m_data + 32);
+	const uint32_t string_table_offset = read_fixed<uint32_t>(m_data + 36);
+	const uint32_t total_size = read_fixed<uint32_t>(m_data + 40);
+
+	if (total_size != m_size ||
+			index_offset > m_size || (m_size - index_offset) / sizeof(uint32_t) < m_metrics_count ||
+			string_table_offset > m_size || (m_size - string_table_offset) / sizeof(uint32_t) <= m_strings_count
+		)
+	{
+		throw std::invalid_argument("binary dump: invalid header");
+	}
+
+	m_index = m_data + index_offset;
+	m_string_offsets = m_data + string_table_offset;
+	m_string_data = m_string_offsets + sizeof(uint32_t) * (m_strings_count + 1);
+
+	const uint32_t string_data_size = read_fixed<uint32_t>(m_string_offsets + sizeof(uint32_t) * m_strings_count);
+	if (string_data_size != size_t(m_data + m_size - m_string_data)) {
+		throw std::invalid_argument("binary dump: invalid string table");
+	}
+}
+
+uint16_t reader::format_version() const {
+	return read_fixed<uint16_t>(m_data + 4);
+}
+
+uint64_t reader::version() const {
+	return m_version;
+}
+
+uint64_t reader::timestamp() const {
+	return m_timestamp;
+}
+
+size_t reader::size() const {
+	return m_metrics_count;
+}
+
+metric_view reader::operator[](const size_t& index) const {
+	if (index >= m_metrics_count) {
+		throw std::invalid_argument("binary dump: invalid metric index");
+	}
+
+	const uint32_t offset = read_fixed<uint32_t>(m_index + sizeof(uint32_t) * index);
+	if (offset >= m_size) {
+		throw std::invalid_argument("binary dump: invalid metric offset");
+	}
+	return metric_view(this, m_data + offset);
+}
+
+size_t reader::find(const std::string& name) const {
+	size_t low = 0;
+	size_t high = m_metrics_count;
+	while (low < high) {
+		const size_t middle = low + (high - low) / 2;
+		const metric_view& metric = (*this)[middle];
+
+		const size_t common_size = std::min(metric.name_size(), name.size());
+		int cmp = memcmp(metric.name_data(), name.data(), common_size);
+		if (cmp == 0) {
+			cmp = metric.name_size() < name.size() ? -1 : (metric.name_size() > name.size() ? 1 : 0);
+		}
+
+		if (cmp == 0) {
+			return middle;
+		}
+		else if (cmp < 0) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+	return m_metrics_count;
+}
+
+std::pair<const char*, size_t> reader::string(const uint64_t& index) const {
+	if (index >= m_strings_count) {
+		throw std::invalid_argument("binary dump: invalid string index");
+	}
+
+	const uint32_t begin = read_fixed<uint32_t>(m_string_offsets + sizeof(uint32_t) * index);
+	const uint32_t end = read_fixed<uint32_t>(m_string_offsets + sizeof(uint32_t) * (index + 1));
+	if (begin > end || end > size_t(m_data + m_size - m_string_data)) {
+		throw std::invalid_argument("binary dump: invalid string offset");
+	}
+	return std::make_pair(m_string_data + begin, size_t(end - begin));
+}
+
+}} // namespace handystats::binary
+
+std::string HANDY_BINARY_DUMP() {
+	return *HANDY_BINARY_DUMP_SHARED();
+}
+
+const std::shared_ptr<const std::string> HANDY_BINARY_DUMP_SHARED() {
+	return handystats::binary::to_shared_string(*HANDY_METRICS_DUMP());
+}
@@ -16,12 +16,15 @@
 */
 
 #include <handystats/atomic.hpp>
+#include <mutex>
 #include <stdexcept>
 #include <ctime>
 
 #include <handystats/chrono.h>
 #include <handystats/chrono.hpp>
 
+#include "chrono_impl.hpp"
+
 namespace handystats { namespace chrono {
 
 static
@@ -46,83 +49,231 @@ inline uint64_t nsec_factor(const time_unit& unit) {
 	return 0ull;
 }
 
-extern long double cycles_per_nanosec;
-
 duration duration::convert_to(const time_unit& to_unit, const duration& d) {
 	if (d.m_unit == to_unit) return d;
 
+	// TICK conversions use fixed-point TSC rate, no floating-point math is involved
 	if (to_unit == time_unit::TICK) {
-		return duration(int64_t(cycles_per_nanosec * nsec_factor(d.m_unit) * d.m_rep), to_unit);
+		calibrate();
+		return duration(nanosec_to_cycles(int128_t(nsec_factor(d.m_unit)) * d.m_rep), to_unit);
 	}
 
 	if (d.m_unit == time_unit::TICK) {
-		return duration(int64_t(double(d.m_rep) / nsec_factor(to_unit) / cycles_per_nanosec), to_unit);
+		calibrate();
+		return duration(cycles_to_nanosec(d.m_rep) / int64_t(nsec_factor(to_unit)), to_unit);
 	}
 
 	return duration(nsec_factor(d.m_unit) * d.m_rep / nsec_factor(to_unit), to_unit);
 }
 
 /* Conversion to system time */
+
+// Mapping of internal time to system time is the tied pair and the slope:
+//   t_sys = base_system + (t - base_internal) * slope
+// where slope is the number of nanoseconds per internal time unit (FIXED_POINT_SHIFT fractional bits).
+// Mapping is updated by handystats core's thread and published under seqlock,
+// so conversion on any thread is a few loads and a multiply-add.
+namespace {
+
+struct system_time_mapping {
+	int64_t base_internal;
+	int64_t base_system;
+	uint64_t slope;
+	time_unit unit;
+};
+
+// odd sequence -- update in progress, 0 -- mapping is not published yet
+std::atomic<uint64_t> mapping_sequence(0);
+std::atomic<int64_t> mapping_base_internal(0);
+std::atomic<int64_t> mapping_base_system(0);
+std::atomic<uint64_t> mapping_slope(0);
+std::atomic<int> mapping_unit(0);
+
+std::atomic<int64_t> mapping_drift(0);
+
+// writer's state
+std::mutex mapping_mutex;
+int64_t anchor_internal = 0;
+int64_t anchor_system = 0;
+time_unit anchor_unit = time_unit::TICK;
+bool anchor_set = false;
+
+// mapping is updated by core's thread once per UPDATE_INTERVAL,
+// it's updated by the converting thread only if it's older than STALE_INTERVAL (core is not running)
+const duration UPDATE_INTERVAL (1, time_unit::SEC);
+const duration STALE_INTERVAL (15, time_unit::SEC);
+const duration CLOSE_DISTANCE (15, time_unit::USEC);
+const uint64_t MAX_UPDATE_TRIES (100);
+// drift above this threshold is treated as system time step, slope is measured from scratch
+const int64_t MAX_DRIFT_NSEC (1000 * 1000);
+
+bool load_mapping(system_time_mapping& mapping) {
+	while (true) {
+		const uint64_t sequence = mapping_sequence.load(std::memory_order_acquire);
+		if (sequence == 0) {
+			return false;
+		}
+		if (sequence & 1) {
+			continue;
+		}
+
+		mapping.base_internal = mapping_base_internal.load(std::memory_order_relaxed);
+		mapping.base_system = mapping_base_system.load(std::memory_order_relaxed);
+		mapping.slope = mapping_slope.load(std::memory_order_relaxed);
+		mapping.unit = time_unit(mapping_unit.load(std::memory_order_relaxed));
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (mapping_sequence.load(std::memory_order_relaxed) == sequence) {
+			return true;
+		}
+	}
+}
+
+void store_mapping(const system_time_mapping& mapping) {
+	const uint64_t sequence = mapping_sequence.load(std::memory_order_relaxed);
+
+	mapping_sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	mapping_base_internal.store(mapping.base_internal, std::memory_order_relaxed);
+	mapping_base_system.store(mapping.base_system, std::memory_order_relaxed);
+	mapping_slope.store(mapping.slope, std::memory_order_relaxed);
+	mapping_unit.store(int(mapping.unit), std::memory_order_relaxed);
+
+	mapping_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+inline
+int64_t map_to_system(const system_time_mapping& mapping, const int64_t& internal) {
+	return mapping.base_system + fixed_point_multiply(int128_t(internal) - mapping.base_internal, mapping.slope);
+}
+
+uint64_t nominal_slope(const time_unit& unit) {
+	if (unit == time_unit::TICK) {
+		calibrate();
+		return nanosec_per_cycle_fixed.load(std::memory_order_acquire);
+	}
+	return uint64_t(nsec_factor(unit)) << FIXED_POINT_SHIFT;
+}
+
+// should be called under mapping_mutex
+void update_mapping() {
+	time_point cycles_start, cycles_end;
+	time_point system_time;
+
+	int64_t best_distance = -1;
+	int64_t internal = 0, system = 0;
+
+	for (uint64_t update_try = 0; update_try < MAX_UPDATE_TRIES; ++update_try) {
+		cycles_start = tsc_clock::now();
+		system_time = system_clock::now();
+		cycles_end = tsc_clock::now();
+
+		const int64_t distance = (cycles_end - cycles_start).count();
+		if (best_distance < 0 || distance < best_distance) {
+			best_distance = distance;
+			internal = cycles_start.time_since_epoch().count() + distance / 2;
+			system = system_time.time_since_epoch().count();
+		}
+
+		if (cycles_end - cycles_start < CLOSE_DISTANCE) {
+			break;
+		}
+	}
+
+	const time_unit unit = cycles_start.time_since_epoch().unit();
+
+	system_time_mapping previous;
+	int64_t drift = 0;
+	if (load_mapping(previous) && previous.unit == unit) {
+		drift = system - map_to_system(previous, internal);
+	}
+	else {
+		anchor_set = false;
+	}
+
+	if (drift > MAX_DRIFT_NSEC || drift < -MAX_DRIFT_NSEC || anchor_unit != unit || internal <= anchor_internal) {
+		anchor_set = false;
+	}
+
+	system_time_mapping mapping;
+	mapping.base_internal = internal;
+	mapping.base_system = system;
+	mapping.unit = unit;
+
+	if (!anchor_set) {
+		anchor_internal = internal;
+		anchor_system = system;
+		anchor_unit = unit;
+		anchor_set = true;
+
+		mapping.slope = nominal_slope(unit);
+	}
+	else {
+		// slope is measured over the whole time since anchor to dilute tied pair's error
+		mapping.slope = uint64_t(
+				(int128_t(system - anchor_system) << FIXED_POINT_SHIFT) / (internal - anchor_internal)
+			);
+	}
+
+	store_mapping(mapping);
+	mapping_drift.store(drift, std::memory_order_release);
+}
+
+} // unnamed namespace
+
+bool update_system_time_mapping() {
+	system_time_mapping mapping;
+	if (load_mapping(mapping)) {
+		const time_point& now = tsc_clock::now();
+		if (now.time_since_epoch().unit() == mapping.unit &&
+				now.time_since_epoch() - duration(mapping.base_internal, mapping.unit) < UPDATE_INTERVAL
+			)
+		{
+			return false;
+		}
+	}
+
+	std::unique_lock<std::mutex> lock(mapping_mutex, std::try_to_lock);
+	if (!lock.owns_lock()) {
+		return false;
+	}
+
+	update_mapping();
+	return true;
+}
+
+int64_t system_time_drift() {
+	return mapping_drift.load(std::memory_order_acquire);
+}
+
 static
 time_point to_system_time(const time_point& t) {
-	static std::atomic<int64_t> ns_offset(0);
-	static std::atomic<int64_t> offset_timestamp(0);
-	static std::atomic_flag lock = ATOMIC_FLAG_INIT;
-
-	static const duration OFFSET_TIMEOUT (15 * (int64_t)1E9, time_unit::NSEC);
-	static const duration CLOSE_DISTANCE (15 * (int64_t)1E3, time_unit::NSEC);
-	static const uint64_t MAX_UPDATE_TRIES (100);
-
-	time_point current_tsc_time = tsc_clock::now();
-	time_unit tsc_unit = current_tsc_time.time_since_epoch().unit();
-
-	int64_t offset_ts = offset_timestamp.load(std::memory_order_acquire);
-
-	if (offset_ts == 0 ||
-			current_tsc_time.time_since_epoch() - duration(offset_ts, tsc_unit) > OFFSET_TIMEOUT
-		)
-	{
-		if (!lock.test_and_set(std::memory_order_acquire)) {
-			time_point cycles_start, cycles_end;
-			time_point current_system_time;
-
-			bool close_pair_found = false;
-			for (uint64_t update_try = 0; update_try < MAX_UPDATE_TRIES; ++update_try) {
-				cycles_start = tsc_clock::now();
-				current_system_time = system_clock::now();
-				cycles_end = tsc_clock::now();
-
-				if (cycles_end - cycles_start < CLOSE_DISTANCE) {
-					close_pair_found = true;
-					break;
-				}
-			}
+	system_time_mapping mapping;
 
-			if (close_pair_found) {
-				time_point cycles_middle = cycles_start + (cycles_end - cycles_start) / 2;
-				int64_t new_offset =
-					duration::convert_to(
-						time_unit::NSEC,
-						current_system_time.time_since_epoch() - cycles_middle.time_since_epoch()
-					)
-					.count();
-
-				ns_offset.store(new_offset, std::memory_order_release);
-				offset_timestamp.store(cycles_middle.time_since_epoch().count(), std::memory_order_release);
+	if (!load_mapping(mapping)) {
+		{
+			std::lock_guard<std::mutex> lock(mapping_mutex);
+			if (mapping_sequence.load(std::memory_order_acquire) == 0) {
+				update_mapping();
 			}
+		}
+		load_mapping(mapping);
+	}
 
-			lock.clear(std::memory_order_release);
+	// core's thread is not running, mapping is refreshed here
+	if (t.time_since_epoch() - duration(mapping.base_internal, mapping.unit) > STALE_INTERVAL) {
+		std::unique_lock<std::mutex> lock(mapping_mutex, std::try_to_lock);
+		if (lock.owns_lock()) {
+			update_mapping();
+			lock.unlock();
+			load_mapping(mapping);
 		}
 	}
 
-	return
-		time_point(
-			duration::convert_to(
-				time_unit::NSEC,
-				t.time_since_epoch() + duration(ns_offset.load(std::memory_order_acquire), time_unit::NSEC)
-			),
-			clock_type::SYSTEM
-		);
+	const duration& since_epoch = duration::convert_to(mapping.unit, t.time_since_epoch());
+
+	return time_point(duration(map_to_system(mapping, since_epoch.count()), time_unit::NSEC), clock_type::SYSTEM);
 }
 
 time_point time_point::convert_to(const clock_type& to_clock, const time_point& t) {
@@ -21,15 +21,42 @@
 #include <cassert>
 #include <algorithm>
 #include <ctime>
+#include <fstream>
+#include <mutex>
 #include <unistd.h>
 
 #include <handystats/chrono.hpp>
 
 #include "cpuid_impl.hpp"
+#include "chrono_impl.hpp"
 
 namespace handystats { namespace chrono {
 
 inline uint64_t rdtsc() {
+	uint64_t tsc;
+	asm volatile (
+			"rdtsc; "
+			"shl $32,%%rdx; "
+			"or %%rdx,%%rax "
+			: "=a"(tsc)
+			:
+			: "%rdx");
+	return tsc;
+}
+
+inline uint64_t rdtsc_lfence() {
+	uint64_t tsc;
+	asm volatile (
+			"lfence; rdtsc; "
+			"shl $32,%%rdx; "
+			"or %%rdx,%%rax "
+			: "=a"(tsc)
+			:
+			: "%rdx");
+	return tsc;
+}
+
+inline uint64_t rdtsc_mfence() {
 	uint64_t tsc;
 	asm volatile (
 			"mfence; rdtsc; "
@@ -37,7 +64,7 @@ inline uint64_t rdtsc() {
 			"or %%rdx,%%rax "
 			: "=a"(tsc)
 			:
-			: "%rcx", "%rdx");
+			: "%rdx");
 	return tsc;
 }
 
@@ -53,73 +80,167 @@ inline uint64_t rdtscp() {
 	return tsc;
 }
 
-long double cycles_per_nanosec;
+std::atomic<double> cycles_per_nanosec(0);
+std::atomic<uint64_t> cycles_per_nanosec_fixed(0);
+std::atomic<uint64_t> nanosec_per_cycle_fixed(0);
+std::atomic<bool> calibrated_flag(false);
 
 }} // namespace handystats::chrono
 
 
 namespace {
 
-// Clock sources
-enum clock_source_t {
-	CS_RDTSC,
-	CS_RDTSCP,
-	CS_CLOCK_MONOTONIC,
-	CS_CLOCK_REALTIME
-};
+using handystats::chrono::clock_source;
+using handystats::chrono::time_point;
+using handystats::chrono::duration;
+using handystats::chrono::time_unit;
+using handystats::chrono::clock_type;
+
+bool clock_source_supported(const clock_source& source) {
+	switch (source) {
+	case clock_source::RDTSC:
+	case clock_source::RDTSC_LFENCE:
+	case clock_source::RDTSC_MFENCE:
+		return handystats::tsc_supported();
+	case clock_source::RDTSCP:
+		return handystats::tsc_supported() && handystats::rdtscp_supported();
+	case clock_source::MONOTONIC:
+		return sysconf(_SC_MONOTONIC_CLOCK) >= 0;
+	case clock_source::REALTIME:
+		return true;
+	}
+
+	return false;
+}
+
+bool tsc_clock_source(const clock_source& source) {
+	return source != clock_source::MONOTONIC && source != clock_source::REALTIME;
+}
 
-clock_source_t get_available_clock_source() {
+clock_source get_available_clock_source() {
 	// check HANDY_CLOCK_SOURCE env variable first.
 	// possible values:
 	// - RDTSC
+	// - RDTSC_LFENCE
 	// - RDTSCP
+	// - RDTSC_MFENCE
 	// - CLOCK_MONOTONIC
 	// - CLOCK_REALTIME
 	//
-	// if invalid value is passed CS_CLOCK_REALTIME will be used.
+	// if invalid value is passed CLOCK_REALTIME will be used.
 
 	if (const char* env_clock_source = std::getenv("HANDY_CLOCK_SOURCE")) {
 		if (strcmp(env_clock_source, "RDTSCP") == 0) {
-			return CS_RDTSCP;
+			return clock_source::RDTSCP;
 		}
 		else if (strcmp(env_clock_source, "RDTSC") == 0) {
-			return CS_RDTSC;
+			return clock_source::RDTSC;
+		}
+		else if (strcmp(env_clock_source, "RDTSC_LFENCE") == 0) {
+			return clock_source::RDTSC_LFENCE;
+		}
+		else if (strcmp(env_clock_source, "RDTSC_MFENCE") == 0) {
+			return clock_source::RDTSC_MFENCE;
 		}
 		else if (strcmp(env_clock_source, "CLOCK_MONOTONIC") == 0) {
-			return CS_CLOCK_MONOTONIC;
+			return clock_source::MONOTONIC;
 		}
 		else if (strcmp(env_clock_source, "CLOCK_REALTIME") == 0) {
-			return CS_CLOCK_REALTIME;
+			return clock_source::REALTIME;
 		}
 
-		return CS_CLOCK_REALTIME;
+		return clock_source::REALTIME;
 	}
 
 	if (handystats::tsc_supported() && handystats::invariant_tsc())
 	{
 		if (handystats::rdtscp_supported()) {
-			return CS_RDTSCP;
+			return clock_source::RDTSCP;
 		}
 		else {
-			return CS_RDTSC;
+			return clock_source::RDTSC_MFENCE;
 		}
 	}
 	else {
 		// fallback to POSIX clocks
-		if (sysconf(_SC_MONOTONIC_CLOCK) >= 0) {
-			return CS_CLOCK_MONOTONIC;
+		if (clock_source_supported(clock_source::MONOTONIC)) {
+			return clock_source::MONOTONIC;
 		}
 		else {
-			return CS_CLOCK_REALTIME;
+			return clock_source::REALTIME;
 		}
 	}
 }
 
-clock_source_t clock_source;
+
+/*
+ * Clock source readers
+ * Reader is resolved once on source selection, so now() costs single indirect call
+ */
+template <uint64_t (*read_tsc)()>
+time_point tsc_now() {
+	return time_point(duration(read_tsc(), time_unit::TICK), clock_type::TSC);
+}
+
+template <clockid_t posix_clock>
+time_point posix_now() {
+	timespec tm;
+
+	clock_gettime(posix_clock, &tm);
+
+	return time_point(duration((int64_t)tm.tv_sec * (int64_t)1E9 + tm.tv_nsec, time_unit::NSEC), clock_type::TSC);
+}
+
+typedef time_point (*now_function_t)();
+typedef uint64_t (*cycles_function_t)();
+
+time_point resolve_now();
+
+// source could be switched by tsc_clock::set_source() while other threads take time points,
+// so the functions are atomic, relaxed loads are plain loads on x86
+std::atomic<clock_source> current_clock_source(clock_source::RDTSCP);
+
+// constant initialized, so tsc_clock::now() could be called from other static constructors
+std::atomic<now_function_t> now_function(resolve_now);
+std::atomic<cycles_function_t> cycles_function(handystats::chrono::rdtscp);
+
+void select_clock_source(const clock_source& source) {
+	switch (source) {
+	case clock_source::RDTSC:
+		cycles_function.store(handystats::chrono::rdtsc, std::memory_order_relaxed);
+		now_function.store(tsc_now<handystats::chrono::rdtsc>, std::memory_order_relaxed);
+		break;
+	case clock_source::RDTSC_LFENCE:
+		cycles_function.store(handystats::chrono::rdtsc_lfence, std::memory_order_relaxed);
+		now_function.store(tsc_now<handystats::chrono::rdtsc_lfence>, std::memory_order_relaxed);
+		break;
+	case clock_source::RDTSCP:
+		cycles_function.store(handystats::chrono::rdtscp, std::memory_order_relaxed);
+		now_function.store(tsc_now<handystats::chrono::rdtscp>, std::memory_order_relaxed);
+		break;
+	case clock_source::RDTSC_MFENCE:
+		cycles_function.store(handystats::chrono::rdtsc_mfence, std::memory_order_relaxed);
+		now_function.store(tsc_now<handystats::chrono::rdtsc_mfence>, std::memory_order_relaxed);
+		break;
+	case clock_source::MONOTONIC:
+		now_function.store(posix_now<CLOCK_MONOTONIC>, std::memory_order_relaxed);
+		break;
+	case clock_source::REALTIME:
+		now_function.store(posix_now<CLOCK_REALTIME>, std::memory_order_relaxed);
+		break;
+	}
+
+	current_clock_source.store(source, std::memory_order_relaxed);
+}
 
 __attribute__((constructor(150)))
 void init_clock_source() {
-	clock_source = get_available_clock_source();
+	select_clock_source(get_available_clock_source());
+}
+
+time_point resolve_now() {
+	init_clock_source();
+	return now_function.load(std::memory_order_relaxed)();
 }
 
 
@@ -140,24 +261,30 @@ uint64_t get_nanoseconds() {
 }
 
 uint64_t get_cycles_count() {
-	if (clock_source == CS_RDTSC) {
-		return handystats::chrono::rdtsc();
-	}
-	else {
-		return handystats::chrono::rdtscp();
-	}
+	return cycles_function.load(std::memory_order_relaxed)();
 }
 
 
 const uint64_t CYCLES_DELTA = 15000;
+const int MAX_PAIR_TRIES = 100;
 
+// pair of TSC and CLOCK_MONOTONIC values that correspond to the same point in time
+// on noisy (e.g. virtualized) systems the closest pair among bounded number of tries is chosen
 void get_simultaneous_pair(uint64_t* cycles_count, uint64_t* nanoseconds) {
-	while(true) {
-		uint64_t tsc1 = get_cycles_count();
-		*nanoseconds = get_nanoseconds();
-		uint64_t tsc2 = get_cycles_count();
-		if (tsc2 - tsc1 < CYCLES_DELTA) {
+	uint64_t best_delta = uint64_t(-1);
+
+	for (int pair_try = 0; pair_try < MAX_PAIR_TRIES; ++pair_try) {
+		const uint64_t tsc1 = get_cycles_count();
+		const uint64_t current_nanoseconds = get_nanoseconds();
+		const uint64_t tsc2 = get_cycles_count();
+
+		if (tsc2 - tsc1 < best_delta) {
+			best_delta = tsc2 - tsc1;
 			*cycles_count = tsc1 + (tsc2 - tsc1) / 2;
+			*nanoseconds = current_nanoseconds;
+		}
+
+		if (best_delta < CYCLES_DELTA) {
 			break;
 		}
 	}
@@ -169,14 +296,14 @@ long double get_cycles_frequency(const timespec& sleep_interval) {
 
 	get_simultaneous_pair(&cycles_start, &nanoseconds_start);
 
-	assert(nanosleep(&sleep_interval, NULL) == 0);
+	nanosleep(&sleep_interval, NULL);
 
 	get_simultaneous_pair(&cycles_end, &nanoseconds_end);
 
 	return (long double)(cycles_end - cycles_start) / (nanoseconds_end - nanoseconds_start);
 }
 
-void estimate_cycles_frequency() {
+double estimate_cycles_frequency() {
 	const timespec sleep_interval = {0, (long)1E6}; // 1ms
 
 	const int TESTS_COUNT = 15;
@@ -187,55 +314,180 @@ void estimate_cycles_frequency() {
 	}
 
 	std::sort(cycles_tests, cycles_tests + TESTS_COUNT);
-	handystats::chrono::cycles_per_nanosec = cycles_tests[TESTS_COUNT / 2];
+	return cycles_tests[TESTS_COUNT / 2];
 }
 
-__attribute__((constructor(200)))
-void init_cycles_per_nanosec() {
-	if (clock_source == CS_RDTSC || clock_source == CS_RDTSCP) {
-		estimate_cycles_frequency();
+
+/*
+ * Nominal TSC rate reported by processor, hypervisor or kernel
+ * Zero is returned if rate is not available
+ */
+double cpuid_cycles_frequency() {
+	uint32_t eax, ebx, ecx, edx;
+
+	if (__get_cpuid_max(0, NULL) < 0x15 || !__get_cpuid(0x15, &eax, &ebx, &ecx, &edx) || eax == 0 || ebx == 0) {
+		return 0;
 	}
-	else {
-		handystats::chrono::cycles_per_nanosec = 3;
+
+	// TSC rate = crystal clock * (ebx / eax)
+	if (ecx != 0) {
+		return double(ecx) * ebx / eax / 1E9;
 	}
+
+	// crystal clock is not enumerated, processor's base frequency equals TSC rate
+	if (__get_cpuid_max(0, NULL) >= 0x16 && __get_cpuid(0x16, &eax, &ebx, &ecx, &edx) && (eax & 0xffff) != 0) {
+		return double(eax & 0xffff) / 1E3;
+	}
+
+	return 0;
 }
 
+double hypervisor_cycles_frequency() {
+	uint32_t eax, ebx, ecx, edx;
+
+	// hypervisor present bit (1 ECX Bit 31)
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || ((ecx >> 31) & 1) == 0) {
+		return 0;
+	}
+
+	__cpuid(0x40000000, eax, ebx, ecx, edx);
+	if (eax < 0x40000010) {
+		return 0;
+	}
+
+	// TSC rate in kHz
+	__cpuid(0x40000010, eax, ebx, ecx, edx);
+	return double(eax) / 1E6;
+}
+
+double sysfs_cycles_frequency() {
+	std::ifstream tsc_freq_file("/sys/devices/system/cpu/cpu0/tsc_freq_khz");
+
+	uint64_t tsc_freq_khz = 0;
+	if (!(tsc_freq_file >> tsc_freq_khz)) {
+		return 0;
+	}
+
+	return double(tsc_freq_khz) / 1E6;
+}
+
+
+std::mutex calibration_mutex;
+handystats::chrono::calibration_source current_calibration_source = handystats::chrono::calibration_source::NONE;
+
+// TSC and CLOCK_MONOTONIC values at calibration and at the last refinement
+uint64_t calibration_cycles = 0;
+uint64_t calibration_nanoseconds = 0;
+std::atomic<uint64_t> refinement_cycles(0);
+
+const uint64_t REFINEMENT_INTERVAL_NSEC = 1000ull * 1000ull * 1000ull;
+
 } // unnamed namespace
 
 
 namespace handystats { namespace chrono {
 
+void set_cycles_per_nanosec(const double& rate) {
+	const long double one = (long double)(1ull << FIXED_POINT_SHIFT);
+
+	// fixed-point values are published first, so that readers that observe calibrated_flag see them as well
+	cycles_per_nanosec_fixed.store(uint64_t(one * rate + 0.5), std::memory_order_release);
+	nanosec_per_cycle_fixed.store(uint64_t(one / rate + 0.5), std::memory_order_release);
+	cycles_per_nanosec.store(rate, std::memory_order_release);
+}
+
+void calibrate_slow() {
+	std::lock_guard<std::mutex> lock(calibration_mutex);
+
+	if (calibrated_flag.load(std::memory_order_acquire)) {
+		return;
+	}
+
+	if (!tsc_clock_source(current_clock_source.load(std::memory_order_relaxed))) {
+		// time points of POSIX sources are in nanoseconds
+		set_cycles_per_nanosec(3);
+		current_calibration_source = calibration_source::POSIX;
+		calibrated_flag.store(true, std::memory_order_release);
+		return;
+	}
+
+	double rate = 0;
+	if ((rate = cpuid_cycles_frequency()) > 0) {
+		current_calibration_source = calibration_source::CPUID;
+	}
+	else if ((rate = hypervisor_cycles_frequency()) > 0) {
+		current_calibration_source = calibration_source::HYPERVISOR;
+	}
+	else if ((rate = sysfs_cycles_frequency()) > 0) {
+		current_calibration_source = calibration_source::SYSFS;
+	}
+	else {
+		rate = estimate_cycles_frequency();
+		current_calibration_source = calibration_source::MEASUREMENT;
+	}
+
+	get_simultaneous_pair(&calibration_cycles, &calibration_nanoseconds);
+	refinement_cycles.store(calibration_cycles, std::memory_order_release);
+
+	set_cycles_per_nanosec(rate);
+	calibrated_flag.store(true, std::memory_order_release);
+}
+
+calibration_source calibrated_by() {
+	std::lock_guard<std::mutex> lock(calibration_mutex);
+	return current_calibration_source;
+}
+
+void refine_calibration() {
+	if (!calibrated_flag.load(std::memory_order_acquire) || !tsc_clock_source(current_clock_source.load(std::memory_order_relaxed))) {
+		return;
+	}
+
+	const uint64_t refinement_interval_cycles =
+		uint64_t(cycles_per_nanosec.load(std::memory_order_acquire) * REFINEMENT_INTERVAL_NSEC);
+	if (get_cycles_count() - refinement_cycles.load(std::memory_order_acquire) < refinement_interval_cycles) {
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(calibration_mutex, std::try_to_lock);
+	if (!lock.owns_lock() || !calibrated_flag.load(std::memory_order_acquire)) {
+		return;
+	}
+
+	uint64_t cycles, nanoseconds;
+	get_simultaneous_pair(&cycles, &nanoseconds);
+
+	if (cycles > calibration_cycles && nanoseconds > calibration_nanoseconds) {
+		set_cycles_per_nanosec(double(cycles - calibration_cycles) / (nanoseconds - calibration_nanoseconds));
+	}
+	refinement_cycles.store(cycles, std::memory_order_release);
+}
+
+
 time_point tsc_clock::now() {
-	switch (clock_source) {
-	case CS_RDTSC:
-		{
-			return time_point(duration(rdtsc(), time_unit::TICK), clock_type::TSC);
-		}
-	case CS_RDTSCP:
-		{
-			return time_point(duration(rdtscp(), time_unit::TICK), clock_type::TSC);
-		}
-	case CS_CLOCK_MONOTONIC:
-		{
-			timespec tm;
+	return now_function.load(std::memory_order_relaxed)();
+}
 
-			clock_gettime(CLOCK_MONOTONIC, &tm);
+clock_source tsc_clock::source() {
+	return current_clock_source.load(std::memory_order_relaxed);
+}
 
-			return time_point(duration((int64_t)tm.tv_sec * (int64_t)1E9 + tm.tv_nsec, time_unit::NSEC), clock_type::TSC);
-		}
-	case CS_CLOCK_REALTIME:
-		{
-			timespec tm;
+bool tsc_clock::set_source(const clock_source& source) {
+	if (!clock_source_supported(source)) {
+		return false;
+	}
 
-			clock_gettime(CLOCK_REALTIME, &tm);
+	std::lock_guard<std::mutex> lock(calibration_mutex);
 
-			return time_point(duration((int64_t)tm.tv_sec * (int64_t)1E9 + tm.tv_nsec, time_unit::NSEC), clock_type::TSC);
-		}
-	default:
-		{
-			return time_point(duration(0, time_unit::NSEC), clock_type::TSC);
-		}
+	// all TSC sources share the same rate, so calibration is dropped only on switch between TSC and POSIX sources
+	if (tsc_clock_source(source) != tsc_clock_source(current_clock_source.load(std::memory_order_relaxed))) {
+		calibrated_flag.store(false, std::memory_order_release);
+		current_calibration_source = calibration_source::NONE;
 	}
+
+	select_clock_source(source);
+
+	return true;
 }
 
 }} // namespace handystats::chrono
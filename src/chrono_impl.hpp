@@ -0,0 +1,95 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_CHRONO_IMPL_HPP_
+#define HANDYSTATS_CHRONO_IMPL_HPP_
+
+#include <cstdint>
+
+#include <handystats/atomic.hpp>
+
+namespace handystats { namespace chrono {
+
+// Sources of the TSC rate
+enum class calibration_source {
+	NONE, // not calibrated yet
+	CPUID, // CPUID leaves 0x15 and 0x16
+	HYPERVISOR, // hypervisor's CPUID leaf 0x40000010
+	SYSFS, // /sys/devices/system/cpu/cpu0/tsc_freq_khz
+	MEASUREMENT, // measured against CLOCK_MONOTONIC
+	POSIX // POSIX clock source is used, no rate is needed
+};
+
+// TSC rate, valid after calibrate() call
+extern std::atomic<double> cycles_per_nanosec;
+
+// Same TSC rate in fixed-point form with FIXED_POINT_SHIFT fractional bits
+// Used for integer tick <-> nanosecond conversions, valid after calibrate() call
+// NOTE: absolute timestamps (~1E18 ns) are converted too, so precision should be close to double's one,
+// 56 fractional bits leave room for rates up to 128 cycles per nanosecond
+const int FIXED_POINT_SHIFT = 56;
+extern std::atomic<uint64_t> cycles_per_nanosec_fixed;
+extern std::atomic<uint64_t> nanosec_per_cycle_fixed;
+
+// Publishes TSC rate in both floating-point and fixed-point forms
+void set_cycles_per_nanosec(const double& rate);
+
+__extension__ typedef __int128 int128_t;
+
+// Truncates toward zero as the integer division does
+inline int64_t fixed_point_multiply(const int128_t& value, const uint64_t& multiplier) {
+	const int128_t product = value * multiplier;
+	return int64_t(product >= 0 ? product >> FIXED_POINT_SHIFT : -((-product) >> FIXED_POINT_SHIFT));
+}
+
+inline int64_t cycles_to_nanosec(const int64_t& cycles) {
+	return fixed_point_multiply(cycles, nanosec_per_cycle_fixed.load(std::memory_order_relaxed));
+}
+
+inline int64_t nanosec_to_cycles(const int128_t& nanoseconds) {
+	return fixed_point_multiply(nanoseconds, cycles_per_nanosec_fixed.load(std::memory_order_relaxed));
+}
+
+extern std::atomic<bool> calibrated_flag;
+
+void calibrate_slow();
+
+// TSC rate is determined lazily on the first call (first conversion or library initialization)
+inline void calibrate() {
+	if (!calibrated_flag.load(std::memory_order_acquire)) {
+		calibrate_slow();
+	}
+}
+
+calibration_source calibrated_by();
+
+// Refines TSC rate by measurement against CLOCK_MONOTONIC over the whole time since calibration
+// Refinement is performed at most once per second, otherwise the call is cheap
+void refine_calibration();
+
+// Updates tied pair and slope of internal to system time mapping
+// Update is performed at most once per second (by handystats core's thread), otherwise the call is cheap
+// Returns true if mapping has been updated
+bool update_system_time_mapping();
+
+// Difference between measured system time and the one predicted by previous mapping
+// on the last mapping update, in nanoseconds
+int64_t system_time_drift();
+
+}} // namespace handystats::chrono
+
+#endif // HANDYSTATS_CHRONO_IMPL_HPP_
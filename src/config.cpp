@@ -150,9 +150,13 @@ namespace metrics {
 	gauge gauge_opts;
 	counter counter_opts;
 	timer timer_opts;
+	unique unique_opts;
+	topk topk_opts;
+	span span_opts;
 }
 
-metrics_dump metrics_dump_opts;
+// holds std::string, so it has to be constructed before init_opts() assigns it
+metrics_dump metrics_dump_opts __attribute__((init_priority(200)));
 core core_opts;
 
 std::vector<
@@ -169,6 +173,9 @@ static void reset() {
 	metrics::gauge_opts = metrics::gauge();
 	metrics::counter_opts = metrics::counter();
 	metrics::timer_opts = metrics::timer();
+	metrics::unique_opts = metrics::unique();
+	metrics::topk_opts = metrics::topk();
+	metrics::span_opts = metrics::span();
 
 	metrics_dump_opts = metrics_dump();
 	core_opts = core();
@@ -231,15 +238,26 @@ bool config_json(const char* config_data) {
 	 *     },
 	 *     "timer": {
 	 *       ...
+	 *     },
+	 *     "unique": {
+	 *       ...
+	 *     },
+	 *     "topk": {
+	 *       ...
+	 *     },
+	 *     "span": {
+	 *       ...
 	 *     }
 	 *   },
 	 *
 	 *   "metrics-dump": {
-	 *     "interval": ...
+	 *     "interval": ...,
+	 *     "shared-memory": ...
 	 *   },
 	 *
 	 *   "core": {
-	 *     "enable": ...
+	 *     "enable": ...,
+	 *     "tsc-refinement": ...
 	 *   }
 	 * }
 	 */
@@ -254,6 +272,8 @@ bool config_json(const char* config_data) {
 		configure(config::metrics::counter_opts.values, statistics_config);
 
 		configure(config::metrics::timer_opts.values, statistics_config);
+
+		configure(config::metrics::unique_opts, statistics_config);
 	}
 
 	if (cfg.HasMember("metrics")) {
@@ -268,6 +288,15 @@ bool config_json(const char* config_data) {
 		if (metrics_config.HasMember("timer")) {
 			configure(config::metrics::timer_opts, metrics_config["timer"]);
 		}
+		if (metrics_config.HasMember("unique")) {
+			configure(config::metrics::unique_opts, metrics_config["unique"]);
+		}
+		if (metrics_config.HasMember("topk")) {
+			configure(config::metrics::topk_opts, metrics_config["topk"]);
+		}
+		if (metrics_config.HasMember("span")) {
+			configure(config::metrics::span_opts, metrics_config["span"]);
+		}
 	}
 
 	if (cfg.HasMember("metrics-dump")) {
@@ -298,10 +327,23 @@ bool config_json(const char* config_data) {
 	 *   "timer": {
 	 *     ...
 	 *   },
+	 *   "unique": {
+	 *     ...
+	 *   },
+	 *   "topk": {
+	 *     ...
+	 *   },
+	 *   "span": {
+	 *     ...
+	 *   },
 	 *
 	 *   "dump-interval": ...,
 	 *
-	 *   "enable": ...
+	 *   "dump-shared-memory": ...,
+	 *
+	 *   "enable": ...,
+	 *
+	 *   "tsc-refinement": ...
 	 * }
 	 */
 
@@ -315,6 +357,8 @@ bool config_json(const char* config_data) {
 		configure(config::metrics::counter_opts.values, statistics_config);
 
 		configure(config::metrics::timer_opts.values, statistics_config);
+
+		configure(config::metrics::unique_opts, statistics_config);
 	}
 
 	if (cfg.HasMember("gauge")) {
@@ -332,6 +376,21 @@ bool config_json(const char* config_data) {
 		configure(config::metrics::timer_opts, timer_config);
 	}
 
+	if (cfg.HasMember("unique")) {
+		const rapidjson::Value& unique_config = cfg["unique"];
+		configure(config::metrics::unique_opts, unique_config);
+	}
+
+	if (cfg.HasMember("topk")) {
+		const rapidjson::Value& topk_config = cfg["topk"];
+		configure(config::metrics::topk_opts, topk_config);
+	}
+
+	if (cfg.HasMember("span")) {
+		const rapidjson::Value& span_config = cfg["span"];
+		configure(config::metrics::span_opts, span_config);
+	}
+
 	if (cfg.HasMember("dump-interval")) {
 		const rapidjson::Value& dump_interval = cfg["dump-interval"];
 
@@ -340,6 +399,14 @@ bool config_json(const char* config_data) {
 		}
 	}
 
+	if (cfg.HasMember("dump-shared-memory")) {
+		const rapidjson::Value& dump_shared_memory = cfg["dump-shared-memory"];
+
+		if (dump_shared_memory.IsString()) {
+			config::metrics_dump_opts.shared_memory = dump_shared_memory.GetString();
+		}
+	}
+
 
 	if (cfg.HasMember("enable")) {
 		const rapidjson::Value& core_enable = cfg["enable"];
@@ -349,6 +416,14 @@ bool config_json(const char* config_data) {
 		}
 	}
 
+	if (cfg.HasMember("tsc-refinement")) {
+		const rapidjson::Value& tsc_refinement = cfg["tsc-refinement"];
+
+		if (tsc_refinement.IsBool()) {
+			config::core_opts.tsc_refinement = tsc_refinement.GetBool();
+		}
+	}
+
 	/*
 	 * pattern configuration format
 	 *
@@ -375,8 +450,13 @@ bool config_json(const char* config_data) {
 				|| strcmp(member_name.GetString(), "gauge") == 0
 				|| strcmp(member_name.GetString(), "counter") == 0
 				|| strcmp(member_name.GetString(), "timer") == 0
+				|| strcmp(member_name.GetString(), "unique") == 0
+				|| strcmp(member_name.GetString(), "topk") == 0
+				|| strcmp(member_name.GetString(), "span") == 0
 				|| strcmp(member_name.GetString(), "dump-interval") == 0
+				|| strcmp(member_name.GetString(), "dump-shared-memory") == 0
 				|| strcmp(member_name.GetString(), "enable") == 0
+				|| strcmp(member_name.GetString(), "tsc-refinement") == 0
 		   )
 		{
 			continue;
@@ -21,6 +21,7 @@ namespace handystats { namespace config {
 
 core::core()
 	: enable(true)
+	, tsc_refinement(true)
 {}
 
 void core::configure(const rapidjson::Value& config) {
@@ -34,6 +35,13 @@ void core::configure(const rapidjson::Value& config) {
 			this->enable = enable.GetBool();
 		}
 	}
+
+	if (config.HasMember("tsc-refinement")) {
+		const rapidjson::Value& tsc_refinement = config["tsc-refinement"];
+		if (tsc_refinement.IsBool()) {
+			this->tsc_refinement = tsc_refinement.GetBool();
+		}
+	}
 }
 
 }} // namespace handystats::config
@@ -24,6 +24,8 @@ namespace handystats { namespace config {
 
 struct core {
 	bool enable;
+	// refine TSC rate periodically in the processing thread
+	bool tsc_refinement;
 
 	core();
 	void configure(const rapidjson::Value& config);
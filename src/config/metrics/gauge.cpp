@@ -23,6 +23,7 @@ namespace handystats { namespace config { namespace metrics {
 
 gauge::gauge()
 	: values(statistics())
+	, receive_time(false)
 {
 }
 
@@ -31,6 +32,13 @@ void configure(gauge& obj, const rapidjson::Value& config) {
 		return;
 	}
 
+	if (config.HasMember("receive-time")) {
+		const rapidjson::Value& receive_time = config["receive-time"];
+		if (receive_time.IsBool()) {
+			obj.receive_time = receive_time.GetBool();
+		}
+	}
+
 	configure(obj.values, config);
 }
 
@@ -0,0 +1,50 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <handystats/config/metrics/span.hpp>
+
+#include "config_impl.hpp"
+
+namespace handystats { namespace config { namespace metrics {
+
+span::span()
+	: max_depth(8)
+	, max_nodes(1000)
+{
+}
+
+void configure(span& obj, const rapidjson::Value& config) {
+	if (!config.IsObject()) {
+		return;
+	}
+
+	if (config.HasMember("max-depth")) {
+		const rapidjson::Value& max_depth = config["max-depth"];
+		if (max_depth.IsUint64() && max_depth.GetUint64() > 0) {
+			obj.max_depth = max_depth.GetUint64();
+		}
+	}
+
+	if (config.HasMember("max-nodes")) {
+		const rapidjson::Value& max_nodes = config["max-nodes"];
+		if (max_nodes.IsUint64()) {
+			obj.max_nodes = max_nodes.GetUint64();
+		}
+	}
+}
+
+}}} // namespace handystats::config::metrics
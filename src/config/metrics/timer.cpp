@@ -26,6 +26,8 @@ namespace handystats { namespace config { namespace metrics {
 timer::timer()
 	: idle_timeout(10, chrono::time_unit::SEC)
 	, values(statistics())
+	, local_instances(false)
+	, exemplars(0)
 {
 }
 
@@ -41,6 +43,20 @@ void configure(timer& obj, const rapidjson::Value& config) {
 		}
 	}
 
+	if (config.HasMember("local-instances")) {
+		const rapidjson::Value& local_instances = config["local-instances"];
+		if (local_instances.IsBool()) {
+			obj.local_instances = local_instances.GetBool();
+		}
+	}
+
+	if (config.HasMember("exemplars")) {
+		const rapidjson::Value& exemplars = config["exemplars"];
+		if (exemplars.IsUint64()) {
+			obj.exemplars = exemplars.GetUint64();
+		}
+	}
+
 	configure(obj.values, config);
 }
 
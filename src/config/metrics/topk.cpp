@@ -0,0 +1,55 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <algorithm>
+
+#include <handystats/config/metrics/topk.hpp>
+
+#include "config_impl.hpp"
+
+namespace handystats { namespace config { namespace metrics {
+
+topk::topk()
+	: capacity(100)
+	, size(10)
+{
+}
+
+void configure(topk& obj, const rapidjson::Value& config) {
+	if (!config.IsObject()) {
+		return;
+	}
+
+	if (config.HasMember("capacity")) {
+		const rapidjson::Value& capacity = config["capacity"];
+		if (capacity.IsUint64() && capacity.GetUint64() > 0) {
+			obj.capacity = capacity.GetUint64();
+		}
+	}
+
+	if (config.HasMember("size")) {
+		const rapidjson::Value& size = config["size"];
+		if (size.IsUint64() && size.GetUint64() > 0) {
+			obj.size = size.GetUint64();
+		}
+	}
+
+	// there is no point in reporting more keys than tracked
+	obj.capacity = std::max(obj.capacity, obj.size);
+}
+
+}}} // namespace handystats::config::metrics
@@ -0,0 +1,55 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <handystats/metrics/unique.hpp>
+#include <handystats/config/metrics/unique.hpp>
+
+#include "config_impl.hpp"
+
+namespace handystats { namespace config { namespace metrics {
+
+unique::unique()
+	: precision(10)
+	, moving_interval(1, chrono::time_unit::SEC)
+{
+}
+
+void configure(unique& obj, const rapidjson::Value& config) {
+	if (!config.IsObject()) {
+		return;
+	}
+
+	if (config.HasMember("precision")) {
+		const rapidjson::Value& precision = config["precision"];
+		if (precision.IsUint64() &&
+				precision.GetUint64() >= handystats::metrics::unique::MIN_PRECISION &&
+				precision.GetUint64() <= handystats::metrics::unique::MAX_PRECISION
+			)
+		{
+			obj.precision = precision.GetUint64();
+		}
+	}
+
+	if (config.HasMember("moving-interval")) {
+		const rapidjson::Value& moving_interval = config["moving-interval"];
+		if (moving_interval.IsUint64() && moving_interval.GetUint64() > 0) {
+			obj.moving_interval = chrono::duration(moving_interval.GetUint64(), chrono::time_unit::MSEC);
+		}
+	}
+}
+
+}}} // namespace handystats::config::metrics
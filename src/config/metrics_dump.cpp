@@ -34,6 +34,13 @@ void metrics_dump::configure(const rapidjson::Value& config) {
 			this->interval = chrono::duration(interval.GetUint64(), chrono::time_unit::MSEC);
 		}
 	}
+
+	if (config.HasMember("shared-memory")) {
+		const rapidjson::Value& shared_memory = config["shared-memory"];
+		if (shared_memory.IsString()) {
+			this->shared_memory = shared_memory.GetString();
+		}
+	}
 }
 
 }} // namespace handystats::config
@@ -18,6 +18,8 @@
 #ifndef HANDYSTATS_CONFIG_METRICS_DUMP_IMPL_HPP_
 #define HANDYSTATS_CONFIG_METRICS_DUMP_IMPL_HPP_
 
+#include <string>
+
 #include <handystats/chrono.hpp>
 #include <rapidjson/document.h>
 
@@ -25,6 +27,8 @@ namespace handystats { namespace config {
 
 struct metrics_dump {
 	chrono::duration interval;
+	// path of shared memory segment dumps are published to, empty if disabled
+	std::string shared_memory;
 
 	metrics_dump();
 	void configure(const rapidjson::Value& config);
@@ -27,6 +27,9 @@
 #include <handystats/config/metrics/gauge.hpp>
 #include <handystats/config/metrics/counter.hpp>
 #include <handystats/config/metrics/timer.hpp>
+#include <handystats/config/metrics/unique.hpp>
+#include <handystats/config/metrics/topk.hpp>
+#include <handystats/config/metrics/span.hpp>
 
 #include "config/metrics_dump_impl.hpp"
 #include "config/core_impl.hpp"
@@ -39,6 +42,9 @@ namespace metrics {
 	extern gauge gauge_opts;
 	extern counter counter_opts;
 	extern timer timer_opts;
+	extern unique unique_opts;
+	extern topk topk_opts;
+	extern span span_opts;
 }
 
 extern metrics_dump metrics_dump_opts;
@@ -67,6 +73,9 @@ namespace metrics {
 	void configure(gauge&, const rapidjson::Value& config);
 	void configure(counter&, const rapidjson::Value& config);
 	void configure(timer&, const rapidjson::Value& config);
+	void configure(unique&, const rapidjson::Value& config);
+	void configure(topk&, const rapidjson::Value& config);
+	void configure(span&, const rapidjson::Value& config);
 } // namespace metrics
 
 }} // namespace handystats::config
@@ -30,6 +30,11 @@
 #include "internal_impl.hpp"
 #include "metrics_dump_impl.hpp"
 #include "config_impl.hpp"
+#include "timer_instances_impl.hpp"
+#include "timer_handles_impl.hpp"
+#include "span_nodes_impl.hpp"
+#include "receive_time_impl.hpp"
+#include "chrono_impl.hpp"
 
 #include "core_impl.hpp"
 
@@ -46,17 +51,21 @@ bool is_enabled() {
 chrono::time_point last_message_timestamp;
 std::thread processor_thread;
 
-static void process_message_queue() {
-	auto* message = message_queue::pop();
+// number of messages processed between other processor's duties
+static const size_t MESSAGES_BATCH_SIZE = 64;
 
-	chrono::time_point timestamp;
+static void process_message_queue() {
+	for (size_t count = 0; count < MESSAGES_BATCH_SIZE; ++count) {
+		auto* message = message_queue::pop();
+		if (!message) {
+			return;
+		}
 
-	if (message) {
 		last_message_timestamp = std::max(last_message_timestamp, message->timestamp);
 		internal::process_event_message(*message);
-	}
 
-	events::delete_event_message(message);
+		events::delete_event_message(message);
+	}
 }
 
 static void run_processor() noexcept {
@@ -68,15 +77,29 @@ static void run_processor() noexcept {
 	prctl(PR_SET_NAME, thread_name);
 
 	while (is_enabled()) {
+		timer_handles::process();
+
 		if (!message_queue::empty()) {
 			process_message_queue();
 		}
 		else {
+			if (config::core_opts.tsc_refinement) {
+				chrono::refine_calibration();
+			}
 			last_message_timestamp = std::max(last_message_timestamp, chrono::tsc_clock::now());
 			std::this_thread::sleep_for(std::chrono::microseconds(1000));
 		}
 
+		// system time mapping is maintained here, so that conversions on other threads never stall
+		if (chrono::update_system_time_mapping()) {
+			metrics_dump::stats::system_time_drift.set(chrono::system_time_drift(), chrono::tsc_clock::now());
+		}
+
 		metrics_dump::update(chrono::tsc_clock::now(), last_message_timestamp);
+
+		if (timer_instances::enabled()) {
+			timer_instances::sweep(chrono::tsc_clock::now());
+		}
 	}
 }
 
@@ -86,9 +109,16 @@ void initialize() {
 		return;
 	}
 
+	// TSC rate is determined here instead of process startup or the first measurement
+	chrono::calibrate();
+
 	metrics_dump::initialize();
 	internal::initialize();
 	message_queue::initialize();
+	timer_instances::initialize();
+	timer_handles::initialize();
+	span_nodes::initialize();
+	receive_time::initialize();
 
 	if (!config::core_opts.enable) {
 		return;
@@ -98,6 +128,7 @@ void initialize() {
 
 	last_message_timestamp = chrono::time_point();
 
+	metrics_dump::start();
 	processor_thread = std::thread(run_processor);
 }
 
@@ -108,9 +139,14 @@ void finalize() {
 	if (processor_thread.joinable()) {
 		processor_thread.join();
 	}
+	metrics_dump::stop();
 
 	internal::finalize();
 	message_queue::finalize();
+	timer_instances::finalize();
+	timer_handles::finalize();
+	span_nodes::finalize();
+	receive_time::finalize();
 	metrics_dump::finalize();
 	config::finalize();
 }
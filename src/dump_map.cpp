@@ -0,0 +1,313 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <handystats/metrics_dump.hpp>
+
+namespace handystats { namespace metrics_dump {
+
+const size_t dump_map::MAX_BLOCK_SIZE;
+const size_t dump_map::MAX_REMOVALS;
+
+static
+const std::string& entry_name(const dump_map::entry_ptr& entry) {
+	return entry->value.first;
+}
+
+static
+bool entry_less(const dump_map::entry_ptr& entry, const std::string& name) {
+	return entry_name(entry) < name;
+}
+
+
+dump_map::const_iterator& dump_map::const_iterator::operator++() {
+	++m_index;
+	if (m_index >= m_map->m_blocks[m_block]->size()) {
+		++m_block;
+		m_index = 0;
+	}
+	return *this;
+}
+
+dump_map::const_iterator& dump_map::const_iterator::operator--() {
+	if (m_index == 0) {
+		--m_block;
+		m_index = m_map->m_blocks[m_block]->size() - 1;
+	}
+	else {
+		--m_index;
+	}
+	return *this;
+}
+
+
+dump_map::dump_map()
+	: m_blocks()
+	, m_block_versions()
+	, m_size(0)
+	, m_version(0)
+	, m_removals()
+	, m_removals_horizon(0)
+{
+}
+
+uint64_t dump_map::version() const {
+	return m_version;
+}
+
+dump_map::const_iterator dump_map::begin() const {
+	return const_iterator(this, 0, 0);
+}
+
+dump_map::const_iterator dump_map::end() const {
+	return const_iterator(this, m_blocks.size(), 0);
+}
+
+dump_map::const_iterator dump_map::cbegin() const {
+	return begin();
+}
+
+dump_map::const_iterator dump_map::cend() const {
+	return end();
+}
+
+dump_map::const_iterator dump_map::find(const std::string& name) const {
+	const auto& iter = lower_bound(name);
+	if (iter == end() || iter->first != name) {
+		return end();
+	}
+	return iter;
+}
+
+dump_map::const_iterator dump_map::lower_bound(const std::string& name) const {
+	// the last block with the first name not greater than the given one
+	auto block_iter =
+		std::upper_bound(m_blocks.begin(), m_blocks.end(), name,
+				[] (const std::string& name, const std::shared_ptr<const block_type>& block) {
+					return name < entry_name(block->front());
+				}
+			);
+	if (block_iter == m_blocks.begin()) {
+		return begin();
+	}
+	--block_iter;
+
+	const block_type& entries = **block_iter;
+	auto entry_iter = std::lower_bound(entries.begin(), entries.end(), name, entry_less);
+	if (entry_iter == entries.end()) {
+		// the first entry of the next block
+		return const_iterator(this, block_iter - m_blocks.begin() + 1, 0);
+	}
+
+	return const_iterator(this, block_iter - m_blocks.begin(), entry_iter - entries.begin());
+}
+
+dump_map::const_iterator dump_map::upper_bound(const std::string& name) const {
+	auto iter = lower_bound(name);
+	if (iter != end() && iter->first == name) {
+		++iter;
+	}
+	return iter;
+}
+
+dump_map::size_type dump_map::count(const std::string& name) const {
+	return find(name) == end() ? 0 : 1;
+}
+
+const dump_map::mapped_type& dump_map::at(const std::string& name) const {
+	const auto& iter = find(name);
+	if (iter == end()) {
+		throw std::out_of_range("dump_map::at");
+	}
+	return iter->second;
+}
+
+dump_map::size_type dump_map::size() const {
+	return m_size;
+}
+
+bool dump_map::empty() const {
+	return m_size == 0;
+}
+
+dump_map dump_map::update(
+		const std::vector<entry_ptr>& changed,
+		const std::vector<std::string>& removed,
+		const uint64_t& version
+	) const
+{
+	dump_map result;
+	result.m_version = version;
+	result.m_blocks.reserve(m_blocks.size() + changed.size() / MAX_BLOCK_SIZE + 1);
+	result.m_block_versions.reserve(result.m_blocks.capacity());
+
+	result.m_removals = m_removals;
+	result.m_removals_horizon = m_removals_horizon;
+	if (!removed.empty()) {
+		std::shared_ptr<removals_type> removals(new removals_type());
+		if (m_removals) {
+			removals->reserve(m_removals->size() + removed.size());
+			removals->assign(m_removals->begin(), m_removals->end());
+		}
+		for (auto name = removed.begin(); name != removed.end(); ++name) {
+			if (find(*name) != end()) {
+				removals->push_back(std::make_pair(version, *name));
+			}
+		}
+
+		if (removals->size() > MAX_REMOVALS) {
+			const size_t forgotten = removals->size() - MAX_REMOVALS;
+			result.m_removals_horizon = std::max(result.m_removals_horizon, (*removals)[forgotten - 1].first);
+			removals->erase(removals->begin(), removals->begin() + forgotten);
+		}
+
+		result.m_removals = removals;
+	}
+
+	// merged block is split into halves of MAX_BLOCK_SIZE, so subsequent insertions don't split it at once
+	auto append = [&result] (const block_type& entries) {
+		for (size_t start = 0; start < entries.size(); ) {
+			const size_t length =
+				entries.size() - start <= MAX_BLOCK_SIZE ? entries.size() - start : MAX_BLOCK_SIZE / 2;
+
+			uint64_t block_version = 0;
+			for (size_t index = start; index < start + length; ++index) {
+				block_version = std::max(block_version, entries[index]->version);
+			}
+
+			result.m_blocks.push_back(
+					std::make_shared<const block_type>(entries.begin() + start, entries.begin() + start + length)
+				);
+			result.m_block_versions.push_back(block_version);
+			result.m_size += length;
+			start += length;
+		}
+	};
+
+	auto changed_iter = changed.begin();
+	auto removed_iter = removed.begin();
+
+	if (m_blocks.empty()) {
+		append(block_type(changed.begin(), changed.end()));
+		return result;
+	}
+
+	for (size_t block = 0; block < m_blocks.size(); ++block) {
+		const block_type& entries = *m_blocks[block];
+
+		// block takes names up to the first name of the next block (the first block also takes names before it)
+		auto changed_end = changed.end();
+		auto removed_end = removed.end();
+		if (block + 1 < m_blocks.size()) {
+			const std::string& upper_name = entry_name(m_blocks[block + 1]->front());
+			changed_end = std::lower_bound(changed_iter, changed.end(), upper_name, entry_less);
+			removed_end = std::lower_bound(removed_iter, removed.end(), upper_name);
+		}
+
+		if (changed_iter == changed_end && removed_iter == removed_end) {
+			// unchanged block is shared
+			result.m_blocks.push_back(m_blocks[block]);
+			result.m_block_versions.push_back(m_block_versions[block]);
+			result.m_size += entries.size();
+			continue;
+		}
+
+		block_type merged;
+		merged.reserve(entries.size() + (changed_end - changed_iter));
+
+		auto entry_iter = entries.begin();
+		while (entry_iter != entries.end() || changed_iter != changed_end) {
+			if (changed_iter == changed_end ||
+					(entry_iter != entries.end() && entry_name(*entry_iter) < entry_name(*changed_iter))
+				)
+			{
+				while (removed_iter != removed_end && *removed_iter < entry_name(*entry_iter)) {
+					++removed_iter;
+				}
+				if (removed_iter == removed_end || *removed_iter != entry_name(*entry_iter)) {
+					merged.push_back(*entry_iter);
+				}
+				++entry_iter;
+			}
+			else {
+				if (entry_iter != entries.end() && entry_name(*entry_iter) == entry_name(*changed_iter)) {
+					++entry_iter;
+				}
+				merged.push_back(*changed_iter);
+				++changed_iter;
+			}
+		}
+
+		append(merged);
+		removed_iter = removed_end;
+	}
+
+	return result;
+}
+
+dump_delta dump_map::delta(const uint64_t& since) const {
+	dump_delta result;
+	result.since = since;
+	result.version = m_version;
+
+	if (since > m_version || since < m_removals_horizon) {
+		result.full = true;
+		result.changed.reserve(m_size);
+		for (size_t block = 0; block < m_blocks.size(); ++block) {
+			result.changed.insert(result.changed.end(), m_blocks[block]->begin(), m_blocks[block]->end());
+		}
+		return result;
+	}
+
+	for (size_t block = 0; block < m_blocks.size(); ++block) {
+		if (m_block_versions[block] <= since) {
+			continue;
+		}
+
+		const block_type& entries = *m_blocks[block];
+		for (auto entry_iter = entries.begin(); entry_iter != entries.end(); ++entry_iter) {
+			if ((*entry_iter)->version > since) {
+				result.changed.push_back(*entry_iter);
+			}
+		}
+	}
+
+	if (m_removals) {
+		auto removal_iter =
+			std::upper_bound(m_removals->begin(), m_removals->end(), since,
+					[] (const uint64_t& version, const std::pair<uint64_t, std::string>& removal) {
+						return version < removal.first;
+					}
+				);
+
+		for (; removal_iter != m_removals->end(); ++removal_iter) {
+			// metric could have been added back
+			if (find(removal_iter->second) == end()) {
+				result.removed.push_back(removal_iter->second);
+			}
+		}
+
+		std::sort(result.removed.begin(), result.removed.end());
+		result.removed.erase(std::unique(result.removed.begin(), result.removed.end()), result.removed.end());
+	}
+
+	return result;
+}
+
+}} // namespace handystats::metrics_dump
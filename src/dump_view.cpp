@@ -0,0 +1,125 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <fnmatch.h>
+
+#include <handystats/metrics_dump.hpp>
+
+namespace handystats { namespace metrics_dump {
+
+// the least string greater than all strings starting with the prefix, empty if there's no such string
+static
+std::string prefix_successor(std::string prefix) {
+	while (!prefix.empty() && static_cast<unsigned char>(prefix.back()) == 0xFF) {
+		prefix.pop_back();
+	}
+	if (!prefix.empty()) {
+		prefix.back() = static_cast<char>(static_cast<unsigned char>(prefix.back()) + 1);
+	}
+	return prefix;
+}
+
+// part of the pattern before the first special character
+static
+std::string literal_prefix(const std::string& pattern) {
+	return pattern.substr(0, pattern.find_first_of("*?[\\"));
+}
+
+
+void dump_view::const_iterator::skip() {
+	if (!m_view->m_glob) {
+		return;
+	}
+	while (m_iter != m_view->m_last && !m_view->matches(m_iter->first)) {
+		++m_iter;
+	}
+}
+
+
+dump_view::dump_view(const std::shared_ptr<const dump_map>& dump)
+	: m_dump(dump)
+	, m_first(dump->begin())
+	, m_last(dump->end())
+	, m_glob(false)
+	, m_pattern()
+{
+}
+
+dump_view dump_view::prefix(const std::shared_ptr<const dump_map>& dump, const std::string& prefix) {
+	dump_view view(dump);
+	view.m_pattern = prefix;
+
+	view.m_first = dump->lower_bound(prefix);
+	const std::string& successor = prefix_successor(prefix);
+	if (!successor.empty()) {
+		view.m_last = dump->lower_bound(successor);
+	}
+
+	return view;
+}
+
+dump_view dump_view::glob(const std::shared_ptr<const dump_map>& dump, const std::string& pattern) {
+	dump_view view = prefix(dump, literal_prefix(pattern));
+	view.m_glob = true;
+	view.m_pattern = pattern;
+	return view;
+}
+
+uint64_t dump_view::version() const {
+	return m_dump->version();
+}
+
+dump_view::const_iterator dump_view::begin() const {
+	return const_iterator(this, m_first);
+}
+
+dump_view::const_iterator dump_view::end() const {
+	return const_iterator(this, m_last);
+}
+
+dump_view::const_iterator dump_view::cbegin() const {
+	return begin();
+}
+
+dump_view::const_iterator dump_view::cend() const {
+	return end();
+}
+
+dump_view::size_type dump_view::size() const {
+	size_type size = 0;
+	for (auto iter = begin(); iter != end(); ++iter) {
+		++size;
+	}
+	return size;
+}
+
+bool dump_view::empty() const {
+	return begin() == end();
+}
+
+bool dump_view::matches(const std::string& name) const {
+	if (m_glob) {
+		return fnmatch(m_pattern.c_str(), name.c_str(), 0) == 0;
+	}
+	return name.compare(0, m_pattern.size(), m_pattern) == 0;
+}
+
+const std::shared_ptr<const dump_map>& dump_view::dump() const {
+	return m_dump;
+}
+
+}} // namespace handystats::metrics_dump
@@ -19,6 +19,9 @@
 #include "events/counter_impl.hpp"
 #include "events/timer_impl.hpp"
 #include "events/attribute_impl.hpp"
+#include "events/unique_impl.hpp"
+#include "events/topk_impl.hpp"
+#include "events/span_impl.hpp"
 
 #include "events/event_message_impl.hpp"
 
@@ -43,6 +46,15 @@ void delete_event_message(event_message* message) {
 		case event_destination_type::ATTRIBUTE:
 			attribute::delete_event(message);
 			break;
+		case event_destination_type::UNIQUE:
+			unique::delete_event(message);
+			break;
+		case event_destination_type::TOPK:
+			topk::delete_event(message);
+			break;
+		case event_destination_type::SPAN:
+			span::delete_event(message);
+			break;
 		default:
 			return;
 	}
@@ -32,7 +32,10 @@ enum : char {
 	COUNTER = 0,
 	GAUGE,
 	TIMER,
-	ATTRIBUTE
+	ATTRIBUTE,
+	UNIQUE,
+	TOPK,
+	SPAN
 };
 }
 
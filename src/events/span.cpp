@@ -0,0 +1,88 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <cstdint>
+
+#include "events/span_impl.hpp"
+
+
+namespace handystats { namespace events { namespace span {
+
+struct set_event_data {
+	int64_t inclusive_rep;
+	int64_t self_rep;
+};
+
+event_message* create_set_event(
+		std::string&& span_name,
+		const metrics::span::value_type& inclusive_measurement,
+		const metrics::span::value_type& self_measurement,
+		const metrics::span::time_point& timestamp
+	)
+{
+	event_message* message = new event_message;
+
+	message->destination_name.swap(span_name);
+	message->destination_type = event_destination_type::SPAN;
+
+	message->timestamp = timestamp;
+
+	message->event_type = event_type::SET;
+	message->event_data = new set_event_data{
+			chrono::duration::convert_to(metrics::span::value_unit, inclusive_measurement).count(),
+			chrono::duration::convert_to(metrics::span::value_unit, self_measurement).count()
+		};
+
+	return message;
+}
+
+void delete_set_event(event_message* message) {
+	delete static_cast<set_event_data*>(message->event_data);
+	delete message;
+}
+
+
+void delete_event(event_message* message) {
+	switch (message->event_type) {
+		case event_type::SET:
+			delete_set_event(message);
+			break;
+	}
+}
+
+
+void process_set_event(metrics::span& span, const event_message& message) {
+	const auto* data = static_cast<const set_event_data*>(message.event_data);
+	span.set(
+			chrono::duration(data->inclusive_rep, metrics::span::value_unit),
+			chrono::duration(data->self_rep, metrics::span::value_unit),
+			message.timestamp
+		);
+}
+
+
+void process_event(metrics::span& span, const event_message& message) {
+	switch (message.event_type) {
+		case event_type::SET:
+			process_set_event(span, message);
+			break;
+		default:
+			return;
+	}
+}
+
+}}} // namespace handystats::events::span
@@ -175,6 +175,40 @@ void delete_set_event(event_message* message) {
 }
 
 
+struct set_instance_event_data {
+	metrics::timer::instance_id_type instance_id;
+	int64_t duration_rep;
+};
+
+event_message* create_set_event(
+		std::string&& timer_name,
+		const metrics::timer::instance_id_type& instance_id,
+		const metrics::timer::value_type& measurement,
+		const metrics::timer::time_point& timestamp
+	)
+{
+	event_message* message = new event_message;
+
+	message->destination_name.swap(timer_name);
+	message->destination_type = event_destination_type::TIMER;
+
+	message->timestamp = timestamp;
+
+	message->event_type = event_type::SET_INSTANCE;
+	message->event_data = new set_instance_event_data{
+			instance_id,
+			chrono::duration::convert_to(metrics::timer::value_unit, measurement).count()
+		};
+
+	return message;
+}
+
+void delete_set_instance_event(event_message* message) {
+	delete static_cast<set_instance_event_data*>(message->event_data);
+	delete message;
+}
+
+
 void delete_event(event_message* message) {
 	switch (message->event_type) {
 		case event_type::INIT:
@@ -195,6 +229,9 @@ void delete_event(event_message* message) {
 		case event_type::SET:
 			delete_set_event(message);
 			break;
+		case event_type::SET_INSTANCE:
+			delete_set_instance_event(message);
+			break;
 	}
 }
 
@@ -231,6 +268,11 @@ void process_set_event(metrics::timer& timer, const event_message& message) {
 	timer.set(chrono::duration(duration_rep, metrics::timer::value_unit), message.timestamp);
 }
 
+void process_set_instance_event(metrics::timer& timer, const event_message& message) {
+	const auto* data = static_cast<const set_instance_event_data*>(message.event_data);
+	timer.set(chrono::duration(data->duration_rep, metrics::timer::value_unit), message.timestamp, data->instance_id);
+}
+
 
 void process_event(metrics::timer& timer, const event_message& message) {
 	switch (message.event_type) {
@@ -252,6 +294,9 @@ void process_event(metrics::timer& timer, const event_message& message) {
 		case event_type::SET:
 			process_set_event(timer, message);
 			break;
+		case event_type::SET_INSTANCE:
+			process_set_instance_event(timer, message);
+			break;
 		default:
 			return;
 	}
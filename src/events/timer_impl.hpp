@@ -34,7 +34,9 @@ enum : char {
 	STOP,
 	DISCARD,
 	HEARTBEAT,
-	SET
+	SET,
+	// measurement of finished instance, e.g. tracked on the measuring side
+	SET_INSTANCE
 };
 } // namespace event_type
 
@@ -77,6 +79,13 @@ event_message* create_set_event(
 		const metrics::timer::time_point& timestamp
 	);
 
+event_message* create_set_event(
+		std::string&& timer_name,
+		const metrics::timer::instance_id_type& instance_id,
+		const metrics::timer::value_type& measurement,
+		const metrics::timer::time_point& timestamp
+	);
+
 /*
  * Event destructor
  */
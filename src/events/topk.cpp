@@ -0,0 +1,79 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include "events/topk_impl.hpp"
+
+
+namespace handystats { namespace events { namespace topk {
+
+struct add_event_data {
+	metrics::topk::key_type key;
+	metrics::topk::value_type weight;
+};
+
+event_message* create_add_event(
+		std::string&& topk_name,
+		const metrics::topk::key_type& key,
+		const metrics::topk::value_type& weight,
+		const metrics::topk::time_point& timestamp
+	)
+{
+	event_message* message = new event_message;
+
+	message->destination_name.swap(topk_name);
+	message->destination_type = event_destination_type::TOPK;
+
+	message->timestamp = timestamp;
+
+	message->event_type = event_type::ADD;
+	message->event_data = new add_event_data{key, weight};
+
+	return message;
+}
+
+void delete_add_event(event_message* message) {
+	delete static_cast<add_event_data*>(message->event_data);
+	delete message;
+}
+
+
+void delete_event(event_message* message) {
+	switch (message->event_type) {
+		case event_type::ADD:
+			delete_add_event(message);
+			break;
+	}
+}
+
+
+void process_add_event(metrics::topk& topk, const event_message& message) {
+	const auto* data = static_cast<const add_event_data*>(message.event_data);
+	topk.add(data->key, data->weight, message.timestamp);
+}
+
+
+void process_event(metrics::topk& topk, const event_message& message) {
+	switch (message.event_type) {
+		case event_type::ADD:
+			process_add_event(topk, message);
+			break;
+		default:
+			return;
+	}
+}
+
+}}} // namespace handystats::events::topk
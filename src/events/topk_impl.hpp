@@ -0,0 +1,61 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_TOPK_EVENT_IMPL_HPP_
+#define HANDYSTATS_TOPK_EVENT_IMPL_HPP_
+
+#include <string>
+
+#include <handystats/metrics/topk.hpp>
+
+#include "events/event_message_impl.hpp"
+
+
+namespace handystats { namespace events { namespace topk {
+
+namespace event_type {
+enum : char {
+	ADD = 0
+};
+} // namespace event_type
+
+/*
+ * Event creation functions
+ */
+event_message* create_add_event(
+		std::string&& topk_name,
+		const metrics::topk::key_type& key,
+		const metrics::topk::value_type& weight,
+		const metrics::topk::time_point& timestamp
+	);
+
+
+/*
+ * Event destructor
+ */
+void delete_event(event_message* message);
+
+
+/*
+ * Event processing function
+ */
+void process_event(metrics::topk& topk, const event_message& message);
+
+}}} // namespace handystats::events::topk
+
+
+#endif // HANDYSTATS_TOPK_EVENT_IMPL_HPP_
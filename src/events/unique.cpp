@@ -0,0 +1,75 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <cstring>
+
+#include "events/unique_impl.hpp"
+
+
+namespace handystats { namespace events { namespace unique {
+
+event_message* create_add_event(
+		std::string&& unique_name,
+		const metrics::unique::value_type& hash,
+		const metrics::unique::time_point& timestamp
+	)
+{
+	event_message* message = new event_message;
+
+	message->destination_name.swap(unique_name);
+	message->destination_type = event_destination_type::UNIQUE;
+
+	message->timestamp = timestamp;
+
+	message->event_type = event_type::ADD;
+	new (&message->event_data) metrics::unique::value_type(hash);
+
+	return message;
+}
+
+void delete_add_event(event_message* message) {
+	delete message;
+}
+
+
+void delete_event(event_message* message) {
+	switch (message->event_type) {
+		case event_type::ADD:
+			delete_add_event(message);
+			break;
+	}
+}
+
+
+void process_add_event(metrics::unique& unique, const event_message& message) {
+	metrics::unique::value_type hash;
+	std::memcpy(&hash, &message.event_data, sizeof(hash));
+	unique.add(hash, message.timestamp);
+}
+
+
+void process_event(metrics::unique& unique, const event_message& message) {
+	switch (message.event_type) {
+		case event_type::ADD:
+			process_add_event(unique, message);
+			break;
+		default:
+			return;
+	}
+}
+
+}}} // namespace handystats::events::unique
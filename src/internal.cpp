@@ -26,6 +26,9 @@
 #include "events/gauge_impl.hpp"
 #include "events/timer_impl.hpp"
 #include "events/attribute_impl.hpp"
+#include "events/unique_impl.hpp"
+#include "events/topk_impl.hpp"
+#include "events/span_impl.hpp"
 #include "config_impl.hpp"
 
 #include "internal_impl.hpp"
@@ -68,37 +71,101 @@ void finalize() {
 } // namespace stats
 
 
-std::map<std::string, metrics::metric_ptr_variant> metrics_map;
+metrics_map_type metrics_map;
+
+std::vector<metrics_map_type::value_type*> active_metrics;
 
 size_t size() {
 	return metrics_map.size();
 }
 
+void mark_active(metrics_map_type::value_type& metric) {
+	if (!metric.second.active) {
+		metric.second.active = true;
+		active_metrics.push_back(&metric);
+	}
+}
+
 void update_metrics(const chrono::time_point& timestamp) {
-	for (auto metric_iter = metrics_map.begin(); metric_iter != metrics_map.end(); ++metric_iter) {
-		switch (metric_iter->second.which()) {
+	for (auto metric_iter = active_metrics.begin(); metric_iter != active_metrics.end(); ++metric_iter) {
+		const auto& metric_ptr = (*metric_iter)->second.metric;
+		switch (metric_ptr.which()) {
 			case metrics::metric_index::GAUGE:
 			{
-				auto* gauge = boost::get<metrics::gauge*>(metric_iter->second);
+				auto* gauge = boost::get<metrics::gauge*>(metric_ptr);
 				gauge->update_statistics(timestamp);
 				break;
 			}
 			case metrics::metric_index::COUNTER:
 			{
-				auto* counter = boost::get<metrics::counter*>(metric_iter->second);
+				auto* counter = boost::get<metrics::counter*>(metric_ptr);
 				counter->update_statistics(timestamp);
 				break;
 			}
 			case metrics::metric_index::TIMER:
 			{
-				auto* timer = boost::get<metrics::timer*>(metric_iter->second);
+				auto* timer = boost::get<metrics::timer*>(metric_ptr);
 				timer->update_statistics(timestamp);
 				break;
 			}
 			case metrics::metric_index::ATTRIBUTE:
 				break;
+			case metrics::metric_index::UNIQUE:
+			{
+				auto* unique = boost::get<metrics::unique*>(metric_ptr);
+				unique->update_statistics(timestamp);
+				break;
+			}
+			case metrics::metric_index::TOPK:
+				break;
+			case metrics::metric_index::SPAN:
+			{
+				auto* span = boost::get<metrics::span*>(metric_ptr);
+				span->update_statistics(timestamp);
+				break;
+			}
+		}
+	}
+}
+
+static
+bool settled(const metrics::metric_ptr_variant& metric_ptr) {
+	switch (metric_ptr.which()) {
+		case metrics::metric_index::GAUGE:
+			return boost::get<metrics::gauge*>(metric_ptr)->values().settled();
+		case metrics::metric_index::COUNTER:
+			return boost::get<metrics::counter*>(metric_ptr)->values().settled();
+		case metrics::metric_index::TIMER:
+			{
+				const auto* timer = boost::get<metrics::timer*>(metric_ptr);
+				return timer->instances_count() == 0 && timer->values().settled() && timer->exemplars().empty();
+			}
+		case metrics::metric_index::UNIQUE:
+			return boost::get<metrics::unique*>(metric_ptr)->estimate() == 0;
+		case metrics::metric_index::SPAN:
+			{
+				const auto* span = boost::get<metrics::span*>(metric_ptr);
+				return span->inclusive().settled() && span->self().settled();
+			}
+		case metrics::metric_index::ATTRIBUTE:
+		case metrics::metric_index::TOPK:
+		default:
+			return true;
+	}
+}
+
+void settle_metrics() {
+	size_t active_count = 0;
+	for (size_t index = 0; index < active_metrics.size(); ++index) {
+		auto* metric = active_metrics[index];
+		if (settled(metric->second.metric)) {
+			metric->second.active = false;
+		}
+		else {
+			active_metrics[active_count++] = metric;
 		}
 	}
+	active_metrics.resize(active_count);
 }
 
 void process_event_message(metrics::metric_ptr_variant& metric_ptr, const events::event_message& message) {
@@ -115,15 +182,23 @@ void process_event_message(metrics::metric_ptr_variant& metric_ptr, const events
 		case metrics::metric_index::ATTRIBUTE:
 			events::attribute::process_event(*boost::get<metrics::attribute*>(metric_ptr), message);
 			break;
+		case metrics::metric_index::UNIQUE:
+			events::unique::process_event(*boost::get<metrics::unique*>(metric_ptr), message);
+			break;
+		case metrics::metric_index::TOPK:
+			events::topk::process_event(*boost::get<metrics::topk*>(metric_ptr), message);
+			break;
+		case metrics::metric_index::SPAN:
+			events::span::process_event(*boost::get<metrics::span*>(metric_ptr), message);
+			break;
 		default:
 			return;
 	}
 }
 
-void process_event_message(const events::event_message& message) {
-	auto process_start_time = chrono::tsc_clock::now();
-
-	auto& metric_ptr = metrics_map[message.destination_name];
+metrics_map_type::value_type& find_metric(const std::string& metric_name, const char& destination_type) {
+	auto& metric = *metrics_map.insert(std::make_pair(metric_name, metric_entry())).first;
+	auto& metric_ptr = metric.second.metric;
 
 	bool empty_metric = false;
 
@@ -148,12 +223,27 @@ void process_event_message(const events::event_message& message) {
 				empty_metric = true;
 			}
 			break;
+		case metrics::metric_index::UNIQUE:
+			if (boost::get<metrics::unique*>(metric_ptr) == 0) {
+				empty_metric = true;
+			}
+			break;
+		case metrics::metric_index::TOPK:
+			if (boost::get<metrics::topk*>(metric_ptr) == 0) {
+				empty_metric = true;
+			}
+			break;
+		case metrics::metric_index::SPAN:
+			if (boost::get<metrics::span*>(metric_ptr) == 0) {
+				empty_metric = true;
+			}
+			break;
 	}
 
 	if (empty_metric) {
-		rapidjson::Value* pattern_cfg = config::select_pattern(message.destination_name);
+		rapidjson::Value* pattern_cfg = config::select_pattern(metric_name);
 
-		switch (message.destination_type) {
+		switch (destination_type) {
 			case events::event_destination_type::COUNTER:
 				{
 					auto counter_opts = config::metrics::counter_opts;
@@ -186,10 +276,47 @@ void process_event_message(const events::event_message& message) {
 					metric_ptr = new metrics::attribute();
 					break;
 				}
+			case events::event_destination_type::UNIQUE:
+				{
+					auto unique_opts = config::metrics::unique_opts;
+					if (pattern_cfg) {
+						configure(unique_opts, *pattern_cfg);
+					}
+					metric_ptr = new metrics::unique(unique_opts);
+					break;
+				}
+			case events::event_destination_type::TOPK:
+				{
+					auto topk_opts = config::metrics::topk_opts;
+					if (pattern_cfg) {
+						configure(topk_opts, *pattern_cfg);
+					}
+					metric_ptr = new metrics::topk(topk_opts);
+					break;
+				}
+			case events::event_destination_type::SPAN:
+				{
+					// span's statistics are configured as timer's ones
+					auto timer_opts = config::metrics::timer_opts;
+					if (pattern_cfg) {
+						configure(timer_opts, *pattern_cfg);
+					}
+					metric_ptr = new metrics::span(timer_opts);
+					break;
+				}
 		}
 	}
 
-	process_event_message(metric_ptr, message);
+	return metric;
+}
+
+void process_event_message(const events::event_message& message) {
+	auto process_start_time = chrono::tsc_clock::now();
+
+	auto& metric = find_metric(message.destination_name, message.destination_type);
+
+	process_event_message(metric.second.metric, message);
+	mark_active(metric);
 
 	auto process_end_time = chrono::tsc_clock::now();
 
@@ -208,18 +335,28 @@ void initialize() {
 
 void finalize() {
 	for (auto metric_iter = metrics_map.begin(); metric_iter != metrics_map.end(); ++metric_iter) {
-		switch (metric_iter->second.which()) {
+		const auto& metric_ptr = metric_iter->second.metric;
+		switch (metric_ptr.which()) {
 			case metrics::metric_index::COUNTER:
-				delete boost::get<metrics::counter*>(metric_iter->second);
+				delete boost::get<metrics::counter*>(metric_ptr);
 				break;
 			case metrics::metric_index::GAUGE:
-				delete boost::get<metrics::gauge*>(metric_iter->second);
+				delete boost::get<metrics::gauge*>(metric_ptr);
 				break;
 			case metrics::metric_index::TIMER:
-				delete boost::get<metrics::timer*>(metric_iter->second);
+				delete boost::get<metrics::timer*>(metric_ptr);
 				break;
 			case metrics::metric_index::ATTRIBUTE:
-				delete boost::get<metrics::attribute*>(metric_iter->second);
+				delete boost::get<metrics::attribute*>(metric_ptr);
+				break;
+			case metrics::metric_index::UNIQUE:
+				delete boost::get<metrics::unique*>(metric_ptr);
+				break;
+			case metrics::metric_index::TOPK:
+				delete boost::get<metrics::topk*>(metric_ptr);
+				break;
+			case metrics::metric_index::SPAN:
+				delete boost::get<metrics::span*>(metric_ptr);
 				break;
 			default:
 				break;
@@ -227,6 +364,7 @@ void finalize() {
 	}
 
 	metrics_map.clear();
+	active_metrics.clear();
 
 	stats::finalize();
 }
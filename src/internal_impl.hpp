@@ -20,6 +20,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include <handystats/metrics.hpp>
 #include <handystats/metrics/gauge.hpp>
@@ -34,12 +35,40 @@ struct event_message;
 
 namespace handystats { namespace internal {
 
-extern std::map<std::string, metrics::metric_ptr_variant> metrics_map;
+struct metric_entry {
+	metrics::metric_ptr_variant metric;
+	// metric is listed in active_metrics
+	bool active;
 
+	metric_entry()
+		: metric()
+		, active(false)
+	{}
+};
+
+typedef std::map<std::string, metric_entry> metrics_map_type;
+
+extern metrics_map_type metrics_map;
+
+// Metrics to be refreshed in the next dump:
+// changed since the last dump or with statistics that still change with time
+extern std::vector<metrics_map_type::value_type*> active_metrics;
+
+// should be called on every change of the metric
+void mark_active(metrics_map_type::value_type&);
+
+// Statistics of active metrics are updated only, statistics of others don't change with time
 void update_metrics(const chrono::time_point&);
 
+// Metrics whose statistics don't change with time anymore are dropped from active ones
+// Should be called once active metrics are dumped
+void settle_metrics();
+
 void process_event_message(const events::event_message&);
 
+// metric is created according to configuration if it doesn't exist
+metrics_map_type::value_type& find_metric(const std::string& metric_name, const char& destination_type);
+
 size_t size();
 
 void initialize();
@@ -75,6 +75,52 @@ inline void write_to_json_value(const metrics::attribute* const obj, rapidjson::
 	}
 }
 
+template<typename Writer>
+inline void write_to_json_writer(const metrics::attribute* const obj, Writer& writer) {
+	if (!obj) {
+		writer.Null();
+		return;
+	}
+
+	writer.StartObject();
+
+	writer.String("type");
+	writer.String("attribute");
+
+	writer.String("value");
+	switch (obj->value().which()) {
+		case metrics::attribute::value_index::BOOL:
+			writer.Bool(boost::get<bool>(obj->value()));
+			break;
+		case metrics::attribute::value_index::INT:
+			writer.Int(boost::get<int>(obj->value()));
+			break;
+		case metrics::attribute::value_index::UINT:
+			writer.Uint(boost::get<unsigned>(obj->value()));
+			break;
+		case metrics::attribute::value_index::INT64:
+			writer.Int64(boost::get<int64_t>(obj->value()));
+			break;
+		case metrics::attribute::value_index::UINT64:
+			writer.Uint64(boost::get<uint64_t>(obj->value()));
+			break;
+		case metrics::attribute::value_index::DOUBLE:
+			writer.Double(boost::get<double>(obj->value()));
+			break;
+		case metrics::attribute::value_index::STRING:
+			{
+				const std::string& value = boost::get<std::string>(obj->value());
+				writer.String(value.c_str(), rapidjson::SizeType(value.size()));
+				break;
+			}
+		default:
+			writer.Null();
+			break;
+	}
+
+	writer.EndObject();
+}
+
 template<typename StringBuffer, typename Allocator>
 inline void write_to_json_buffer(const metrics::attribute* const obj, StringBuffer* buffer, Allocator& allocator) {
 	rapidjson::Value json_value;
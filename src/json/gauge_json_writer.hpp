@@ -49,6 +49,23 @@ inline void write_to_json_value(const metrics::gauge* const obj, rapidjson::Valu
 	write_to_json_value(&obj->values(), json_value, allocator);
 }
 
+template<typename Writer>
+inline void write_to_json_writer(const metrics::gauge* const obj, Writer& writer) {
+	if (!obj || obj->values().tags() == statistics::tag::empty) {
+		writer.Null();
+		return;
+	}
+
+	writer.StartObject();
+
+	writer.String("type");
+	writer.String("gauge");
+
+	write_json_members(&obj->values(), writer);
+
+	writer.EndObject();
+}
+
 template<typename StringBuffer, typename Allocator>
 inline void write_to_json_buffer(const metrics::gauge* const obj, StringBuffer* buffer, Allocator& allocator) {
 	rapidjson::Value json_value;
@@ -0,0 +1,286 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_PROMETHEUS_WRITER_HPP_
+#define HANDYSTATS_PROMETHEUS_WRITER_HPP_
+
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+#include <cstdlib>
+
+#include <string>
+
+#include <handystats/statistics.hpp>
+#include <handystats/metrics.hpp>
+
+namespace handystats { namespace prometheus {
+
+/*
+ * Prometheus text exposition format (version 0.0.4) writers.
+ *
+ * Each metric is written as separate family:
+ *   counter, gauge, attribute and unique -- gauge (handystats counter may be decremented),
+ *                                           counter and gauge without value tag are skipped
+ *   timer and span -- summary if quantiles are enabled, gauges of histogram buckets if only histogram is enabled,
+ *                     gauge of the last value otherwise; values are in microseconds,
+ *                     quantiles and histogram buckets cover statistics' moving interval
+ *
+ * Histogram buckets of the moving interval decrease as the interval slides,
+ * so they are not exposed as Prometheus histogram (its buckets are counters and any drop is taken as reset),
+ * but as separate <name>_bucket, <name>_sum and <name>_count gauges that histogram_quantile() still accepts.
+ *   topk -- gauge labeled by key
+ *
+ * Different names may be sanitized to the same family name (e.g. "a.b" and "a_b",
+ * or span "x" and metric "x_self"). Since duplicate family fails the whole scrape,
+ * the later metric in dump's order is skipped and only noted by a comment line.
+ */
+
+// [a-zA-Z_:][a-zA-Z0-9_:]*, other characters are replaced by '_'
+inline void write_name(const std::string& name, std::string& output) {
+	if (name.empty() || (name[0] >= '0' && name[0] <= '9')) {
+		output.push_back('_');
+	}
+
+	for (size_t index = 0; index < name.size(); ++index) {
+		const char c = name[index];
+		if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == ':') {
+			output.push_back(c);
+		}
+		else {
+			output.push_back('_');
+		}
+	}
+}
+
+inline void write_label_value(const std::string& value, std::string& output) {
+	output.push_back('"');
+	for (size_t index = 0; index < value.size(); ++index) {
+		switch (value[index]) {
+			case '\\':
+				output.append("\\\\");
+				break;
+			case '"':
+				output.append("\\\"");
+				break;
+			case '\n':
+				output.append("\\n");
+				break;
+			default:
+				output.push_back(value[index]);
+		}
+	}
+	output.push_back('"');
+}
+
+// the shortest representation that is parsed back to the same double
+inline void write_value(const double& value, std::string& output) {
+	if (std::isnan(value)) {
+		output.append("NaN");
+		return;
+	}
+	if (std::isinf(value)) {
+		output.append(value > 0 ? "+Inf" : "-Inf");
+		return;
+	}
+
+	char buffer[32];
+	int length = snprintf(buffer, sizeof(buffer), "%.15g", value);
+	if (strtod(buffer, nullptr) != value) {
+		length = snprintf(buffer, sizeof(buffer), "%.17g", value);
+	}
+	output.append(buffer, length);
+}
+
+inline void write_type(const std::string& name, const char* type, std::string& output) {
+	output.append("# TYPE ");
+	write_name(name, output);
+	output.push_back(' ');
+	output.append(type);
+	output.push_back('\n');
+}
+
+inline void write_sample(
+		const std::string& name, const char* suffix,
+		const char* label, const std::string& label_value,
+		const double& value, std::string& output
+	)
+{
+	write_name(name, output);
+	output.append(suffix);
+	if (label) {
+		output.push_back('{');
+		output.append(label);
+		output.push_back('=');
+		write_label_value(label_value, output);
+		output.push_back('}');
+	}
+	output.push_back(' ');
+	write_value(value, output);
+	output.push_back('\n');
+}
+
+inline void write_sample(const std::string& name, const char* suffix, const double& value, std::string& output) {
+	write_sample(name, suffix, nullptr, std::string(), value, output);
+}
+
+// comment line instead of the metric whose family name is already taken
+inline void write_collision(const std::string& name, std::string& output) {
+	output.append("# handystats: metric ");
+	write_label_value(name, output);
+	output.append(" is skipped, its name collides with another metric\n");
+}
+
+inline void write_gauge(const std::string& name, const double& value, std::string& output) {
+	write_type(name, "gauge", output);
+	write_sample(name, "", value, output);
+}
+
+inline void write_sum_and_count(const std::string& name, const statistics& values, std::string& output) {
+	if (values.enabled(statistics::tag::sum)) {
+		write_sample(name, "_sum", values.get<statistics::tag::sum>(), output);
+	}
+	if (values.enabled(statistics::tag::count)) {
+		write_sample(name, "_count", values.get<statistics::tag::count>(), output);
+	}
+}
+
+// distribution of measured values (timer and span)
+inline void write_distribution(const std::string& name, const statistics& values, std::string& output) {
+	static const double QUANTILES[] = {0.25, 0.5, 0.75, 0.9, 0.95};
+	static const char* const QUANTILE_LABELS[] = {"0.25", "0.5", "0.75", "0.9", "0.95"};
+
+	if (values.enabled(statistics::tag::quantile)) {
+		write_type(name, "summary", output);
+
+		const auto& quantile = values.get<statistics::tag::quantile>();
+		for (size_t index = 0; index < sizeof(QUANTILES) / sizeof(*QUANTILES); ++index) {
+			write_sample(name, "", "quantile", QUANTILE_LABELS[index], quantile.at(QUANTILES[index]), output);
+		}
+		write_sum_and_count(name, values, output);
+	}
+	else if (values.enabled(statistics::tag::histogram)) {
+		const std::string& bucket_name = name + "_bucket";
+		write_type(bucket_name, "gauge", output);
+
+		// upper bound of the bin is the middle between its center and the next bin's center
+		const auto& histogram = values.get<statistics::tag::histogram>();
+		std::string bound;
+		double cumulative_count = 0;
+		for (size_t index = 0; index + 1 < histogram.size(); ++index) {
+			cumulative_count += std::get<statistics::BIN_COUNT>(histogram[index]);
+
+			bound.clear();
+			write_value(
+					(std::get<statistics::BIN_CENTER>(histogram[index]) + std::get<statistics::BIN_CENTER>(histogram[index + 1])) / 2,
+					bound
+				);
+			write_sample(bucket_name, "", "le", bound, cumulative_count, output);
+		}
+		if (!histogram.empty()) {
+			cumulative_count += std::get<statistics::BIN_COUNT>(histogram.back());
+		}
+		write_sample(bucket_name, "", "le", "+Inf", cumulative_count, output);
+
+		// buckets cover moving interval, so do sum and count
+		if (values.enabled(statistics::tag::moving_sum)) {
+			write_gauge(name + "_sum", values.get<statistics::tag::moving_sum>(), output);
+		}
+		write_gauge(name + "_count", cumulative_count, output);
+	}
+	else if (values.enabled(statistics::tag::value)) {
+		write_gauge(name, values.get<statistics::tag::value>(), output);
+	}
+}
+
+struct attribute_value_visitor : public boost::static_visitor<bool> {
+	attribute_value_visitor(double& value)
+		: value(value)
+	{}
+
+	template <typename T>
+	bool operator() (const T& attribute_value) const {
+		value = attribute_value;
+		return true;
+	}
+	bool operator() (const std::string&) const {
+		return false;
+	}
+
+	double& value;
+};
+
+inline void write_metric(const std::string& name, const metrics::metric_variant& metric, std::string& output) {
+	switch (metric.which()) {
+		case metrics::metric_index::COUNTER:
+			{
+				const statistics& values = boost::get<metrics::counter>(metric).values();
+				if (values.enabled(statistics::tag::value)) {
+					write_gauge(name, values.get<statistics::tag::value>(), output);
+				}
+				break;
+			}
+		case metrics::metric_index::GAUGE:
+			{
+				const statistics& values = boost::get<metrics::gauge>(metric).values();
+				if (values.enabled(statistics::tag::value)) {
+					write_gauge(name, values.get<statistics::tag::value>(), output);
+				}
+				break;
+			}
+		case metrics::metric_index::TIMER:
+			write_distribution(name, boost::get<metrics::timer>(metric).values(), output);
+			break;
+		case metrics::metric_index::ATTRIBUTE:
+			{
+				const auto& attribute_value = boost::get<metrics::attribute>(metric).value();
+				double value = 0;
+				if (boost::apply_visitor(attribute_value_visitor(value), attribute_value)) {
+					write_gauge(name, value, output);
+				}
+				else {
+					// string attribute is exposed as info-like gauge
+					write_type(name, "gauge", output);
+					write_sample(name, "", "value", boost::get<std::string>(attribute_value), 1, output);
+				}
+				break;
+			}
+		case metrics::metric_index::UNIQUE:
+			write_gauge(name, boost::get<metrics::unique>(metric).estimate(), output);
+			break;
+		case metrics::metric_index::TOPK:
+			{
+				write_type(name, "gauge", output);
+				const auto& top = boost::get<metrics::topk>(metric).top();
+				for (auto entry = top.begin(); entry != top.end(); ++entry) {
+					write_sample(name, "", "key", entry->key, entry->count, output);
+				}
+				break;
+			}
+		case metrics::metric_index::SPAN:
+			{
+				const auto& span = boost::get<metrics::span>(metric);
+				write_distribution(name, span.inclusive(), output);
+				write_distribution(name + "_self", span.self(), output);
+				break;
+			}
+	}
+}
+
+}} // namespace handystats::prometheus
+
+#endif // HANDYSTATS_PROMETHEUS_WRITER_HPP_
@@ -0,0 +1,101 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_SPAN_JSON_WRITER_HPP_
+#define HANDYSTATS_SPAN_JSON_WRITER_HPP_
+
+#include <string>
+
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/prettywriter.h>
+
+#include <handystats/metrics/span.hpp>
+
+#include "json/statistics_json_writer.hpp"
+
+namespace handystats { namespace json {
+
+template<typename Allocator>
+inline void write_to_json_value(const metrics::span* const obj, rapidjson::Value* json_value, Allocator& allocator) {
+	if (!obj) {
+		json_value = new rapidjson::Value();
+		return;
+	}
+
+	if (!json_value) {
+		json_value = new rapidjson::Value(rapidjson::kObjectType);
+	}
+	else {
+		json_value->SetObject();
+	}
+
+	json_value->AddMember("type", "span", allocator);
+
+	rapidjson::Value inclusive_value;
+	write_to_json_value(&obj->inclusive(), &inclusive_value, allocator);
+	json_value->AddMember("inclusive", inclusive_value, allocator);
+
+	rapidjson::Value self_value;
+	write_to_json_value(&obj->self(), &self_value, allocator);
+	json_value->AddMember("self", self_value, allocator);
+}
+
+template<typename Writer>
+inline void write_to_json_writer(const metrics::span* const obj, Writer& writer) {
+	if (!obj) {
+		writer.Null();
+		return;
+	}
+
+	writer.StartObject();
+
+	writer.String("type");
+	writer.String("span");
+
+	writer.String("inclusive");
+	write_to_json_writer(&obj->inclusive(), writer);
+	writer.String("self");
+	write_to_json_writer(&obj->self(), writer);
+
+	writer.EndObject();
+}
+
+template<typename StringBuffer, typename Allocator>
+inline void write_to_json_buffer(const metrics::span* const obj, StringBuffer* buffer, Allocator& allocator) {
+	rapidjson::Value json_value;
+	write_to_json_value(obj, &json_value, allocator);
+
+	if (!buffer) {
+		buffer = new StringBuffer();
+	}
+
+	rapidjson::PrettyWriter<StringBuffer> writer(*buffer);
+	json_value.Accept(writer);
+}
+
+template<typename Allocator>
+inline std::string write_to_json_string(const metrics::span* const obj, Allocator&& allocator = Allocator()) {
+	rapidjson::GenericStringBuffer<rapidjson::UTF8<>, Allocator> buffer(&allocator);
+	write_to_json_buffer(obj, &buffer, allocator);
+
+	return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+}} // namespace handystats::json
+
+#endif // HANDYSTATS_SPAN_JSON_WRITER_HPP_
@@ -110,6 +110,96 @@ inline void write_to_json_value(const statistics* const obj, rapidjson::Value* j
 	}
 }
 
+// Writes statistics' members into already started object
+template<typename Writer>
+inline void write_json_members(const statistics* const obj, Writer& writer) {
+	if (obj->enabled(statistics::tag::value)) {
+		writer.String("value");
+		writer.Double(obj->get<statistics::tag::value>());
+	}
+	if (obj->enabled(statistics::tag::min)) {
+		writer.String("min");
+		writer.Double(obj->get<statistics::tag::min>());
+	}
+	if (obj->enabled(statistics::tag::max)) {
+		writer.String("max");
+		writer.Double(obj->get<statistics::tag::max>());
+	}
+	if (obj->enabled(statistics::tag::count)) {
+		writer.String("count");
+		writer.Uint64(obj->get<statistics::tag::count>());
+	}
+	if (obj->enabled(statistics::tag::sum)) {
+		writer.String("sum");
+		writer.Double(obj->get<statistics::tag::sum>());
+	}
+	if (obj->enabled(statistics::tag::avg)) {
+		writer.String("avg");
+		writer.Double(obj->get<statistics::tag::avg>());
+	}
+	if (obj->enabled(statistics::tag::moving_count)) {
+		writer.String("moving-count");
+		writer.Double(obj->get<statistics::tag::moving_count>());
+	}
+	if (obj->enabled(statistics::tag::moving_sum)) {
+		writer.String("moving-sum");
+		writer.Double(obj->get<statistics::tag::moving_sum>());
+	}
+	if (obj->enabled(statistics::tag::moving_avg)) {
+		writer.String("moving-avg");
+		writer.Double(obj->get<statistics::tag::moving_avg>());
+	}
+	if (obj->enabled(statistics::tag::histogram)) {
+		const auto& histogram = obj->get<statistics::tag::histogram>();
+		writer.String("histogram");
+		writer.StartArray();
+		for (auto bin = histogram.begin(); bin != histogram.end(); ++bin) {
+			writer.StartArray();
+			writer.Double(std::get<statistics::BIN_CENTER>(*bin));
+			writer.Double(std::get<statistics::BIN_COUNT>(*bin));
+			writer.EndArray();
+		}
+		writer.EndArray();
+	}
+	if (obj->enabled(statistics::tag::quantile)) {
+		const auto& quantile = obj->get<statistics::tag::quantile>();
+		writer.String("p25");
+		writer.Double(quantile.at(0.25));
+		writer.String("p50");
+		writer.Double(quantile.at(0.50));
+		writer.String("p75");
+		writer.Double(quantile.at(0.75));
+		writer.String("p90");
+		writer.Double(quantile.at(0.90));
+		writer.String("p95");
+		writer.Double(quantile.at(0.95));
+	}
+	if (obj->enabled(statistics::tag::timestamp)) {
+		writer.String("timestamp");
+		write_to_json_writer(obj->get<statistics::tag::timestamp>(), writer);
+	}
+	if (obj->enabled(statistics::tag::rate)) {
+		writer.String("rate");
+		writer.Double(obj->get<statistics::tag::rate>());
+	}
+	if (obj->enabled(statistics::tag::entropy)) {
+		writer.String("entropy");
+		writer.Double(obj->get<statistics::tag::entropy>());
+	}
+}
+
+template<typename Writer>
+inline void write_to_json_writer(const statistics* const obj, Writer& writer) {
+	if (!obj || obj->tags() == statistics::tag::empty) {
+		writer.Null();
+		return;
+	}
+
+	writer.StartObject();
+	write_json_members(obj, writer);
+	writer.EndObject();
+}
+
 template<typename StringBuffer, typename Allocator>
 inline void write_to_json_buffer(const statistics* const obj, StringBuffer* buffer, Allocator& allocator) {
 	rapidjson::Value json_value;
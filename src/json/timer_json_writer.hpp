@@ -47,6 +47,57 @@ inline void write_to_json_value(const metrics::timer* const obj, rapidjson::Valu
 	json_value->AddMember("type", "timer", allocator);
 
 	write_to_json_value(&obj->values(), json_value, allocator);
+
+	const auto& exemplars = obj->exemplars();
+	if (!exemplars.empty()) {
+		rapidjson::Value exemplars_value(rapidjson::kArrayType);
+		for (const auto& exemplar : exemplars) {
+			rapidjson::Value exemplar_value(rapidjson::kObjectType);
+			exemplar_value.AddMember("value", exemplar.value.count(), allocator);
+			exemplar_value.AddMember("instance", exemplar.instance_id, allocator);
+
+			rapidjson::Value timestamp_value;
+			write_to_json_value(exemplar.timestamp, &timestamp_value);
+			exemplar_value.AddMember("timestamp", timestamp_value, allocator);
+
+			exemplars_value.PushBack(exemplar_value, allocator);
+		}
+		json_value->AddMember("exemplars", exemplars_value, allocator);
+	}
+}
+
+template<typename Writer>
+inline void write_to_json_writer(const metrics::timer* const obj, Writer& writer) {
+	if (!obj || obj->values().tags() == statistics::tag::empty) {
+		writer.Null();
+		return;
+	}
+
+	writer.StartObject();
+
+	writer.String("type");
+	writer.String("timer");
+
+	write_json_members(&obj->values(), writer);
+
+	const auto& exemplars = obj->exemplars();
+	if (!exemplars.empty()) {
+		writer.String("exemplars");
+		writer.StartArray();
+		for (const auto& exemplar : exemplars) {
+			writer.StartObject();
+			writer.String("value");
+			writer.Int64(exemplar.value.count());
+			writer.String("instance");
+			writer.Uint64(exemplar.instance_id);
+			writer.String("timestamp");
+			write_to_json_writer(exemplar.timestamp, writer);
+			writer.EndObject();
+		}
+		writer.EndArray();
+	}
+
+	writer.EndObject();
 }
 
 template<typename StringBuffer, typename Allocator>
@@ -35,6 +35,12 @@ inline void write_to_json_value(const chrono::time_point& timestamp, rapidjson::
 	json_value->SetUint64(chrono::duration::convert_to(chrono::time_unit::MSEC, system_timestamp.time_since_epoch()).count());
 }
 
+template<typename Writer>
+inline void write_to_json_writer(const chrono::time_point& timestamp, Writer& writer) {
+	chrono::time_point system_timestamp = chrono::time_point::convert_to(chrono::clock_type::SYSTEM, timestamp);
+	writer.Uint64(chrono::duration::convert_to(chrono::time_unit::MSEC, system_timestamp.time_since_epoch()).count());
+}
+
 template<typename StringBuffer, typename Allocator>
 inline void write_to_json_buffer(const chrono::time_point& timestamp, StringBuffer* buffer, Allocator& allocator) {
 	rapidjson::Value json_value;
@@ -0,0 +1,127 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_TOPK_JSON_WRITER_HPP_
+#define HANDYSTATS_TOPK_JSON_WRITER_HPP_
+
+#include <string>
+
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/prettywriter.h>
+
+#include <handystats/metrics/topk.hpp>
+
+#include "json/timestamp.hpp"
+
+namespace handystats { namespace json {
+
+template<typename Allocator>
+inline void write_to_json_value(const metrics::topk* const obj, rapidjson::Value* json_value, Allocator& allocator) {
+	if (!obj) {
+		json_value = new rapidjson::Value();
+		return;
+	}
+
+	if (!json_value) {
+		json_value = new rapidjson::Value(rapidjson::kObjectType);
+	}
+	else {
+		json_value->SetObject();
+	}
+
+	json_value->AddMember("type", "topk", allocator);
+
+	json_value->AddMember("total", obj->total(), allocator);
+
+	rapidjson::Value top_value(rapidjson::kArrayType);
+	const metrics::topk::entries_type& top = obj->top();
+	for (auto entry_iter = top.begin(); entry_iter != top.end(); ++entry_iter) {
+		rapidjson::Value entry_value(rapidjson::kObjectType);
+		entry_value.AddMember("key", rapidjson::Value(entry_iter->key.c_str(), allocator), allocator);
+		entry_value.AddMember("count", entry_iter->count, allocator);
+		entry_value.AddMember("error", entry_iter->error, allocator);
+
+		top_value.PushBack(entry_value, allocator);
+	}
+	json_value->AddMember("top", top_value, allocator);
+
+	rapidjson::Value timestamp_value;
+	write_to_json_value(obj->timestamp(), &timestamp_value);
+	json_value->AddMember("timestamp", timestamp_value, allocator);
+}
+
+template<typename Writer>
+inline void write_to_json_writer(const metrics::topk* const obj, Writer& writer) {
+	if (!obj) {
+		writer.Null();
+		return;
+	}
+
+	writer.StartObject();
+
+	writer.String("type");
+	writer.String("topk");
+
+	writer.String("total");
+	writer.Double(obj->total());
+
+	writer.String("top");
+	writer.StartArray();
+	const metrics::topk::entries_type& top = obj->top();
+	for (auto entry_iter = top.begin(); entry_iter != top.end(); ++entry_iter) {
+		writer.StartObject();
+		writer.String("key");
+		writer.String(entry_iter->key.c_str(), rapidjson::SizeType(entry_iter->key.size()));
+		writer.String("count");
+		writer.Double(entry_iter->count);
+		writer.String("error");
+		writer.Double(entry_iter->error);
+		writer.EndObject();
+	}
+	writer.EndArray();
+
+	writer.String("timestamp");
+	write_to_json_writer(obj->timestamp(), writer);
+
+	writer.EndObject();
+}
+
+template<typename StringBuffer, typename Allocator>
+inline void write_to_json_buffer(const metrics::topk* const obj, StringBuffer* buffer, Allocator& allocator) {
+	rapidjson::Value json_value;
+	write_to_json_value(obj, &json_value, allocator);
+
+	if (!buffer) {
+		buffer = new StringBuffer();
+	}
+
+	rapidjson::PrettyWriter<StringBuffer> writer(*buffer);
+	json_value.Accept(writer);
+}
+
+template<typename Allocator>
+inline std::string write_to_json_string(const metrics::topk* const obj, Allocator&& allocator = Allocator()) {
+	rapidjson::GenericStringBuffer<rapidjson::UTF8<>, Allocator> buffer(&allocator);
+	write_to_json_buffer(obj, &buffer, allocator);
+
+	return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+}} // namespace handystats::json
+
+#endif // HANDYSTATS_TOPK_JSON_WRITER_HPP_
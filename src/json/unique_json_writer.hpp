@@ -0,0 +1,103 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_UNIQUE_JSON_WRITER_HPP_
+#define HANDYSTATS_UNIQUE_JSON_WRITER_HPP_
+
+#include <string>
+
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/prettywriter.h>
+
+#include <handystats/metrics/unique.hpp>
+
+#include "json/timestamp.hpp"
+
+namespace handystats { namespace json {
+
+template<typename Allocator>
+inline void write_to_json_value(const metrics::unique* const obj, rapidjson::Value* json_value, Allocator& allocator) {
+	if (!obj) {
+		json_value = new rapidjson::Value();
+		return;
+	}
+
+	if (!json_value) {
+		json_value = new rapidjson::Value(rapidjson::kObjectType);
+	}
+	else {
+		json_value->SetObject();
+	}
+
+	json_value->AddMember("type", "unique", allocator);
+
+	json_value->AddMember("estimate", obj->estimate(), allocator);
+	json_value->AddMember("total", obj->total(), allocator);
+
+	rapidjson::Value timestamp_value;
+	write_to_json_value(obj->timestamp(), &timestamp_value);
+	json_value->AddMember("timestamp", timestamp_value, allocator);
+}
+
+template<typename Writer>
+inline void write_to_json_writer(const metrics::unique* const obj, Writer& writer) {
+	if (!obj) {
+		writer.Null();
+		return;
+	}
+
+	writer.StartObject();
+
+	writer.String("type");
+	writer.String("unique");
+
+	writer.String("estimate");
+	writer.Double(obj->estimate());
+	writer.String("total");
+	writer.Double(obj->total());
+
+	writer.String("timestamp");
+	write_to_json_writer(obj->timestamp(), writer);
+
+	writer.EndObject();
+}
+
+template<typename StringBuffer, typename Allocator>
+inline void write_to_json_buffer(const metrics::unique* const obj, StringBuffer* buffer, Allocator& allocator) {
+	rapidjson::Value json_value;
+	write_to_json_value(obj, &json_value, allocator);
+
+	if (!buffer) {
+		buffer = new StringBuffer();
+	}
+
+	rapidjson::PrettyWriter<StringBuffer> writer(*buffer);
+	json_value.Accept(writer);
+}
+
+template<typename Allocator>
+inline std::string write_to_json_string(const metrics::unique* const obj, Allocator&& allocator = Allocator()) {
+	rapidjson::GenericStringBuffer<rapidjson::UTF8<>, Allocator> buffer(&allocator);
+	write_to_json_buffer(obj, &buffer, allocator);
+
+	return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+}} // namespace handystats::json
+
+#endif // HANDYSTATS_UNIQUE_JSON_WRITER_HPP_
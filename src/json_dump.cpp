@@ -15,63 +15,262 @@
 * License along with this library.
 */
 
+#include <cerrno>
+#include <memory>
+#include <string>
+#include <unistd.h>
+
+#include <rapidjson/writer.h>
+#include <rapidjson/prettywriter.h>
+
 #include <handystats/json_dump.hpp>
 
 #include "json/gauge_json_writer.hpp"
 #include "json/counter_json_writer.hpp"
 #include "json/timer_json_writer.hpp"
 #include "json/attribute_json_writer.hpp"
+#include "json/unique_json_writer.hpp"
+#include "json/topk_json_writer.hpp"
+#include "json/span_json_writer.hpp"
+
+#include "rendered_dump_impl.hpp"
 
 namespace handystats { namespace json {
 
-template<typename Allocator>
-void fill(
-		rapidjson::Value& dump, Allocator& allocator,
-		const std::map<std::string, handystats::metrics::metric_variant>& metrics_map
-	)
-{
-	dump.SetObject();
+// rapidjson output stream appending to std::string
+struct string_output_stream {
+	typedef char Ch;
 
-	for (auto metric_iter = metrics_map.cbegin(); metric_iter != metrics_map.cend(); ++metric_iter) {
-		rapidjson::Value metric_value;
-		switch (metric_iter->second.which()) {
-			case metrics::metric_index::GAUGE:
-				json::write_to_json_value(&boost::get<metrics::gauge>(metric_iter->second), &metric_value, allocator);
-				break;
-			case metrics::metric_index::COUNTER:
-				json::write_to_json_value(&boost::get<metrics::counter>(metric_iter->second), &metric_value, allocator);
-				break;
-			case metrics::metric_index::TIMER:
-				json::write_to_json_value(&boost::get<metrics::timer>(metric_iter->second), &metric_value, allocator);
-				break;
-			case metrics::metric_index::ATTRIBUTE:
-				json::write_to_json_value(&boost::get<metrics::attribute>(metric_iter->second), &metric_value, allocator);
-				break;
+	string_output_stream(std::string& buffer)
+		: buffer(buffer)
+	{}
+
+	void Put(const Ch& c) {
+		buffer.push_back(c);
+	}
+	void Flush() {
+	}
+
+	std::string& buffer;
+};
+
+// rapidjson output stream writing to file descriptor by chunks
+struct fd_output_stream {
+	typedef char Ch;
+
+	static const size_t CHUNK_SIZE = 64 * 1024;
+
+	fd_output_stream(const int& fd)
+		: fd(fd)
+		, size(0)
+		, failed(false)
+	{}
+
+	void Put(const Ch& c) {
+		if (size == CHUNK_SIZE) {
+			Flush();
+		}
+		chunk[size++] = c;
+	}
+
+	void Flush() {
+		size_t offset = 0;
+		while (offset < size && !failed) {
+			const ssize_t written = ::write(fd, chunk + offset, size - offset);
+			if (written < 0) {
+				if (errno != EINTR) {
+					failed = true;
+				}
+				continue;
+			}
+			offset += written;
 		}
+		size = 0;
+	}
+
+	const int fd;
+	char chunk[CHUNK_SIZE];
+	size_t size;
+	bool failed;
+};
+
+template<typename Writer>
+void write_metric(Writer& writer, const std::string& name, const metrics::metric_variant& metric) {
+	writer.String(name.c_str(), rapidjson::SizeType(name.size()));
 
-		dump.AddMember(rapidjson::Value(metric_iter->first.c_str(), allocator),
-		               rapidjson::Value(metric_value, allocator),
-		               allocator);
+	switch (metric.which()) {
+		case metrics::metric_index::GAUGE:
+			json::write_to_json_writer(&boost::get<metrics::gauge>(metric), writer);
+			break;
+		case metrics::metric_index::COUNTER:
+			json::write_to_json_writer(&boost::get<metrics::counter>(metric), writer);
+			break;
+		case metrics::metric_index::TIMER:
+			json::write_to_json_writer(&boost::get<metrics::timer>(metric), writer);
+			break;
+		case metrics::metric_index::ATTRIBUTE:
+			json::write_to_json_writer(&boost::get<metrics::attribute>(metric), writer);
+			break;
+		case metrics::metric_index::UNIQUE:
+			json::write_to_json_writer(&boost::get<metrics::unique>(metric), writer);
+			break;
+		case metrics::metric_index::TOPK:
+			json::write_to_json_writer(&boost::get<metrics::topk>(metric), writer);
+			break;
+		case metrics::metric_index::SPAN:
+			json::write_to_json_writer(&boost::get<metrics::span>(metric), writer);
+			break;
+		default:
+			writer.Null();
+			break;
 	}
 }
 
+template<typename Writer, typename MetricsMap>
+void write_metrics(Writer& writer, const MetricsMap& metrics_map) {
+	writer.StartObject();
+
+	for (auto metric_iter = metrics_map.cbegin(); metric_iter != metrics_map.cend(); ++metric_iter) {
+		write_metric(writer, metric_iter->first, metric_iter->second);
+	}
+
+	writer.EndObject();
+}
+
+template<typename Writer>
+void write_metrics(Writer& writer, const handystats::metrics_dump::dump_delta& delta) {
+	writer.StartObject();
+
+	writer.String("version");
+	writer.Uint64(delta.version);
+
+	writer.String("since");
+	writer.Uint64(delta.since);
+
+	writer.String("full");
+	writer.Bool(delta.full);
+
+	writer.String("changed");
+	writer.StartObject();
+	for (auto entry_iter = delta.changed.cbegin(); entry_iter != delta.changed.cend(); ++entry_iter) {
+		write_metric(writer, (*entry_iter)->value.first, (*entry_iter)->value.second);
+	}
+	writer.EndObject();
+
+	writer.String("removed");
+	writer.StartArray();
+	for (auto name_iter = delta.removed.cbegin(); name_iter != delta.removed.cend(); ++name_iter) {
+		writer.String(name_iter->c_str(), rapidjson::SizeType(name_iter->size()));
+	}
+	writer.EndArray();
+
+	writer.EndObject();
+}
+
+// metrics are serialized directly from the dump, no intermediate DOM is built
+template<typename OutputStream, typename MetricsMap>
+void write_metrics(OutputStream& stream, const MetricsMap& metrics_map, const bool& compact) {
+	if (compact) {
+		rapidjson::Writer<OutputStream> writer(stream);
+		write_metrics(writer, metrics_map);
+	}
+	else {
+		rapidjson::PrettyWriter<OutputStream> writer(stream);
+		write_metrics(writer, metrics_map);
+	}
+	stream.Flush();
+}
+
 std::string to_string(const std::map<std::string, handystats::metrics::metric_variant>& metrics_map) {
-	typedef rapidjson::MemoryPoolAllocator<> allocator_type;
+	std::string buffer;
+	string_output_stream stream(buffer);
+	write_metrics(stream, metrics_map, false);
+	return buffer;
+}
 
-	rapidjson::Value dump;
-	allocator_type allocator;
-	fill(dump, allocator, metrics_map);
+std::string to_string(const handystats::metrics_dump::dump_map& metrics_map, const bool& compact) {
+	std::string buffer;
+	write(metrics_map, buffer, compact);
+	return buffer;
+}
 
-	rapidjson::GenericStringBuffer<rapidjson::UTF8<>, allocator_type> buffer(&allocator);
-	rapidjson::PrettyWriter<rapidjson::GenericStringBuffer<rapidjson::UTF8<>, allocator_type>> writer(buffer);
-	dump.Accept(writer);
+void write(const handystats::metrics_dump::dump_map& metrics_map, std::string& buffer, const bool& compact) {
+	buffer.clear();
+	string_output_stream stream(buffer);
+	write_metrics(stream, metrics_map, compact);
+}
+
+bool write(const handystats::metrics_dump::dump_map& metrics_map, const int& fd, const bool& compact) {
+	std::unique_ptr<fd_output_stream> stream(new fd_output_stream(fd));
+	write_metrics(*stream, metrics_map, compact);
+	return !stream->failed;
+}
+
+std::string to_string(const handystats::metrics_dump::dump_view& metrics_view, const bool& compact) {
+	std::string buffer;
+	write(metrics_view, buffer, compact);
+	return buffer;
+}
+
+void write(const handystats::metrics_dump::dump_view& metrics_view, std::string& buffer, const bool& compact) {
+	buffer.clear();
+	string_output_stream stream(buffer);
+	write_metrics(stream, metrics_view, compact);
+}
+
+bool write(const handystats::metrics_dump::dump_view& metrics_view, const int& fd, const bool& compact) {
+	std::unique_ptr<fd_output_stream> stream(new fd_output_stream(fd));
+	write_metrics(*stream, metrics_view, compact);
+	return !stream->failed;
+}
 
-	return std::string(buffer.GetString(), buffer.GetSize());
+std::string to_string(const handystats::metrics_dump::dump_delta& delta, const bool& compact) {
+	std::string buffer;
+	write(delta, buffer, compact);
+	return buffer;
+}
+
+void write(const handystats::metrics_dump::dump_delta& delta, std::string& buffer, const bool& compact) {
+	buffer.clear();
+	string_output_stream stream(buffer);
+	write_metrics(stream, delta, compact);
+}
+
+static metrics_dump::rendered_dump pretty_json_dump;
+static metrics_dump::rendered_dump compact_json_dump;
+
+static
+void render_pretty(const handystats::metrics_dump::dump_map& metrics_map, std::string& buffer) {
+	write(metrics_map, buffer, false);
+}
+
+static
+void render_compact(const handystats::metrics_dump::dump_map& metrics_map, std::string& buffer) {
+	write(metrics_map, buffer, true);
+}
+
+const std::shared_ptr<const std::string> to_shared_string(
+		const handystats::metrics_dump::dump_map& metrics_map, const bool& compact
+	)
+{
+	if (compact) {
+		return compact_json_dump.get(metrics_map, render_compact);
+	}
+	else {
+		return pretty_json_dump.get(metrics_map, render_pretty);
+	}
 }
 
 }} // namespace handystats::json
 
 std::string HANDY_JSON_DUMP() {
-	return handystats::json::to_string(*HANDY_METRICS_DUMP());
+	return *HANDY_JSON_DUMP_SHARED();
+}
+
+const std::shared_ptr<const std::string> HANDY_JSON_DUMP_SHARED(const bool& compact) {
+	return handystats::json::to_shared_string(*HANDY_METRICS_DUMP(), compact);
 }
 
+std::string HANDY_JSON_DUMP_SINCE(const uint64_t& version, const bool& compact) {
+	return handystats::json::to_string(HANDY_METRICS_DUMP_SINCE(version), compact);
+}
@@ -21,6 +21,7 @@
 #include "events/counter_impl.hpp"
 #include "message_queue_impl.hpp"
 #include "core_impl.hpp"
+#include "receive_time_impl.hpp"
 
 #include <handystats/measuring_points/counter.hpp>
 #include <handystats/measuring_points/counter.h>
@@ -35,8 +36,9 @@ void counter_init(
 		)
 {
 	if (handystats::is_enabled()) {
+		const auto& event_timestamp = handystats::receive_time::counter_timestamp(counter_name, timestamp);
 		handystats::message_queue::push(
-				handystats::events::counter::create_init_event(std::move(counter_name), init_value, timestamp)
+				handystats::events::counter::create_init_event(std::move(counter_name), init_value, event_timestamp)
 			);
 	}
 }
@@ -48,8 +50,9 @@ void counter_increment(
 		)
 {
 	if (handystats::is_enabled()) {
+		const auto& event_timestamp = handystats::receive_time::counter_timestamp(counter_name, timestamp);
 		handystats::message_queue::push(
-				handystats::events::counter::create_increment_event(std::move(counter_name), value, timestamp)
+				handystats::events::counter::create_increment_event(std::move(counter_name), value, event_timestamp)
 			);
 	}
 }
@@ -61,8 +64,9 @@ void counter_decrement(
 		)
 {
 	if (handystats::is_enabled()) {
+		const auto& event_timestamp = handystats::receive_time::counter_timestamp(counter_name, timestamp);
 		handystats::message_queue::push(
-				handystats::events::counter::create_decrement_event(std::move(counter_name), value, timestamp)
+				handystats::events::counter::create_decrement_event(std::move(counter_name), value, event_timestamp)
 			);
 	}
 }
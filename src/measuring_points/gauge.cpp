@@ -21,6 +21,7 @@
 #include "events/gauge_impl.hpp"
 #include "message_queue_impl.hpp"
 #include "core_impl.hpp"
+#include "receive_time_impl.hpp"
 
 #include <handystats/measuring_points/gauge.hpp>
 #include <handystats/measuring_points/gauge.h>
@@ -35,8 +36,9 @@ void gauge_init(
 	)
 {
 	if (handystats::is_enabled()) {
+		const auto& event_timestamp = handystats::receive_time::gauge_timestamp(gauge_name, timestamp);
 		handystats::message_queue::push(
-				handystats::events::gauge::create_init_event(std::move(gauge_name), init_value, timestamp)
+				handystats::events::gauge::create_init_event(std::move(gauge_name), init_value, event_timestamp)
 			);
 	}
 }
@@ -48,8 +50,9 @@ void gauge_set(
 	)
 {
 	if (handystats::is_enabled()) {
+		const auto& event_timestamp = handystats::receive_time::gauge_timestamp(gauge_name, timestamp);
 		handystats::message_queue::push(
-				handystats::events::gauge::create_set_event(std::move(gauge_name), value, timestamp)
+				handystats::events::gauge::create_set_event(std::move(gauge_name), value, event_timestamp)
 			);
 	}
 }
@@ -0,0 +1,131 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <vector>
+
+#include "events/span_impl.hpp"
+#include "message_queue_impl.hpp"
+#include "config_impl.hpp"
+#include "core_impl.hpp"
+#include "span_nodes_impl.hpp"
+
+#include <handystats/measuring_points/span.hpp>
+#include <handystats/measuring_points/span.h>
+
+
+namespace {
+
+struct span_frame {
+	std::string path;
+	handystats::chrono::time_point start_timestamp;
+	// total inclusive duration of nested spans
+	handystats::chrono::duration children_duration;
+	// span is beyond configured tree bounds, its duration is accounted in the parent's self time
+	bool tracked;
+};
+
+thread_local std::vector<span_frame> span_stack;
+
+} // unnamed namespace
+
+
+namespace handystats { namespace measuring_points {
+
+void span_enter(
+		std::string&& span_name,
+		const metrics::span::time_point& timestamp
+	)
+{
+	span_frame frame;
+	frame.start_timestamp = timestamp;
+	frame.children_duration = chrono::duration();
+	frame.tracked = false;
+
+	// untracked frame still keeps the stack balanced for span_exit
+	if (!is_enabled()) {
+		span_stack.push_back(std::move(frame));
+		return;
+	}
+
+	// span is tracked only if all its ancestors are
+	const bool parent_tracked = span_stack.empty() || span_stack.back().tracked;
+
+	if (parent_tracked && span_stack.size() < config::metrics::span_opts.max_depth) {
+		if (!span_stack.empty()) {
+			const std::string& parent_path = span_stack.back().path;
+			frame.path.reserve(parent_path.size() + 1 + span_name.size());
+			frame.path.append(parent_path).append(1, '.').append(span_name);
+		}
+		else {
+			frame.path.swap(span_name);
+		}
+
+		frame.tracked = span_nodes::admit(frame.path);
+	}
+
+	span_stack.push_back(std::move(frame));
+}
+
+void span_exit(
+		const metrics::span::time_point& timestamp
+	)
+{
+	if (span_stack.empty()) {
+		return;
+	}
+
+	span_frame& frame = span_stack.back();
+	const chrono::duration inclusive_duration = timestamp - frame.start_timestamp;
+
+	if (frame.tracked) {
+		if (span_stack.size() > 1) {
+			span_stack[span_stack.size() - 2].children_duration += inclusive_duration;
+		}
+
+		if (is_enabled()) {
+			message_queue::push(
+					events::span::create_set_event(
+						std::move(frame.path),
+						inclusive_duration,
+						inclusive_duration - frame.children_duration,
+						timestamp
+					)
+				);
+		}
+	}
+
+	span_stack.pop_back();
+}
+
+}} // namespace handystats::measuring_points
+
+
+extern "C" {
+
+void handystats_span_enter(
+		const char* span_name
+	)
+{
+	handystats::measuring_points::span_enter(span_name);
+}
+
+void handystats_span_exit(void)
+{
+	handystats::measuring_points::span_exit();
+}
+
+} // extern "C"
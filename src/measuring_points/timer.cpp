@@ -21,6 +21,8 @@
 #include "events/timer_impl.hpp"
 #include "message_queue_impl.hpp"
 #include "core_impl.hpp"
+#include "timer_instances_impl.hpp"
+#include "timer_handles_impl.hpp"
 
 #include <handystats/measuring_points/timer.hpp>
 #include <handystats/measuring_points/timer.h>
@@ -48,6 +50,11 @@ void timer_start(
 	)
 {
 	if (is_enabled()) {
+		if (timer_instances::enabled()) {
+			timer_instances::start(timer_name, instance_id, timestamp);
+			return;
+		}
+
 		message_queue::push(
 				events::timer::create_start_event(std::move(timer_name), instance_id, timestamp)
 			);
@@ -61,6 +68,16 @@ void timer_stop(
 	)
 {
 	if (is_enabled()) {
+		if (timer_instances::enabled()) {
+			metrics::timer::value_type measurement;
+			if (timer_instances::stop(timer_name, instance_id, timestamp, measurement)) {
+				message_queue::push(
+						events::timer::create_set_event(std::move(timer_name), instance_id, measurement, timestamp)
+					);
+			}
+			return;
+		}
+
 		message_queue::push(
 				events::timer::create_stop_event(std::move(timer_name), instance_id, timestamp)
 			);
@@ -74,6 +91,11 @@ void timer_discard(
 	)
 {
 	if (is_enabled()) {
+		if (timer_instances::enabled()) {
+			timer_instances::discard(timer_name, instance_id, timestamp);
+			return;
+		}
+
 		message_queue::push(
 				events::timer::create_discard_event(std::move(timer_name), instance_id, timestamp)
 			);
@@ -87,6 +109,11 @@ void timer_heartbeat(
 	)
 {
 	if (is_enabled()) {
+		if (timer_instances::enabled()) {
+			timer_instances::heartbeat(timer_name, instance_id, timestamp);
+			return;
+		}
+
 		message_queue::push(
 				events::timer::create_heartbeat_event(std::move(timer_name), instance_id, timestamp)
 			);
@@ -106,6 +133,24 @@ void timer_set(
 	}
 }
 
+timer_handle timer_resolve(
+		std::string&& timer_name
+	)
+{
+	return timer_handles::resolve(timer_name);
+}
+
+void timer_record(
+		timer_handle handle,
+		const int64_t& start_time,
+		const int64_t& end_time
+	)
+{
+	if (is_enabled()) {
+		timer_handles::record(handle, start_time, end_time);
+	}
+}
+
 }} // namespace measuring_points
 
 namespace {
@@ -172,4 +217,20 @@ void handystats_timer_set(
 		);
 }
 
+struct handystats_timer_handle* handystats_timer_resolve(
+		const char* timer_name
+	)
+{
+	return handystats::measuring_points::timer_resolve(timer_name);
+}
+
+void handystats_timer_record(
+		struct handystats_timer_handle* timer_handle,
+		const int64_t start_time,
+		const int64_t end_time
+	)
+{
+	handystats::measuring_points::timer_record(timer_handle, start_time, end_time);
+}
+
 } // extern "C"
@@ -0,0 +1,57 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include "events/topk_impl.hpp"
+#include "message_queue_impl.hpp"
+#include "core_impl.hpp"
+
+#include <handystats/measuring_points/topk.hpp>
+#include <handystats/measuring_points/topk.h>
+
+
+namespace handystats { namespace measuring_points {
+
+void topk_add(
+		std::string&& topk_name,
+		const handystats::metrics::topk::key_type& key,
+		const handystats::metrics::topk::value_type& weight,
+		const handystats::metrics::topk::time_point& timestamp
+	)
+{
+	// non-positive weights are ignored by the metric, so they are not even sent
+	if (handystats::is_enabled() && weight > 0) {
+		handystats::message_queue::push(
+				handystats::events::topk::create_add_event(std::move(topk_name), key, weight, timestamp)
+			);
+	}
+}
+
+}} // namespace handystats::measuring_points
+
+
+extern "C" {
+
+void handystats_topk_add(
+		const char* topk_name,
+		const char* key,
+		const double weight
+	)
+{
+	handystats::measuring_points::topk_add(topk_name, std::string(key), weight);
+}
+
+} // extern "C"
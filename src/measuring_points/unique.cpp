@@ -0,0 +1,77 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <functional>
+
+#include "events/unique_impl.hpp"
+#include "message_queue_impl.hpp"
+#include "core_impl.hpp"
+
+#include <handystats/measuring_points/unique.hpp>
+#include <handystats/measuring_points/unique.h>
+
+
+namespace handystats { namespace measuring_points {
+
+void unique_add(
+		std::string&& unique_name,
+		const handystats::metrics::unique::value_type& key,
+		const handystats::metrics::unique::time_point& timestamp
+	)
+{
+	if (handystats::is_enabled()) {
+		handystats::message_queue::push(
+				handystats::events::unique::create_add_event(std::move(unique_name), key, timestamp)
+			);
+	}
+}
+
+void unique_add(
+		std::string&& unique_name,
+		const std::string& key,
+		const handystats::metrics::unique::time_point& timestamp
+	)
+{
+	if (handystats::is_enabled()) {
+		handystats::message_queue::push(
+				handystats::events::unique::create_add_event(std::move(unique_name), std::hash<std::string>()(key), timestamp)
+			);
+	}
+}
+
+}} // namespace handystats::measuring_points
+
+
+extern "C" {
+
+void handystats_unique_add(
+		const char* unique_name,
+		const uint64_t key
+	)
+{
+	handystats::measuring_points::unique_add(unique_name, handystats::metrics::unique::value_type(key));
+}
+
+void handystats_unique_add_string(
+		const char* unique_name,
+		const char* key
+	)
+{
+	handystats::measuring_points::unique_add(unique_name, std::string(key));
+}
+
+} // extern "C"
@@ -24,6 +24,8 @@
 #include "events/event_message_impl.hpp"
 #include "config_impl.hpp"
 
+#include "receive_time_impl.hpp"
+
 #include "message_queue_impl.hpp"
 
 namespace {
@@ -111,11 +113,13 @@ namespace stats {
 metrics::gauge size;
 metrics::gauge message_wait_time;
 metrics::counter pop_count;
+metrics::gauge receive_time_skew;
 
 void update(const chrono::time_point& timestamp) {
 	size.update_statistics(timestamp);
 	message_wait_time.update_statistics(timestamp);
 	pop_count.update_statistics(timestamp);
+	receive_time_skew.update_statistics(timestamp);
 }
 
 static void reset() {
@@ -144,6 +148,15 @@ static void reset() {
 	pop_count_opts.values.moving_interval = chrono::duration(1, chrono::time_unit::SEC);
 
 	pop_count = metrics::counter(pop_count_opts);
+
+	config::metrics::gauge receive_time_skew_opts;
+	receive_time_skew_opts.values.tags =
+		statistics::tag::max |
+		statistics::tag::moving_avg
+		;
+	receive_time_skew_opts.values.moving_interval = chrono::duration(1, chrono::time_unit::SEC);
+
+	receive_time_skew = metrics::gauge(receive_time_skew_opts);
 }
 
 void initialize() {
@@ -168,6 +181,29 @@ void push(node* n) {
 	}
 }
 
+// Clock is read once per batch of popped messages,
+// messages with unset timestamp (receive-time mode) are timestamped with batch's timestamp.
+// Batch ends on RECEIVE_BATCH_SIZE messages or when the queue is drained.
+static const size_t RECEIVE_BATCH_SIZE = 64;
+
+static chrono::time_point batch_timestamp;
+static size_t batch_size = 0;
+static bool batch_stamped = false;
+
+static void finish_batch() {
+	if (batch_stamped) {
+		// receive-time messages of the batch are timestamped at most that much earlier than actually processed
+		const auto& current_time = chrono::tsc_clock::now();
+		stats::receive_time_skew.set(
+				chrono::duration::convert_to(metrics::timer::value_unit, current_time - batch_timestamp).count(),
+				current_time
+			);
+	}
+
+	batch_size = 0;
+	batch_stamped = false;
+}
+
 events::event_message* pop() {
 	events::event_message* message = nullptr;
 
@@ -177,14 +213,33 @@ events::event_message* pop() {
 
 	if (message) {
 		--mq_size;
-		auto current_time = chrono::tsc_clock::now();
+
+		if (batch_size == 0) {
+			batch_timestamp = chrono::tsc_clock::now();
+		}
+		++batch_size;
+
+		const auto& current_time = batch_timestamp;
+
+		if (receive_time::is_unset(message->timestamp)) {
+			message->timestamp = current_time;
+			batch_stamped = true;
+		}
+
 		stats::size.set(size(), current_time);
 		stats::pop_count.increment(1, current_time);
 
+		// message could be timestamped after the batch has started
 		stats::message_wait_time.set(
-				chrono::duration::convert_to(metrics::timer::value_unit, current_time - message->timestamp).count(),
+				current_time > message->timestamp ?
+					chrono::duration::convert_to(metrics::timer::value_unit, current_time - message->timestamp).count() :
+					0,
 				current_time
 			);
+
+		if (batch_size >= RECEIVE_BATCH_SIZE || empty()) {
+			finish_batch();
+		}
 	}
 
 	return message;
@@ -204,6 +259,9 @@ void initialize() {
 		mq_size.store(0, std::memory_order_release);
 	}
 
+	batch_size = 0;
+	batch_stamped = false;
+
 	stats::initialize();
 }
 
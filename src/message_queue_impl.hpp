@@ -50,6 +50,7 @@ namespace stats {
 extern metrics::gauge size;
 extern metrics::gauge message_wait_time;
 extern metrics::counter pop_count;
+extern metrics::gauge receive_time_skew;
 
 void update(const chrono::time_point&);
 
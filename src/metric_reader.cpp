@@ -0,0 +1,102 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <mutex>
+#include <unordered_map>
+
+#include <handystats/metric_reader.hpp>
+
+#include "published_ptr_impl.hpp"
+#include "metrics_dump_impl.hpp"
+#include "metric_reader_impl.hpp"
+
+namespace handystats { namespace metrics_dump {
+
+struct metric_slot {
+	std::string name;
+	published_ptr<const dump_map::entry> entry;
+	// the last stored snapshot, accessed under readers_mutex only
+	dump_map::entry_ptr last;
+
+	explicit metric_slot(const std::string& name)
+		: name(name)
+		, entry()
+		, last()
+	{}
+};
+
+// slots are written under the mutex, so published_ptr has single writer at a time
+static std::mutex readers_mutex;
+static std::unordered_map<std::string, std::weak_ptr<metric_slot>> readers;
+
+static
+void store(metric_slot& target, const dump_map& dump) {
+	const auto& iter = dump.find(target.name);
+
+	dump_map::entry_ptr entry;
+	if (iter != dump.end()) {
+		entry = iter.entry();
+	}
+
+	if (entry != target.last) {
+		target.entry.store(entry);
+		target.last = entry;
+	}
+}
+
+void publish_readers(const dump_map& dump) {
+	std::lock_guard<std::mutex> lock(readers_mutex);
+
+	for (auto reader_iter = readers.begin(); reader_iter != readers.end(); ) {
+		const auto& target = reader_iter->second.lock();
+		if (!target) {
+			reader_iter = readers.erase(reader_iter);
+			continue;
+		}
+
+		store(*target, dump);
+		++reader_iter;
+	}
+}
+
+
+metric_reader::metric_reader(const std::string& name)
+	: m_slot()
+{
+	std::lock_guard<std::mutex> lock(readers_mutex);
+
+	auto& registered = readers[name];
+	std::shared_ptr<metric_slot> target = registered.lock();
+	if (!target) {
+		target = std::make_shared<metric_slot>(name);
+		// dumps published before the registration are not seen by publish_readers()
+		store(*target, *get_dump());
+		registered = target;
+	}
+
+	m_slot = target;
+}
+
+const std::string& metric_reader::name() const {
+	return m_slot->name;
+}
+
+dump_map::entry_ptr metric_reader::load() const {
+	return m_slot->entry.load();
+}
+
+}} // namespace handystats::metrics_dump
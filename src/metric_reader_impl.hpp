@@ -0,0 +1,31 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_METRIC_READER_IMPL_HPP_
+#define HANDYSTATS_METRIC_READER_IMPL_HPP_
+
+#include <handystats/metrics_dump.hpp>
+#include <handystats/metric_reader.hpp>
+
+namespace handystats { namespace metrics_dump {
+
+// Updates snapshots of all metric readers from the dump, called whenever new dump is published
+void publish_readers(const dump_map& dump);
+
+}} // namespace handystats::metrics_dump
+
+#endif // HANDYSTATS_METRIC_READER_IMPL_HPP_
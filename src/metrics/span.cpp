@@ -0,0 +1,48 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <handystats/metrics/span.hpp>
+
+namespace handystats { namespace metrics {
+
+const chrono::time_unit span::value_unit = chrono::time_unit::USEC;
+
+span::span(const config::metrics::timer& opts)
+	: m_inclusive(opts.values)
+	, m_self(opts.values)
+{
+}
+
+void span::set(const value_type& inclusive_measurement, const value_type& self_measurement, const time_point& timestamp) {
+	m_inclusive.update(chrono::duration::convert_to(value_unit, inclusive_measurement).count(), timestamp);
+	m_self.update(chrono::duration::convert_to(value_unit, self_measurement).count(), timestamp);
+}
+
+void span::update_statistics(const time_point& timestamp) {
+	m_inclusive.update_time(timestamp);
+	m_self.update_time(timestamp);
+}
+
+const statistics& span::inclusive() const {
+	return m_inclusive;
+}
+
+const statistics& span::self() const {
+	return m_self;
+}
+
+}} // namespace handystats::metrics
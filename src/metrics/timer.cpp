@@ -15,6 +15,9 @@
 * License along with this library.
 */
 
+
+#include <algorithm>
+
 #include <handystats/metrics/timer.hpp>
 
 namespace handystats { namespace metrics {
@@ -22,97 +25,458 @@ namespace handystats { namespace metrics {
 const timer::instance_id_type timer::DEFAULT_INSTANCE_ID = -1;
 const chrono::time_unit timer::value_unit = chrono::time_unit::USEC;
 
+const timer::slot_index_type timer::NIL_SLOT = -1;
+
+static const size_t MIN_INDEX_SIZE = 16;
+
+static
+inline uint64_t mix_instance_id(uint64_t instance_id) {
+	// murmur3 finalizer
+	instance_id ^= instance_id >> 33;
+	instance_id *= 0xff51afd7ed558ccdULL;
+	instance_id ^= instance_id >> 33;
+	instance_id *= 0xc4ceb9fe1a85ec53ULL;
+	instance_id ^= instance_id >> 33;
+	return instance_id;
+}
+
 timer::timer(
 		const config::metrics::timer& timer_opts
 	)
 	: m_idle_timeout(timer_opts.idle_timeout)
 	, m_values(timer_opts.values)
-	, m_idle_check_timestamp()
+	, m_slots()
+	, m_free_slot(NIL_SLOT)
+	, m_instances_count(0)
+	, m_index(MIN_INDEX_SIZE, NIL_SLOT)
+	, m_wheel(WHEEL_LEVELS * WHEEL_SLOTS, NIL_SLOT)
+	, m_wheel_occupancy(0)
+	, m_wheel_tick(0)
+	, m_wheel_tick_length(1)
+	, m_exemplars_size(timer_opts.exemplars)
+	, m_exemplars_interval(timer_opts.values.moving_interval)
+	, m_exemplars_bucket_start()
+	, m_exemplars_timestamp()
+	, m_exemplars_current()
+	, m_exemplars_previous()
 {
+	const int64_t idle_timeout_ticks = chrono::duration::convert_to(chrono::time_unit::TICK, m_idle_timeout).count();
+	m_wheel_tick_length = std::max<int64_t>(idle_timeout_ticks / WHEEL_SLOTS, 1);
 }
 
 void timer::start(const instance_id_type& instance_id, const time_point& timestamp) {
 	check_idle_timeout(timestamp);
 
-	auto& instance = m_instances[instance_id];
-	instance.start_timestamp = timestamp;
-	instance.heartbeat_timestamp = timestamp;
+	slot_index_type slot = find_slot(instance_id);
+	if (slot == NIL_SLOT) {
+		slot = acquire_slot(instance_id);
+		m_slots[slot].state.start_timestamp = timestamp;
+		m_slots[slot].state.heartbeat_timestamp = timestamp;
+		wheel_schedule(slot);
+	}
+	else {
+		// instance is rescheduled lazily when its current bucket fires
+		m_slots[slot].state.start_timestamp = timestamp;
+		m_slots[slot].state.heartbeat_timestamp = timestamp;
+	}
 }
 
 void timer::stop(const instance_id_type& instance_id, const time_point& timestamp) {
 	check_idle_timeout(timestamp);
 
-	auto instance = m_instances.find(instance_id);
-	if (instance == m_instances.end()) {
+	const slot_index_type slot = find_slot(instance_id);
+	if (slot == NIL_SLOT) {
 		return;
 	}
 
-	if (instance->second.expired(m_idle_timeout, timestamp)) {
-		m_instances.erase(instance);
-		return;
-	}
+	const instance_state& instance = m_slots[slot].state;
+	if (!instance.expired(m_idle_timeout, timestamp)) {
+		const auto& instance_value =
+			chrono::duration::convert_to(value_unit, timestamp - instance.start_timestamp);
 
-	const auto& instance_value =
-		chrono::duration::convert_to(value_unit, timestamp - instance->second.start_timestamp);
-
-	m_values.update(instance_value.count(), timestamp);
+		m_values.update(instance_value.count(), timestamp);
+		capture_exemplar(instance_value, instance_id, timestamp);
+	}
 
-	m_instances.erase(instance);
+	release_slot(slot);
 }
 
 void timer::heartbeat(const instance_id_type& instance_id, const time_point& timestamp) {
 	check_idle_timeout(timestamp);
 
-	auto instance = m_instances.find(instance_id);
-	if (instance == m_instances.end()) {
+	const slot_index_type slot = find_slot(instance_id);
+	if (slot == NIL_SLOT) {
 		return;
 	}
 
-	if (instance->second.expired(m_idle_timeout, timestamp)) {
-		m_instances.erase(instance);
+	if (m_slots[slot].state.expired(m_idle_timeout, timestamp)) {
+		release_slot(slot);
 		return;
 	}
 
-	instance->second.heartbeat_timestamp = timestamp;
+	// instance is rescheduled lazily when its current bucket fires
+	m_slots[slot].state.heartbeat_timestamp = timestamp;
 }
 
 void timer::discard(const instance_id_type& instance_id, const time_point& timestamp) {
 	check_idle_timeout(timestamp);
 
-	m_instances.erase(instance_id);
+	const slot_index_type slot = find_slot(instance_id);
+	if (slot != NIL_SLOT) {
+		release_slot(slot);
+	}
 }
 
-void timer::set(const value_type& measurement, const time_point& timestamp) {
-	m_values.update(chrono::duration::convert_to(value_unit, measurement).count(), timestamp);
+void timer::set(const value_type& measurement, const time_point& timestamp, const instance_id_type& instance_id) {
+	const auto& value = chrono::duration::convert_to(value_unit, measurement);
+
+	m_values.update(value.count(), timestamp);
+	capture_exemplar(value, instance_id, timestamp);
 }
 
 void timer::check_idle_timeout(const time_point& timestamp, const bool& force) {
 	if (!force) {
-		if (timestamp < m_idle_check_timestamp + m_idle_timeout) {
-			return;
-		}
+		wheel_advance(timestamp);
+		return;
 	}
 
-	for (auto instance = m_instances.begin(); instance != m_instances.end();) {
-		if (instance->second.expired(m_idle_timeout, timestamp)) {
-			instance = m_instances.erase(instance);
-		}
-		else {
-			++instance;
+	for (uint32_t bucket = 0; bucket < m_wheel.size(); ++bucket) {
+		slot_index_type slot = m_wheel[bucket];
+		while (slot != NIL_SLOT) {
+			const slot_index_type next_slot = m_slots[slot].next;
+			if (m_slots[slot].state.expired(m_idle_timeout, timestamp)) {
+				release_slot(slot);
+			}
+			slot = next_slot;
 		}
 	}
-
-	if (m_idle_check_timestamp < timestamp) {
-		m_idle_check_timestamp = timestamp;
-	}
 }
 
 void timer::update_statistics(const time_point& timestamp) {
 	m_values.update_time(timestamp);
+
+	if (m_exemplars_size > 0) {
+		rotate_exemplars(timestamp);
+	}
 }
 
 const statistics& timer::values() const {
 	return m_values;
 }
 
+size_t timer::instances_count() const {
+	return m_instances_count;
+}
+
+static
+inline bool exemplar_greater(const timer::exemplar& left, const timer::exemplar& right) {
+	return left.value > right.value;
+}
+
+std::vector<timer::exemplar> timer::exemplars() const {
+	std::vector<exemplar> exemplars;
+	exemplars.reserve(m_exemplars_current.size() + m_exemplars_previous.size());
+
+	const time_point& interval_start = m_exemplars_timestamp - m_exemplars_interval;
+	for (const auto& sample : m_exemplars_current) {
+		if (sample.timestamp >= interval_start) {
+			exemplars.push_back(sample);
+		}
+	}
+	for (const auto& sample : m_exemplars_previous) {
+		if (sample.timestamp >= interval_start) {
+			exemplars.push_back(sample);
+		}
+	}
+
+	std::sort(exemplars.begin(), exemplars.end(), exemplar_greater);
+	if (exemplars.size() > m_exemplars_size) {
+		exemplars.resize(m_exemplars_size);
+	}
+
+	return exemplars;
+}
+
+
+/*
+ * Exemplars
+ */
+void timer::capture_exemplar(const value_type& value, const instance_id_type& instance_id, const time_point& timestamp) {
+	if (m_exemplars_size == 0) {
+		return;
+	}
+
+	rotate_exemplars(timestamp);
+
+	if (m_exemplars_current.size() < m_exemplars_size) {
+		m_exemplars_current.push_back(exemplar{value, instance_id, timestamp});
+		std::push_heap(m_exemplars_current.begin(), m_exemplars_current.end(), exemplar_greater);
+	}
+	else if (value > m_exemplars_current.front().value) {
+		std::pop_heap(m_exemplars_current.begin(), m_exemplars_current.end(), exemplar_greater);
+		m_exemplars_current.back() = exemplar{value, instance_id, timestamp};
+		std::push_heap(m_exemplars_current.begin(), m_exemplars_current.end(), exemplar_greater);
+	}
+}
+
+void timer::rotate_exemplars(const time_point& timestamp) {
+	if (timestamp > m_exemplars_timestamp) {
+		m_exemplars_timestamp = timestamp;
+	}
+
+	if (timestamp < m_exemplars_bucket_start + m_exemplars_interval) {
+		return;
+	}
+
+	// previous bucket is kept while it overlaps with moving interval
+	if (timestamp < m_exemplars_bucket_start + m_exemplars_interval + m_exemplars_interval) {
+		m_exemplars_previous.swap(m_exemplars_current);
+	}
+	else {
+		m_exemplars_previous.clear();
+	}
+	m_exemplars_current.clear();
+
+	m_exemplars_bucket_start = timestamp;
+}
+
+
+/*
+ * Instances slab and index
+ */
+size_t timer::index_position(const instance_id_type& instance_id) const {
+	return mix_instance_id(instance_id) & (m_index.size() - 1);
+}
+
+timer::slot_index_type timer::find_slot(const instance_id_type& instance_id) const {
+	for (size_t position = index_position(instance_id); m_index[position] != NIL_SLOT;
+			position = (position + 1) & (m_index.size() - 1))
+	{
+		if (m_slots[m_index[position]].instance_id == instance_id) {
+			return m_index[position];
+		}
+	}
+
+	return NIL_SLOT;
+}
+
+void timer::rebuild_index(const size_t& index_size) {
+	m_index.assign(index_size, NIL_SLOT);
+
+	for (uint32_t bucket = 0; bucket < m_wheel.size(); ++bucket) {
+		for (slot_index_type slot = m_wheel[bucket]; slot != NIL_SLOT; slot = m_slots[slot].next) {
+			size_t position = index_position(m_slots[slot].instance_id);
+			while (m_index[position] != NIL_SLOT) {
+				position = (position + 1) & (m_index.size() - 1);
+			}
+			m_index[position] = slot;
+		}
+	}
+}
+
+timer::slot_index_type timer::acquire_slot(const instance_id_type& instance_id) {
+	// keep load factor of the index below 1/2
+	if (2 * (m_instances_count + 1) > m_index.size()) {
+		rebuild_index(2 * m_index.size());
+	}
+
+	slot_index_type slot = m_free_slot;
+	if (slot != NIL_SLOT) {
+		m_free_slot = m_slots[slot].next;
+	}
+	else {
+		slot = m_slots.size();
+		m_slots.push_back(instance_slot());
+	}
+
+	m_slots[slot].instance_id = instance_id;
+	m_slots[slot].state = instance_state();
+	m_slots[slot].prev = NIL_SLOT;
+	m_slots[slot].next = NIL_SLOT;
+
+	size_t position = index_position(instance_id);
+	while (m_index[position] != NIL_SLOT) {
+		position = (position + 1) & (m_index.size() - 1);
+	}
+	m_index[position] = slot;
+
+	++m_instances_count;
+
+	return slot;
+}
+
+void timer::release_slot(const slot_index_type& slot) {
+	wheel_unlink(slot);
+
+	// remove from the index with backward shift of the following probe sequence
+	const size_t mask = m_index.size() - 1;
+	size_t position = index_position(m_slots[slot].instance_id);
+	while (m_index[position] != slot) {
+		position = (position + 1) & mask;
+	}
+
+	size_t next_position = (position + 1) & mask;
+	while (m_index[next_position] != NIL_SLOT) {
+		const size_t home_position = index_position(m_slots[m_index[next_position]].instance_id);
+		// entry could be moved to the hole if its home position is not in (hole, next_position]
+		if (((next_position - home_position) & mask) >= ((next_position - position) & mask)) {
+			m_index[position] = m_index[next_position];
+			position = next_position;
+		}
+		next_position = (next_position + 1) & mask;
+	}
+	m_index[position] = NIL_SLOT;
+
+	m_slots[slot].next = m_free_slot;
+	m_free_slot = slot;
+
+	--m_instances_count;
+}
+
+
+/*
+ * Timing wheel
+ */
+int64_t timer::wheel_tick(const time_point& timestamp) const {
+	const chrono::duration& since_epoch =
+		time_point::convert_to(chrono::clock_type::TSC, timestamp).time_since_epoch();
+
+	return chrono::duration::convert_to(chrono::time_unit::TICK, since_epoch).count() / m_wheel_tick_length;
+}
+
+void timer::wheel_link(const slot_index_type& slot, const uint32_t& bucket) {
+	instance_slot& instance = m_slots[slot];
+
+	instance.bucket = bucket;
+	instance.prev = NIL_SLOT;
+	instance.next = m_wheel[bucket];
+	if (instance.next != NIL_SLOT) {
+		m_slots[instance.next].prev = slot;
+	}
+	m_wheel[bucket] = slot;
+
+	if (bucket < WHEEL_SLOTS) {
+		m_wheel_occupancy |= uint64_t(1) << bucket;
+	}
+}
+
+void timer::wheel_unlink(const slot_index_type& slot) {
+	instance_slot& instance = m_slots[slot];
+
+	if (instance.prev != NIL_SLOT) {
+		m_slots[instance.prev].next = instance.next;
+	}
+	else {
+		m_wheel[instance.bucket] = instance.next;
+		if (instance.next == NIL_SLOT && instance.bucket < WHEEL_SLOTS) {
+			m_wheel_occupancy &= ~(uint64_t(1) << instance.bucket);
+		}
+	}
+
+	if (instance.next != NIL_SLOT) {
+		m_slots[instance.next].prev = instance.prev;
+	}
+
+	instance.prev = NIL_SLOT;
+	instance.next = NIL_SLOT;
+}
+
+void timer::wheel_schedule(const slot_index_type& slot) {
+	const instance_state& instance = m_slots[slot].state;
+
+	// bucket should fire strictly after idle timeout is passed
+	const int64_t expiry_tick = std::max(wheel_tick(instance.heartbeat_timestamp + m_idle_timeout) + 1, m_wheel_tick + 1);
+
+	for (size_t level = 0; level < WHEEL_LEVELS; ++level) {
+		const size_t level_shift = WHEEL_SLOT_BITS * level;
+		// instance is placed on the lowest level which covers distance to the expiry
+		if (((expiry_tick ^ m_wheel_tick) >> (level_shift + WHEEL_SLOT_BITS)) == 0 || level + 1 == WHEEL_LEVELS) {
+			const size_t wheel_slot = (expiry_tick >> level_shift) & (WHEEL_SLOTS - 1);
+			wheel_link(slot, level * WHEEL_SLOTS + wheel_slot);
+			return;
+		}
+	}
+}
+
+void timer::wheel_expire(slot_index_type slot, const time_point& timestamp) {
+	// bucket's entries are either expired or rescheduled according to the last heartbeat
+	while (slot != NIL_SLOT) {
+		const slot_index_type next_slot = m_slots[slot].next;
+
+		if (m_slots[slot].state.expired(m_idle_timeout, timestamp)) {
+			release_slot(slot);
+		}
+		else {
+			wheel_unlink(slot);
+			wheel_schedule(slot);
+		}
+
+		slot = next_slot;
+	}
+}
+
+void timer::wheel_advance(const time_point& timestamp) {
+	const int64_t target_tick = wheel_tick(timestamp);
+
+	if (m_instances_count == 0) {
+		m_wheel_tick = std::max(m_wheel_tick, target_tick);
+		return;
+	}
+
+	if (target_tick - m_wheel_tick >= int64_t(1) << (WHEEL_SLOT_BITS * WHEEL_LEVELS)) {
+		// the whole wheel has passed
+		m_wheel_tick = target_tick;
+		check_idle_timeout(timestamp, true);
+
+		std::vector<slot_index_type> pending;
+		pending.reserve(m_instances_count);
+		for (uint32_t bucket = 0; bucket < m_wheel.size(); ++bucket) {
+			for (slot_index_type slot = m_wheel[bucket]; slot != NIL_SLOT; slot = m_slots[slot].next) {
+				pending.push_back(slot);
+			}
+		}
+		for (auto slot_iter = pending.begin(); slot_iter != pending.end(); ++slot_iter) {
+			wheel_unlink(*slot_iter);
+			wheel_schedule(*slot_iter);
+		}
+		return;
+	}
+
+	while (m_wheel_tick < target_tick) {
+		const size_t current_slot = m_wheel_tick & (WHEEL_SLOTS - 1);
+		if (current_slot + 1 < WHEEL_SLOTS && (m_wheel_occupancy >> (current_slot + 1)) == 0) {
+			// skip empty buckets up to the end of the first level rotation
+			m_wheel_tick = std::min(target_tick, m_wheel_tick + int64_t(WHEEL_SLOTS - 1 - current_slot));
+			if (m_wheel_tick == target_tick) {
+				break;
+			}
+		}
+
+		++m_wheel_tick;
+
+		// cascade upper levels on their rotation boundaries
+		for (size_t level = WHEEL_LEVELS - 1; level > 0; --level) {
+			const size_t level_shift = WHEEL_SLOT_BITS * level;
+			if ((m_wheel_tick & ((int64_t(1) << level_shift) - 1)) == 0) {
+				const uint32_t bucket = level * WHEEL_SLOTS + ((m_wheel_tick >> level_shift) & (WHEEL_SLOTS - 1));
+				const slot_index_type slot = m_wheel[bucket];
+				m_wheel[bucket] = NIL_SLOT;
+
+				for (slot_index_type cascaded = slot; cascaded != NIL_SLOT;) {
+					const slot_index_type next_slot = m_slots[cascaded].next;
+					m_slots[cascaded].prev = NIL_SLOT;
+					m_slots[cascaded].next = NIL_SLOT;
+					wheel_schedule(cascaded);
+					cascaded = next_slot;
+				}
+			}
+		}
+
+		const uint32_t bucket = m_wheel_tick & (WHEEL_SLOTS - 1);
+		if (m_wheel[bucket] != NIL_SLOT) {
+			wheel_expire(m_wheel[bucket], timestamp);
+		}
+	}
+}
+
 }} // namespace handystats::metrics
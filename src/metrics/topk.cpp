@@ -0,0 +1,202 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <algorithm>
+
+#include <handystats/metrics/topk.hpp>
+
+
+namespace handystats { namespace metrics {
+
+topk::topk(const config::metrics::topk& opts)
+	: m_capacity(std::max<size_t>(opts.capacity, 1))
+	, m_size(opts.size)
+	, m_entries()
+	, m_index()
+	, m_total(0)
+	, m_timestamp()
+{
+	m_entries.reserve(m_capacity);
+	m_index.reserve(m_capacity);
+}
+
+topk::value_type topk::min_count() const {
+	// keys that are not tracked might have weight up to the minimal tracked count
+	if (m_entries.size() < m_capacity) {
+		return 0;
+	}
+
+	return m_entries.front().count;
+}
+
+void topk::swap_entries(const size_t& first, const size_t& second) {
+	std::swap(m_entries[first], m_entries[second]);
+	m_index[m_entries[first].key] = first;
+	m_index[m_entries[second].key] = second;
+}
+
+void topk::sift_down(size_t index) {
+	while (true) {
+		const size_t left = 2 * index + 1;
+		const size_t right = left + 1;
+		size_t smallest = index;
+
+		if (left < m_entries.size() && m_entries[left].count < m_entries[smallest].count) {
+			smallest = left;
+		}
+		if (right < m_entries.size() && m_entries[right].count < m_entries[smallest].count) {
+			smallest = right;
+		}
+
+		if (smallest == index) {
+			return;
+		}
+
+		swap_entries(index, smallest);
+		index = smallest;
+	}
+}
+
+void topk::sift_up(size_t index) {
+	while (index > 0) {
+		const size_t parent = (index - 1) / 2;
+		if (!(m_entries[index].count < m_entries[parent].count)) {
+			return;
+		}
+
+		swap_entries(index, parent);
+		index = parent;
+	}
+}
+
+void topk::add(const key_type& key, const value_type& weight, const time_point& timestamp) {
+	// Space-Saving bounds hold for positive weights only, decreased count would also break the min-heap
+	if (!(weight > 0)) {
+		return;
+	}
+
+	m_total += weight;
+
+	if (m_timestamp < timestamp) {
+		m_timestamp = timestamp;
+	}
+
+	auto index_iter = m_index.find(key);
+	if (index_iter != m_index.end()) {
+		const size_t index = index_iter->second;
+		m_entries[index].count += weight;
+		sift_down(index);
+		return;
+	}
+
+	if (m_entries.size() < m_capacity) {
+		m_entries.push_back(entry{key, weight, 0});
+		m_index[key] = m_entries.size() - 1;
+		sift_up(m_entries.size() - 1);
+		return;
+	}
+
+	// replace entry with the minimal count
+	entry& min_entry = m_entries.front();
+	m_index.erase(min_entry.key);
+
+	min_entry.error = min_entry.count;
+	min_entry.count += weight;
+	min_entry.key = key;
+	m_index[key] = 0;
+
+	sift_down(0);
+}
+
+void topk::update_statistics(const time_point& timestamp) {
+	if (m_timestamp < timestamp) {
+		m_timestamp = timestamp;
+	}
+}
+
+void topk::merge(const topk& other) {
+	const value_type this_min_count = min_count();
+	const value_type other_min_count = other.min_count();
+
+	entries_type merged;
+	merged.reserve(m_entries.size() + other.m_entries.size());
+
+	for (auto entry_iter = m_entries.begin(); entry_iter != m_entries.end(); ++entry_iter) {
+		auto other_iter = other.m_index.find(entry_iter->key);
+		if (other_iter != other.m_index.end()) {
+			const entry& other_entry = other.m_entries[other_iter->second];
+			merged.push_back(entry{entry_iter->key, entry_iter->count + other_entry.count, entry_iter->error + other_entry.error});
+		}
+		else {
+			merged.push_back(entry{entry_iter->key, entry_iter->count + other_min_count, entry_iter->error + other_min_count});
+		}
+	}
+
+	for (auto entry_iter = other.m_entries.begin(); entry_iter != other.m_entries.end(); ++entry_iter) {
+		if (m_index.find(entry_iter->key) == m_index.end()) {
+			merged.push_back(entry{entry_iter->key, entry_iter->count + this_min_count, entry_iter->error + this_min_count});
+		}
+	}
+
+	if (merged.size() > m_capacity) {
+		std::nth_element(merged.begin(), merged.begin() + m_capacity, merged.end(),
+				[] (const entry& left, const entry& right) {
+					return left.count > right.count;
+				}
+			);
+		merged.resize(m_capacity);
+	}
+
+	m_entries.swap(merged);
+	m_index.clear();
+	for (size_t index = 0; index < m_entries.size(); ++index) {
+		m_index[m_entries[index].key] = index;
+	}
+	for (size_t index = m_entries.size() / 2; index-- > 0;) {
+		sift_down(index);
+	}
+
+	m_total += other.m_total;
+
+	if (m_timestamp < other.m_timestamp) {
+		m_timestamp = other.m_timestamp;
+	}
+}
+
+topk::entries_type topk::top() const {
+	entries_type top_entries(m_entries);
+
+	const size_t top_size = std::min(m_size, top_entries.size());
+	std::partial_sort(top_entries.begin(), top_entries.begin() + top_size, top_entries.end(),
+			[] (const entry& left, const entry& right) {
+				return left.count > right.count;
+			}
+		);
+	top_entries.resize(top_size);
+
+	return top_entries;
+}
+
+topk::value_type topk::total() const {
+	return m_total;
+}
+
+topk::time_point topk::timestamp() const {
+	return m_timestamp;
+}
+
+}} // namespace handystats::metrics
@@ -0,0 +1,229 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <cmath>
+#include <algorithm>
+
+#include <handystats/metrics/unique.hpp>
+
+
+namespace handystats { namespace metrics {
+
+const size_t unique::MIN_PRECISION;
+const size_t unique::MAX_PRECISION;
+const size_t unique::INTERVAL_SLICES;
+const size_t unique::SLOTS;
+
+// finalization mix of MurmurHash3
+// spreads poorly distributed keys (e.g. sequential ids) over the whole range
+static inline
+uint64_t mix_hash(uint64_t hash) {
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ULL;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+// HyperLogLog estimation over register-wise maximum of several sketches
+static
+double estimate_cardinality(const uint8_t* const registers, const size_t& registers_count,
+		const size_t& sketches_count, const size_t& sketch_stride
+	)
+{
+	double harmonic_sum = 0;
+	size_t zero_registers = 0;
+
+	for (size_t index = 0; index < registers_count; ++index) {
+		uint8_t rank = 0;
+		for (size_t sketch = 0; sketch < sketches_count; ++sketch) {
+			rank = std::max(rank, registers[sketch * sketch_stride + index]);
+		}
+
+		harmonic_sum += std::ldexp(1.0, -int(rank));
+		if (rank == 0) {
+			++zero_registers;
+		}
+	}
+
+	const double m = registers_count;
+	double alpha = 0.7213 / (1.0 + 1.079 / m);
+	if (registers_count == 16) {
+		alpha = 0.673;
+	}
+	else if (registers_count == 32) {
+		alpha = 0.697;
+	}
+	else if (registers_count == 64) {
+		alpha = 0.709;
+	}
+
+	const double raw_estimate = alpha * m * m / harmonic_sum;
+
+	// small range correction (linear counting)
+	if (raw_estimate <= 2.5 * m && zero_registers > 0) {
+		return m * std::log(m / zero_registers);
+	}
+
+	return raw_estimate;
+}
+
+unique::unique(const config::metrics::unique& opts)
+	: m_precision(std::min(std::max(opts.precision, MIN_PRECISION), MAX_PRECISION))
+	, m_moving_interval(opts.moving_interval)
+	, m_slice_span(opts.moving_interval / INTERVAL_SLICES)
+	, m_registers((SLOTS + 1) << m_precision, 0)
+	, m_slice_index(0)
+	, m_timestamp()
+{
+}
+
+size_t unique::registers_count() const {
+	return size_t(1) << m_precision;
+}
+
+int64_t unique::slice_index(const time_point& timestamp) {
+	const auto& since_epoch = timestamp.time_since_epoch();
+
+	if (since_epoch.unit() != m_slice_span.unit()) {
+		m_slice_span = chrono::duration::convert_to(since_epoch.unit(), m_moving_interval) / INTERVAL_SLICES;
+	}
+
+	if (m_slice_span.count() <= 0) {
+		return since_epoch.count();
+	}
+
+	return since_epoch.count() / m_slice_span.count();
+}
+
+void unique::shift_slices(const int64_t& new_slice_index) {
+	if (new_slice_index <= m_slice_index) {
+		return;
+	}
+
+	const int64_t cleared_slices = std::min<int64_t>(new_slice_index - m_slice_index, SLOTS);
+	for (int64_t index = new_slice_index - cleared_slices + 1; index <= new_slice_index; ++index) {
+		uint8_t* slot_registers = m_registers.data() + (index % SLOTS) * registers_count();
+		std::fill(slot_registers, slot_registers + registers_count(), 0);
+	}
+
+	m_slice_index = new_slice_index;
+}
+
+void unique::add(const value_type& hash, const time_point& timestamp) {
+	const uint64_t mixed_hash = mix_hash(hash);
+
+	// register index -- first precision bits of the hash
+	// rank -- position of the leftmost 1-bit among the rest bits
+	const size_t register_index = mixed_hash >> (64 - m_precision);
+	const uint64_t rest_bits = (mixed_hash << m_precision) | (uint64_t(1) << (m_precision - 1));
+	const uint8_t rank = __builtin_clzll(rest_bits) + 1;
+
+	uint8_t& total_register = m_registers[SLOTS * registers_count() + register_index];
+	total_register = std::max(total_register, rank);
+
+	const int64_t timestamp_slice = slice_index(timestamp);
+	if (m_timestamp == time_point()) {
+		m_slice_index = timestamp_slice;
+	}
+	shift_slices(timestamp_slice);
+
+	// data older than moving interval contributes to total only
+	if (timestamp_slice > m_slice_index - int64_t(SLOTS)) {
+		uint8_t& slot_register = m_registers[(timestamp_slice % SLOTS) * registers_count() + register_index];
+		slot_register = std::max(slot_register, rank);
+	}
+
+	if (m_timestamp < timestamp) {
+		m_timestamp = timestamp;
+	}
+}
+
+void unique::update_statistics(const time_point& timestamp) {
+	if (m_timestamp == time_point()) {
+		return;
+	}
+
+	shift_slices(slice_index(timestamp));
+
+	if (m_timestamp < timestamp) {
+		m_timestamp = timestamp;
+	}
+}
+
+void unique::merge(const unique& other) {
+	if (m_precision != other.m_precision || m_moving_interval != other.m_moving_interval) {
+		throw incompatible_error("unique::merge: incompatible configuration");
+	}
+
+	if (other.m_timestamp == time_point()) {
+		return;
+	}
+
+	if (m_timestamp == time_point()) {
+		*this = other;
+		return;
+	}
+
+	unique aligned(other);
+
+	const time_point timestamp = std::max(m_timestamp, aligned.m_timestamp);
+	update_statistics(timestamp);
+	aligned.update_statistics(timestamp);
+
+	// both metrics share slices' layout once aligned to the same timestamp
+	const size_t stride = registers_count();
+	if (aligned.m_slice_span.unit() != m_slice_span.unit() || aligned.m_slice_index != m_slice_index) {
+		// timestamps are in different units, merge moving interval into the current slice only
+		uint8_t* current_slot = m_registers.data() + (m_slice_index % SLOTS) * stride;
+		for (size_t slot = 0; slot < SLOTS; ++slot) {
+			const uint8_t* other_slot = aligned.m_registers.data() + slot * stride;
+			for (size_t index = 0; index < stride; ++index) {
+				current_slot[index] = std::max(current_slot[index], other_slot[index]);
+			}
+		}
+		const uint8_t* other_total = aligned.m_registers.data() + SLOTS * stride;
+		uint8_t* total = m_registers.data() + SLOTS * stride;
+		for (size_t index = 0; index < stride; ++index) {
+			total[index] = std::max(total[index], other_total[index]);
+		}
+	}
+	else {
+		for (size_t index = 0; index < m_registers.size(); ++index) {
+			m_registers[index] = std::max(m_registers[index], aligned.m_registers[index]);
+		}
+	}
+}
+
+double unique::estimate() const {
+	return estimate_cardinality(m_registers.data(), registers_count(), SLOTS, registers_count());
+}
+
+double unique::total() const {
+	return estimate_cardinality(m_registers.data() + SLOTS * registers_count(), registers_count(), 1, 0);
+}
+
+size_t unique::precision() const {
+	return m_precision;
+}
+
+unique::time_point unique::timestamp() const {
+	return m_timestamp;
+}
+
+}} // namespace handystats::metrics
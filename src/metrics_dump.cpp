@@ -16,8 +16,15 @@
 */
 
 #include <mutex>
+#include <condition_variable>
+#include <thread>
 #include <string>
-#include <map>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+
+#include <sys/prctl.h>
 
 #include <handystats/chrono.hpp>
 #include <handystats/metrics_dump.hpp>
@@ -26,6 +33,9 @@
 #include "message_queue_impl.hpp"
 
 #include "config_impl.hpp"
+#include "published_ptr_impl.hpp"
+#include "metric_reader_impl.hpp"
+#include "shared_dump_impl.hpp"
 
 #include "metrics_dump_impl.hpp"
 
@@ -36,9 +46,10 @@ namespace handystats { namespace metrics_dump {
 namespace stats {
 
 metrics::gauge dump_time;
+metrics::gauge system_time_drift;
 
 void update(const chrono::time_point& timestamp) {
-	dump_time.update_statistics(timestamp);
+	system_time_drift.update_statistics(timestamp);
 }
 
 static void reset() {
@@ -47,6 +58,13 @@ static void reset() {
 	dump_time_opts.values.moving_interval = chrono::duration(1, chrono::time_unit::SEC);
 
 	dump_time = metrics::gauge(dump_time_opts);
+
+	config::metrics::gauge system_time_drift_opts;
+	system_time_drift_opts.values.tags =
+		statistics::tag::value | statistics::tag::min | statistics::tag::max | statistics::tag::moving_avg;
+	system_time_drift_opts.values.moving_interval = chrono::duration(1, chrono::time_unit::MIN);
+
+	system_time_drift = metrics::gauge(system_time_drift_opts);
 }
 
 void initialize() {
@@ -61,121 +79,163 @@ void finalize() {
 
 
 chrono::time_point dump_timestamp;
-std::mutex dump_mutex;
 
-std::shared_ptr<const std::map<std::string, metrics::metric_variant>> dump(new std::map<std::string, metrics::metric_variant>());
+// version (epoch) of the last snapshots taken by the processor
+// versions are never reset, so the version identifies the dump within the process
+uint64_t dump_version = 0;
+
+// last assembled dump, accessed by the dump thread only
+static std::shared_ptr<const dump_map> dump(new dump_map());
 
-const std::shared_ptr<const std::map<std::string, metrics::metric_variant>>
+// readers never lock, so frequent polling of the dump doesn't interfere with its publication
+static published_ptr<const dump_map> published_dump(dump);
+
+const std::shared_ptr<const dump_map>
 get_dump()
 {
-	std::lock_guard<std::mutex> lock(dump_mutex);
-	return dump;
+	return published_dump.load();
 }
 
+// waiters for the new dump
+static std::mutex publish_mutex;
+static std::condition_variable publish_cv;
+
 static
-std::shared_ptr<const std::map<std::string, metrics::metric_variant>>
-create_dump()
+void publish(const std::shared_ptr<const dump_map>& new_dump) {
+	published_dump.store(new_dump);
+	publish_readers(*new_dump);
+
+	{
+		std::lock_guard<std::mutex> lock(publish_mutex);
+	}
+	publish_cv.notify_all();
+}
+
+const std::shared_ptr<const dump_map>
+wait_dump(const uint64_t& version, const chrono::duration& timeout)
 {
-	auto dump_start_time = chrono::tsc_clock::now();
+	auto current_dump = get_dump();
+	if (current_dump->version() != version) {
+		return current_dump;
+	}
+
+	const auto& deadline =
+		std::chrono::steady_clock::now() +
+		std::chrono::nanoseconds(chrono::duration::convert_to(chrono::time_unit::NSEC, timeout).count());
+
+	std::unique_lock<std::mutex> lock(publish_mutex);
+	publish_cv.wait_until(lock, deadline,
+			[&current_dump, &version] () {
+				current_dump = get_dump();
+				return current_dump->version() != version;
+			}
+		);
+
+	return current_dump;
+}
+
+/*
+ * Snapshots taken by the processor are passed to the dump thread,
+ * which assembles new dump and publishes it.
+ * If the dump thread falls behind, pending snapshots are coalesced.
+ */
+static std::thread dump_thread;
+static std::mutex pending_mutex;
+static std::condition_variable pending_cv;
+static std::vector<dump_map::entry_ptr> pending_entries;
+static uint64_t pending_version = 0;
+static bool dump_thread_stop = false;
 
-	std::shared_ptr<std::map<std::string, metrics::metric_variant>> new_dump(new std::map<std::string, metrics::metric_variant>());
+static
+void add_entry(std::vector<dump_map::entry_ptr>& entries,
+		const std::string& name, const metrics::metric_variant& metric
+	)
+{
+	entries.push_back(std::make_shared<const dump_map::entry>(name, metric, dump_version));
+}
 
-	for (auto metric_iter = internal::metrics_map.cbegin(); metric_iter != internal::metrics_map.cend(); ++metric_iter) {
-		switch (metric_iter->second.which()) {
+static
+bool entry_name_less(const dump_map::entry_ptr& left, const dump_map::entry_ptr& right) {
+	return left->value.first < right->value.first;
+}
+
+static
+bool entry_name_equal(const dump_map::entry_ptr& left, const dump_map::entry_ptr& right) {
+	return left->value.first == right->value.first;
+}
+
+// snapshots of changed metrics sorted by name
+static
+std::vector<dump_map::entry_ptr>
+take_snapshots()
+{
+	++dump_version;
+
+	// only snapshots of active metrics are taken, others are shared with the previous dump
+	std::vector<dump_map::entry_ptr> changed;
+	changed.reserve(internal::active_metrics.size() + 16);
+
+	for (auto metric_iter = internal::active_metrics.cbegin(); metric_iter != internal::active_metrics.cend(); ++metric_iter) {
+		const auto& name = (*metric_iter)->first;
+		const auto& metric_ptr = (*metric_iter)->second.metric;
+
+		switch (metric_ptr.which()) {
 			case metrics::metric_index::GAUGE:
 				{
-					const auto& metric = *boost::get<metrics::gauge*>(metric_iter->second);
+					const auto& metric = *boost::get<metrics::gauge*>(metric_ptr);
 					if (metric.values().tags() != statistics::tag::empty) {
-						new_dump->insert(
-								std::pair<std::string, metrics::metric_variant>(
-									metric_iter->first,
-									metric
-								)
-							);
+						add_entry(changed, name, metric);
 					}
 					break;
 				}
 			case metrics::metric_index::COUNTER:
 				{
-					const auto& metric = *boost::get<metrics::counter*>(metric_iter->second);
+					const auto& metric = *boost::get<metrics::counter*>(metric_ptr);
 					if (metric.values().tags() != statistics::tag::empty) {
-						new_dump->insert(
-								std::pair<std::string, metrics::metric_variant>(
-									metric_iter->first,
-									metric
-								)
-							);
+						add_entry(changed, name, metric);
 					}
 					break;
 				}
 			case metrics::metric_index::TIMER:
 				{
-					const auto& metric = *boost::get<metrics::timer*>(metric_iter->second);
+					const auto& metric = *boost::get<metrics::timer*>(metric_ptr);
 					if (metric.values().tags() != statistics::tag::empty) {
-						new_dump->insert(
-								std::pair<std::string, metrics::metric_variant>(
-									metric_iter->first,
-									metric
-								)
-							);
+						add_entry(changed, name, metric);
 					}
 					break;
 				}
 			case metrics::metric_index::ATTRIBUTE:
-				{
-					new_dump->insert(
-							std::pair<std::string, metrics::metric_variant>(
-								metric_iter->first,
-								*boost::get<metrics::attribute*>(metric_iter->second)
-							)
-						);
-					break;
-				}
+				add_entry(changed, name, *boost::get<metrics::attribute*>(metric_ptr));
+				break;
+			case metrics::metric_index::UNIQUE:
+				add_entry(changed, name, *boost::get<metrics::unique*>(metric_ptr));
+				break;
+			case metrics::metric_index::TOPK:
+				add_entry(changed, name, *boost::get<metrics::topk*>(metric_ptr));
+				break;
+			case metrics::metric_index::SPAN:
+				add_entry(changed, name, *boost::get<metrics::span*>(metric_ptr));
+				break;
 		}
 	}
 
+	// user's metrics take precedence over handystats' statistics with the same name
+	const size_t metrics_count = changed.size();
+
 	// handystats' statistics
 	{
 		// internal
-		{
-			new_dump->insert(
-					std::pair<std::string, metrics::metric_variant>(
-						"handystats.internal.size",
-						internal::stats::size
-						)
-					);
-
-			new_dump->insert(
-					std::pair<std::string, metrics::metric_variant>(
-						"handystats.internal.process_time",
-						internal::stats::process_time
-						)
-					);
-		}
+		add_entry(changed, "handystats.internal.size", internal::stats::size);
+		add_entry(changed, "handystats.internal.process_time", internal::stats::process_time);
 
 		// message queue
-		{
-			new_dump->insert(
-					std::pair<std::string, metrics::metric_variant>(
-						"handystats.message_queue.size",
-						message_queue::stats::size
-						)
-					);
-
-			new_dump->insert(
-					std::pair<std::string, metrics::metric_variant>(
-						"handystats.message_queue.message_wait_time",
-						message_queue::stats::message_wait_time
-						)
-					);
-
-			new_dump->insert(
-					std::pair<std::string, metrics::metric_variant>(
-						"handystats.message_queue.pop_count",
-						message_queue::stats::pop_count
-						)
-					);
-		}
+		add_entry(changed, "handystats.message_queue.size", message_queue::stats::size);
+		add_entry(changed, "handystats.message_queue.message_wait_time", message_queue::stats::message_wait_time);
+		add_entry(changed, "handystats.message_queue.pop_count", message_queue::stats::pop_count);
+		add_entry(changed, "handystats.message_queue.receive_time_skew", message_queue::stats::receive_time_skew);
+
+		// chrono
+		add_entry(changed, "handystats.chrono.system_time_drift", stats::system_time_drift);
 
 		// metrics_dump.dump_time will be added later
 	}
@@ -189,16 +249,10 @@ create_dump()
 				chrono::duration::convert_to(chrono::time_unit::MSEC, dump_interval).count()
 			);
 
-		new_dump->insert(
-				std::pair<std::string, metrics::metric_variant>(
-					"handystats.config.dump_interval",
-					dump_interval_attr
-					)
-				);
+		add_entry(changed, "handystats.config.dump_interval", dump_interval_attr);
 	}
 
 	{
-		// NOTE: possible call chrono::system_clock::now()
 		chrono::time_point system_timestamp =
 			chrono::time_point::convert_to(chrono::clock_type::SYSTEM, chrono::tsc_clock::now());
 
@@ -207,31 +261,111 @@ create_dump()
 				chrono::duration::convert_to(chrono::time_unit::MSEC, system_timestamp.time_since_epoch()).count()
 			);
 
-		new_dump->insert(
-				std::pair<std::string, metrics::metric_variant>(
-					"handystats.dump_timestamp",
-					timestamp_attr
-					)
-				);
+		add_entry(changed, "handystats.dump_timestamp", timestamp_attr);
 	}
 
+	std::sort(changed.begin(), changed.begin() + metrics_count, entry_name_less);
+	std::sort(changed.begin() + metrics_count, changed.end(), entry_name_less);
+	std::inplace_merge(changed.begin(), changed.begin() + metrics_count, changed.end(), entry_name_less);
+	changed.erase(std::unique(changed.begin(), changed.end(), entry_name_equal), changed.end());
+
+	return changed;
+}
+
+// merges sorted snapshots, newer ones take precedence
+static
+void merge_snapshots(std::vector<dump_map::entry_ptr>& older, const std::vector<dump_map::entry_ptr>& newer) {
+	std::vector<dump_map::entry_ptr> merged;
+	merged.reserve(older.size() + newer.size());
+
+	auto older_iter = older.cbegin();
+	auto newer_iter = newer.cbegin();
+	while (older_iter != older.cend() || newer_iter != newer.cend()) {
+		if (newer_iter == newer.cend() ||
+				(older_iter != older.cend() && entry_name_less(*older_iter, *newer_iter))
+			)
+		{
+			merged.push_back(*older_iter++);
+		}
+		else {
+			if (older_iter != older.cend() && entry_name_equal(*older_iter, *newer_iter)) {
+				++older_iter;
+			}
+			merged.push_back(*newer_iter++);
+		}
+	}
+
+	older.swap(merged);
+}
+
+static
+void publish_snapshots(std::vector<dump_map::entry_ptr>&& snapshots, const uint64_t& version) {
+	{
+		std::lock_guard<std::mutex> lock(pending_mutex);
+		if (pending_entries.empty()) {
+			pending_entries.swap(snapshots);
+		}
+		else {
+			merge_snapshots(pending_entries, snapshots);
+		}
+		pending_version = version;
+	}
+	pending_cv.notify_one();
+}
+
+static
+void create_dump(const std::vector<dump_map::entry_ptr>& snapshots, const uint64_t& version) {
+	auto dump_start_time = chrono::tsc_clock::now();
+
+	const dump_map& new_dump = dump->update(snapshots, std::vector<std::string>(), version);
+
 	auto dump_end_time = chrono::tsc_clock::now();
 
+	stats::dump_time.update_statistics(dump_end_time);
 	stats::dump_time.set(
 			chrono::duration::convert_to(metrics::timer::value_unit, dump_end_time - dump_start_time).count(),
 			dump_end_time
 		);
 
-	{
-		new_dump->insert(
-				std::pair<std::string, metrics::metric_variant>(
-					"handystats.metrics_dump.dump_time",
-					stats::dump_time
-					)
-				);
-	}
+	std::vector<dump_map::entry_ptr> dump_time_entry;
+	dump_time_entry.push_back(
+			std::make_shared<const dump_map::entry>("handystats.metrics_dump.dump_time", stats::dump_time, version)
+		);
+
+	dump = std::make_shared<const dump_map>(new_dump.update(dump_time_entry, std::vector<std::string>(), version));
+	publish(dump);
 
-	return std::const_pointer_cast<const std::map<std::string, metrics::metric_variant>>(new_dump);
+	shared_dump::publish(*dump);
+}
+
+static void run_dump_thread() noexcept {
+	char thread_name[16];
+	memset(thread_name, 0, sizeof(thread_name));
+
+	sprintf(thread_name, "handystats-dump");
+
+	prctl(PR_SET_NAME, thread_name);
+
+	std::vector<dump_map::entry_ptr> snapshots;
+	uint64_t version = 0;
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(pending_mutex);
+			pending_cv.wait(lock, [] () { return dump_thread_stop || pending_version != 0; });
+
+			if (pending_version == 0) {
+				return;
+			}
+
+			snapshots.clear();
+			snapshots.swap(pending_entries);
+			version = pending_version;
+			pending_version = 0;
+		}
+
+		create_dump(snapshots, version);
+	}
 }
 
 void update(const chrono::time_point& system_time, const chrono::time_point& internal_time) {
@@ -246,40 +380,109 @@ void update(const chrono::time_point& system_time, const chrono::time_point& int
 		message_queue::stats::update(system_time);
 		stats::update(system_time);
 
-		auto new_dump = create_dump();
-		{
-			std::lock_guard<std::mutex> lock(dump_mutex);
-			dump = new_dump;
-		}
+		publish_snapshots(take_snapshots(), dump_version);
+
+		internal::settle_metrics();
 
 		dump_timestamp = system_time;
 	}
 }
 
+// empty dump still gets new version, so that waiters and caches notice it,
+// and all metrics are removed from the previous dump, so that deltas report them
+static
+void reset_dump() {
+	// dump thread is not running here
+	dump_timestamp = chrono::time_point();
+	++dump_version;
+
+	std::vector<std::string> removed;
+	removed.reserve(dump->size());
+	for (auto metric_iter = dump->cbegin(); metric_iter != dump->cend(); ++metric_iter) {
+		removed.push_back(metric_iter->first);
+	}
+
+	dump = std::make_shared<const dump_map>(
+			dump->update(std::vector<dump_map::entry_ptr>(), removed, dump_version)
+		);
+	publish(dump);
+}
+
+void start() {
+	// dump thread is not running yet, so the segment can be set up here
+	if (!config::metrics_dump_opts.shared_memory.empty() &&
+			shared_dump::open(config::metrics_dump_opts.shared_memory)
+		)
+	{
+		shared_dump::publish(*dump);
+	}
+
+	dump_thread_stop = false;
+	dump_thread = std::thread(run_dump_thread);
+}
+
+void stop() {
+	{
+		std::lock_guard<std::mutex> lock(pending_mutex);
+		dump_thread_stop = true;
+	}
+	pending_cv.notify_one();
+
+	if (dump_thread.joinable()) {
+		dump_thread.join();
+	}
+
+	shared_dump::close();
+}
+
 void initialize() {
 	stats::initialize();
 
 	{
-		std::lock_guard<std::mutex> lock(dump_mutex);
-
-		dump_timestamp = chrono::time_point();
-		dump = std::shared_ptr<const std::map<std::string, metrics::metric_variant>>(new std::map<std::string, metrics::metric_variant>());
+		std::lock_guard<std::mutex> lock(pending_mutex);
+		pending_entries.clear();
+		pending_version = 0;
 	}
+
+	reset_dump();
 }
 
 void finalize() {
 	stats::finalize();
 
 	{
-		std::lock_guard<std::mutex> lock(dump_mutex);
-
-		dump_timestamp = chrono::time_point();
-		dump = std::shared_ptr<const std::map<std::string, metrics::metric_variant>>(new std::map<std::string, metrics::metric_variant>());
+		std::lock_guard<std::mutex> lock(pending_mutex);
+		pending_entries.clear();
+		pending_version = 0;
 	}
+
+	reset_dump();
 }
 
 }} // namespace handystats::metrics_dump
 
-const std::shared_ptr<const std::map<std::string, handystats::metrics::metric_variant>> HANDY_METRICS_DUMP() {
+const std::shared_ptr<const handystats::metrics_dump::dump_map> HANDY_METRICS_DUMP() {
 	return handystats::metrics_dump::get_dump();
 }
+
+handystats::metrics_dump::dump_view HANDY_METRICS_DUMP_PREFIX(const std::string& prefix) {
+	return handystats::metrics_dump::dump_view::prefix(handystats::metrics_dump::get_dump(), prefix);
+}
+
+handystats::metrics_dump::dump_view HANDY_METRICS_DUMP_GLOB(const std::string& pattern) {
+	return handystats::metrics_dump::dump_view::glob(handystats::metrics_dump::get_dump(), pattern);
+}
+
+handystats::metrics_dump::dump_delta HANDY_METRICS_DUMP_SINCE(const uint64_t& version) {
+	return handystats::metrics_dump::get_dump()->delta(version);
+}
+
+uint64_t HANDY_METRICS_DUMP_VERSION() {
+	return handystats::metrics_dump::get_dump()->version();
+}
+
+const std::shared_ptr<const handystats::metrics_dump::dump_map>
+HANDY_METRICS_DUMP_WAIT(const uint64_t& version, const handystats::chrono::duration& timeout)
+{
+	return handystats::metrics_dump::wait_dump(version, timeout);
+}
@@ -20,10 +20,10 @@
 
 #include <string>
 #include <memory>
-#include <map>
 
 #include <handystats/chrono.hpp>
 #include <handystats/metrics.hpp>
+#include <handystats/metrics_dump.hpp>
 #include <handystats/metrics/gauge.hpp>
 
 namespace handystats { namespace metrics_dump {
@@ -32,7 +32,14 @@ extern chrono::time_point dump_timestamp;
 
 void update(const chrono::time_point& system_time, const chrono::time_point& internal_time);
 
-const std::shared_ptr<const std::map<std::string, metrics::metric_variant>> get_dump();
+const std::shared_ptr<const dump_map> get_dump();
+
+// Returns the dump once its version differs from the given one or the timeout expires
+const std::shared_ptr<const dump_map> wait_dump(const uint64_t& version, const chrono::duration& timeout);
+
+// dump thread assembles and publishes dumps from snapshots taken by update()
+void start();
+void stop();
 
 void initialize();
 void finalize();
@@ -40,7 +47,9 @@ void finalize();
 
 namespace stats {
 
+// updated by the dump thread only
 extern metrics::gauge dump_time;
+extern metrics::gauge system_time_drift;
 
 void update(const chrono::time_point&);
 
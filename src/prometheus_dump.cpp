@@ -0,0 +1,168 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <handystats/prometheus_dump.hpp>
+
+#include "json/prometheus_writer.hpp"
+
+#include "rendered_dump_impl.hpp"
+
+namespace handystats { namespace prometheus {
+
+namespace {
+
+/*
+ * Rendered text of each metric keyed by metric's name.
+ * Fragment is re-rendered only if the metric's snapshot version differs from the cached one,
+ * fragments of metrics that are absent from the rendered dump are dropped.
+ * Metric which family name is already taken by preceding metric is not rendered.
+ */
+class fragments_cache {
+public:
+	fragments_cache()
+		: m_generation(0)
+	{}
+
+	void render(const handystats::metrics_dump::dump_map& dump, std::string& output) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		++m_generation;
+		output.clear();
+		m_taken.clear();
+
+		for (auto metric_iter = dump.cbegin(); metric_iter != dump.cend(); ++metric_iter) {
+			fragment& cached = m_fragments[metric_iter->first];
+
+			if (cached.generation == 0 || cached.version != metric_iter.version()) {
+				cached.text.clear();
+				write_metric(metric_iter->first, metric_iter->second, cached.text);
+				cached.version = metric_iter.version();
+				collect_families(cached.text, cached.families);
+			}
+			cached.generation = m_generation;
+
+			if (collides(cached.families)) {
+				write_collision(metric_iter->first, output);
+				continue;
+			}
+			m_taken.insert(cached.families.begin(), cached.families.end());
+
+			output.append(cached.text);
+		}
+
+		if (m_fragments.size() > dump.size()) {
+			for (auto fragment_iter = m_fragments.begin(); fragment_iter != m_fragments.end(); ) {
+				if (fragment_iter->second.generation != m_generation) {
+					fragment_iter = m_fragments.erase(fragment_iter);
+				}
+				else {
+					++fragment_iter;
+				}
+			}
+		}
+	}
+
+private:
+	// names of the families declared by "# TYPE <name> <type>" lines of the fragment
+	static void collect_families(const std::string& text, std::vector<std::string>& families) {
+		static const std::string TYPE_PREFIX = "# TYPE ";
+
+		families.clear();
+		size_t line = 0;
+		while (line < text.size()) {
+			if (text.compare(line, TYPE_PREFIX.size(), TYPE_PREFIX) == 0) {
+				const size_t name = line + TYPE_PREFIX.size();
+				families.push_back(text.substr(name, text.find(' ', name) - name));
+			}
+
+			line = text.find('\n', line);
+			if (line == std::string::npos) {
+				break;
+			}
+			++line;
+		}
+	}
+
+	bool collides(const std::vector<std::string>& families) const {
+		for (auto family = families.begin(); family != families.end(); ++family) {
+			if (m_taken.count(*family) > 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	struct fragment {
+		// version of the rendered snapshot
+		uint64_t version;
+		// last render the fragment has been used by
+		uint64_t generation;
+		std::string text;
+		std::vector<std::string> families;
+
+		fragment()
+			: version(0)
+			, generation(0)
+		{}
+	};
+
+	std::mutex m_mutex;
+	uint64_t m_generation;
+	std::unordered_map<std::string, fragment> m_fragments;
+	// families rendered so far by the current render
+	std::unordered_set<std::string> m_taken;
+};
+
+fragments_cache fragments;
+
+metrics_dump::rendered_dump prometheus_dump;
+
+void render(const handystats::metrics_dump::dump_map& dump, std::string& output) {
+	fragments.render(dump, output);
+}
+
+} // unnamed namespace
+
+std::string to_string(const handystats::metrics_dump::dump_map& dump) {
+	std::string output;
+	write(dump, output);
+	return output;
+}
+
+void write(const handystats::metrics_dump::dump_map& dump, std::string& buffer) {
+	fragments.render(dump, buffer);
+}
+
+const std::shared_ptr<const std::string> to_shared_string(const handystats::metrics_dump::dump_map& dump) {
+	return prometheus_dump.get(dump, render);
+}
+
+}} // namespace handystats::prometheus
+
+std::string HANDY_PROMETHEUS_DUMP() {
+	return *HANDY_PROMETHEUS_DUMP_SHARED();
+}
+
+const std::shared_ptr<const std::string> HANDY_PROMETHEUS_DUMP_SHARED() {
+	return handystats::prometheus::to_shared_string(*HANDY_METRICS_DUMP());
+}
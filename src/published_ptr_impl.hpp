@@ -0,0 +1,98 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_PUBLISHED_PTR_IMPL_HPP_
+#define HANDYSTATS_PUBLISHED_PTR_IMPL_HPP_
+
+#include <memory>
+#include <thread>
+
+#include <handystats/atomic.hpp>
+
+namespace handystats {
+
+/*
+ * Shared pointer published by single writer and read by many readers without locks.
+ *
+ * Pointer is kept in two slots, one of which is current.
+ * Reader announces itself in the current slot and copies the pointer from it
+ * unless the slot has been switched in the meantime (then it retries with the new current slot).
+ * Writer stores new pointer into the other slot once readers have left it and switches current slot.
+ * Readers never wait for the writer, writer waits only for readers that are copying the previous pointer.
+ */
+template <typename T>
+class published_ptr {
+public:
+	typedef std::shared_ptr<T> pointer_type;
+
+	explicit published_ptr(const pointer_type& ptr = pointer_type())
+		: m_current(0)
+	{
+		m_slots[0].ptr = ptr;
+		m_slots[0].readers.store(0, std::memory_order_relaxed);
+		m_slots[1].readers.store(0, std::memory_order_relaxed);
+	}
+
+	pointer_type load() const {
+		while (true) {
+			const unsigned current = m_current.load(std::memory_order_seq_cst);
+			slot& target = m_slots[current];
+
+			target.readers.fetch_add(1, std::memory_order_seq_cst);
+			if (m_current.load(std::memory_order_seq_cst) == current) {
+				pointer_type ptr = target.ptr;
+				target.readers.fetch_sub(1, std::memory_order_release);
+				return ptr;
+			}
+			target.readers.fetch_sub(1, std::memory_order_release);
+		}
+	}
+
+	// should be called by single writer at a time
+	void store(const pointer_type& ptr) {
+		const unsigned next = 1 - m_current.load(std::memory_order_relaxed);
+		slot& target = m_slots[next];
+
+		// readers that have missed previous switch leave the slot at once
+		while (target.readers.load(std::memory_order_seq_cst) != 0) {
+			std::this_thread::yield();
+		}
+
+		// pointer published two stores ago is released here
+		pointer_type retired(ptr);
+		target.ptr.swap(retired);
+		m_current.store(next, std::memory_order_seq_cst);
+	}
+
+private:
+	published_ptr(const published_ptr&);
+	published_ptr& operator=(const published_ptr&);
+
+	struct slot {
+		pointer_type ptr;
+		std::atomic<uint64_t> readers;
+		// slots are kept in separate cache lines
+		char padding[64 - sizeof(pointer_type) - sizeof(std::atomic<uint64_t>)];
+	};
+
+	mutable slot m_slots[2];
+	std::atomic<unsigned> m_current;
+};
+
+} // namespace handystats
+
+#endif // HANDYSTATS_PUBLISHED_PTR_IMPL_HPP_
@@ -0,0 +1,137 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <unordered_map>
+#include <handystats/atomic.hpp>
+
+#include "config_impl.hpp"
+
+#include "receive_time_impl.hpp"
+
+
+namespace handystats { namespace receive_time {
+
+// if no metric could be in receive-time mode, no lookup is performed
+static std::atomic<bool> counter_enabled(false);
+static std::atomic<bool> gauge_enabled(false);
+
+// thread-local caches are dropped on generation change
+static std::atomic<uint64_t> generation(0);
+
+static thread_local std::unordered_map<std::string, bool> local_counters;
+static thread_local std::unordered_map<std::string, bool> local_gauges;
+static thread_local uint64_t local_generation = 0;
+
+static
+void check_generation() {
+	const uint64_t current_generation = generation.load(std::memory_order_acquire);
+	if (local_generation != current_generation) {
+		local_counters.clear();
+		local_gauges.clear();
+		local_generation = current_generation;
+	}
+}
+
+template <typename Opts>
+static
+bool resolve(const std::string& name, const Opts& default_opts, std::unordered_map<std::string, bool>& cache) {
+	check_generation();
+
+	auto cache_iter = cache.find(name);
+	if (cache_iter != cache.end()) {
+		return cache_iter->second;
+	}
+
+	// same resolution as on metric creation
+	Opts opts = default_opts;
+	rapidjson::Value* pattern_cfg = config::select_pattern(name);
+	if (pattern_cfg) {
+		config::metrics::configure(opts, *pattern_cfg);
+	}
+
+	if (cache.size() >= MAX_CACHED_NAMES) {
+		cache.clear();
+	}
+	cache.insert(std::make_pair(name, opts.receive_time));
+	return opts.receive_time;
+}
+
+size_t cached_names() {
+	check_generation();
+	return local_counters.size() + local_gauges.size();
+}
+
+chrono::time_point counter_timestamp(const std::string& name, const chrono::time_point& timestamp) {
+	if (!is_unset(timestamp)) {
+		return timestamp;
+	}
+
+	if (counter_enabled.load(std::memory_order_acquire) &&
+			resolve(name, config::metrics::counter_opts, local_counters)
+		)
+	{
+		return timestamp;
+	}
+
+	return chrono::tsc_clock::now();
+}
+
+chrono::time_point gauge_timestamp(const std::string& name, const chrono::time_point& timestamp) {
+	if (!is_unset(timestamp)) {
+		return timestamp;
+	}
+
+	if (gauge_enabled.load(std::memory_order_acquire) &&
+			resolve(name, config::metrics::gauge_opts, local_gauges)
+		)
+	{
+		return timestamp;
+	}
+
+	return chrono::tsc_clock::now();
+}
+
+static
+bool pattern_enabled() {
+	for (auto pattern_iter = config::pattern_opts.begin(); pattern_iter != config::pattern_opts.end(); ++pattern_iter) {
+		const rapidjson::Value& pattern_cfg = *pattern_iter->second;
+		if (pattern_cfg.IsObject() && pattern_cfg.HasMember("receive-time") &&
+				pattern_cfg["receive-time"].IsBool() && pattern_cfg["receive-time"].GetBool()
+			)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void initialize() {
+	finalize();
+
+	const bool patterns = pattern_enabled();
+	counter_enabled.store(config::metrics::counter_opts.receive_time || patterns, std::memory_order_release);
+	gauge_enabled.store(config::metrics::gauge_opts.receive_time || patterns, std::memory_order_release);
+}
+
+void finalize() {
+	counter_enabled.store(false, std::memory_order_release);
+	gauge_enabled.store(false, std::memory_order_release);
+	generation.fetch_add(1, std::memory_order_release);
+}
+
+}} // namespace handystats::receive_time
@@ -0,0 +1,53 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_RECEIVE_TIME_IMPL_HPP_
+#define HANDYSTATS_RECEIVE_TIME_IMPL_HPP_
+
+#include <string>
+
+#include <handystats/chrono.hpp>
+
+// Resolution of receive-time mode (see receive-time option of counter and gauge metrics)
+// Events of metrics in receive-time mode are passed with unset timestamp
+// and are timestamped by the processor in batches (see message_queue::pop)
+// Resolved modes are cached thread-locally, so lookups on hot path are lock-free
+// Caches are bounded (MAX_CACHED_NAMES per metric type) and dropped when overflown, since names could be dynamic
+namespace handystats { namespace receive_time {
+
+inline bool is_unset(const chrono::time_point& timestamp) {
+	return timestamp.time_since_epoch().count() == 0;
+}
+
+// Returns passed timestamp if it's set,
+// unset timestamp if the metric is in receive-time mode
+// and current time otherwise
+chrono::time_point counter_timestamp(const std::string& name, const chrono::time_point& timestamp);
+chrono::time_point gauge_timestamp(const std::string& name, const chrono::time_point& timestamp);
+
+const size_t MAX_CACHED_NAMES = 1024;
+
+// number of names cached by the calling thread
+size_t cached_names();
+
+void initialize();
+void finalize();
+
+}} // namespace handystats::receive_time
+
+
+#endif // HANDYSTATS_RECEIVE_TIME_IMPL_HPP_
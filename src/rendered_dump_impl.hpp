@@ -0,0 +1,76 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_RENDERED_DUMP_IMPL_HPP_
+#define HANDYSTATS_RENDERED_DUMP_IMPL_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <handystats/metrics_dump.hpp>
+
+namespace handystats { namespace metrics_dump {
+
+/*
+ * Text rendering of the metrics dump memoised by dump version.
+ * Each dump version is rendered at most once, concurrent callers wait for the rendering
+ * and then share it.
+ */
+class rendered_dump {
+public:
+	typedef std::shared_ptr<const std::string> rendered_ptr;
+
+	rendered_dump()
+		: m_version(0)
+		, m_rendered()
+	{}
+
+	// render(const dump_map&, std::string&) is called if the dump's version hasn't been rendered yet
+	template <typename Renderer>
+	rendered_ptr get(const dump_map& dump, Renderer render) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (m_rendered && m_version == dump.version()) {
+			return m_rendered;
+		}
+
+		std::shared_ptr<std::string> rendered(new std::string());
+		if (m_rendered) {
+			rendered->reserve(m_rendered->size());
+		}
+		render(dump, *rendered);
+
+		// dump could be older than the cached one if caller has held it for a while
+		if (!m_rendered || dump.version() > m_version) {
+			m_version = dump.version();
+			m_rendered = rendered;
+		}
+
+		return rendered;
+	}
+
+private:
+	std::mutex m_mutex;
+	uint64_t m_version;
+	rendered_ptr m_rendered;
+};
+
+}} // namespace handystats::metrics_dump
+
+#endif // HANDYSTATS_RENDERED_DUMP_IMPL_HPP_
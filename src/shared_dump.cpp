@@ -0,0 +1,355 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <handystats/binary_dump.hpp>
+
+#include "shared_dump_impl.hpp"
+
+namespace handystats { namespace shared_dump {
+
+namespace {
+
+const char MAGIC[4] = {'H', 'S', 'S', 'M'};
+const uint32_t LAYOUT_VERSION = 1;
+
+// header occupies the first page, slots follow it
+const size_t DATA_OFFSET = 4096;
+const size_t MIN_CAPACITY = 64 * 1024;
+
+// the slot that stays unstable longer is considered abandoned by the writer
+const std::chrono::seconds READ_TIMEOUT(1);
+
+struct segment_header {
+	char magic[4];
+	uint32_t layout_version;
+	// capacity of each slot, fixed for segment's lifetime
+	uint64_t capacity;
+	// set when the file at the path has been replaced or removed
+	std::atomic<uint32_t> stale;
+	uint32_t reserved;
+	// number of published dumps, current slot is generation % 2
+	std::atomic<uint64_t> generation;
+
+	struct slot {
+		// odd while the slot is being written
+		std::atomic<uint64_t> sequence;
+		std::atomic<uint64_t> size;
+		std::atomic<uint64_t> version;
+	} slots[2];
+};
+
+static_assert(sizeof(segment_header) <= DATA_OFFSET, "shared dump header doesn't fit its page");
+
+segment_header* header(void* segment) {
+	return reinterpret_cast<segment_header*>(segment);
+}
+
+char* slot_data(void* segment, const size_t& slot) {
+	return reinterpret_cast<char*>(segment) + DATA_OFFSET + slot * header(segment)->capacity;
+}
+
+size_t segment_size(const size_t& capacity) {
+	return DATA_OFFSET + 2 * capacity;
+}
+
+
+/*
+ * Writer
+ */
+
+std::string writer_path;
+void* writer_segment = nullptr;
+size_t writer_size = 0;
+
+void unmap_writer_segment() {
+	if (writer_segment) {
+		header(writer_segment)->stale.store(1, std::memory_order_release);
+		munmap(writer_segment, writer_size);
+		writer_segment = nullptr;
+		writer_size = 0;
+	}
+}
+
+// new segment is prepared under unique temporary name and then atomically renamed to the path,
+// so readers never see partially initialized segment;
+// the temporary file is created exclusively, since the directory is usually world-writable
+void* create_segment(const size_t& capacity, std::string& temp_path) {
+	std::vector<char> temp_template(writer_path.begin(), writer_path.end());
+	const std::string suffix = ".XXXXXX";
+	temp_template.insert(temp_template.end(), suffix.begin(), suffix.end());
+	temp_template.push_back('\0');
+
+	const int fd = mkstemp(temp_template.data());
+	if (fd < 0) {
+		std::cerr << "Unable to create shared dump segment " << temp_template.data() << ": " << strerror(errno) << std::endl;
+		return nullptr;
+	}
+	temp_path = temp_template.data();
+
+	// mkstemp creates the file readable by the owner only
+	if (fcntl(fd, F_SETFD, FD_CLOEXEC) != 0 || fchmod(fd, 0644) != 0 || ftruncate(fd, segment_size(capacity)) != 0) {
+		std::cerr << "Unable to prepare shared dump segment " << temp_path << ": " << strerror(errno) << std::endl;
+		::close(fd);
+		unlink(temp_path.c_str());
+		return nullptr;
+	}
+
+	void* segment = mmap(nullptr, segment_size(capacity), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (segment == MAP_FAILED) {
+		std::cerr << "Unable to map shared dump segment " << temp_path << ": " << strerror(errno) << std::endl;
+		unlink(temp_path.c_str());
+		return nullptr;
+	}
+
+	// the file is zero-filled, atomics are valid as is
+	memcpy(header(segment)->magic, MAGIC, sizeof(MAGIC));
+	header(segment)->layout_version = LAYOUT_VERSION;
+	header(segment)->capacity = capacity;
+
+	return segment;
+}
+
+bool install_segment(void* segment, const std::string& temp_path) {
+	const size_t size = segment_size(header(segment)->capacity);
+
+	if (rename(temp_path.c_str(), writer_path.c_str()) != 0) {
+		std::cerr << "Unable to rename shared dump segment to " << writer_path << ": " << strerror(errno) << std::endl;
+		munmap(segment, size);
+		unlink(temp_path.c_str());
+		return false;
+	}
+
+	unmap_writer_segment();
+	writer_segment = segment;
+	writer_size = size;
+
+	return true;
+}
+
+void write_slot(void* segment, const std::string& buffer, const uint64_t& version) {
+	segment_header* head = header(segment);
+
+	const uint64_t generation = head->generation.load(std::memory_order_relaxed) + 1;
+	const size_t slot_index = generation % 2;
+	segment_header::slot& slot = head->slots[slot_index];
+
+	const uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+	slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	memcpy(slot_data(segment, slot_index), buffer.data(), buffer.size());
+	slot.size.store(buffer.size(), std::memory_order_relaxed);
+	slot.version.store(version, std::memory_order_relaxed);
+
+	slot.sequence.store(sequence + 2, std::memory_order_release);
+	head->generation.store(generation, std::memory_order_release);
+}
+
+} // unnamed namespace
+
+
+bool open(const std::string& path) {
+	close();
+
+	writer_path = path;
+
+	std::string temp_path;
+	void* segment = create_segment(MIN_CAPACITY, temp_path);
+	if (!segment || !install_segment(segment, temp_path)) {
+		writer_path.clear();
+		return false;
+	}
+	return true;
+}
+
+void publish(const metrics_dump::dump_map& dump) {
+	if (!writer_segment) {
+		return;
+	}
+
+	const auto& buffer = binary::to_shared_string(dump);
+
+	if (buffer->size() <= header(writer_segment)->capacity) {
+		write_slot(writer_segment, *buffer, dump.version());
+		return;
+	}
+
+	// the dump has outgrown the segment, readers are moved to the larger one
+	size_t capacity = 2 * header(writer_segment)->capacity;
+	while (capacity < buffer->size()) {
+		capacity *= 2;
+	}
+
+	std::string temp_path;
+	void* segment = create_segment(capacity, temp_path);
+	if (segment) {
+		write_slot(segment, *buffer, dump.version());
+		install_segment(segment, temp_path);
+	}
+}
+
+void close() {
+	if (writer_segment) {
+		unmap_writer_segment();
+		unlink(writer_path.c_str());
+	}
+	writer_path.clear();
+}
+
+
+/*
+ * Reader
+ */
+
+reader::reader(const std::string& path)
+	: m_path(path)
+	, m_segment(nullptr)
+	, m_size(0)
+	, m_version(0)
+{}
+
+reader::~reader() {
+	close();
+}
+
+bool reader::open() {
+	const int fd = ::open(m_path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		if (errno == ENOENT) {
+			return false;
+		}
+		throw std::system_error(errno, std::system_category(), "unable to open shared dump segment " + m_path);
+	}
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0) {
+		const int error = errno;
+		::close(fd);
+		throw std::system_error(error, std::system_category(), "unable to stat shared dump segment " + m_path);
+	}
+
+	if (size_t(file_stat.st_size) < DATA_OFFSET) {
+		::close(fd);
+		throw std::invalid_argument("shared dump: " + m_path + " is not a dump segment");
+	}
+
+	void* segment = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	const int error = errno;
+	::close(fd);
+	if (segment == MAP_FAILED) {
+		throw std::system_error(error, std::system_category(), "unable to map shared dump segment " + m_path);
+	}
+
+	if (memcmp(header(segment)->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+			header(segment)->layout_version != LAYOUT_VERSION ||
+			size_t(file_stat.st_size) < segment_size(header(segment)->capacity)
+		)
+	{
+		munmap(segment, file_stat.st_size);
+		throw std::invalid_argument("shared dump: " + m_path + " is not a dump segment");
+	}
+
+	m_segment = segment;
+	m_size = file_stat.st_size;
+	return true;
+}
+
+void reader::close() {
+	if (m_segment) {
+		munmap(m_segment, m_size);
+		m_segment = nullptr;
+		m_size = 0;
+	}
+}
+
+bool reader::read(std::string& buffer) {
+	const auto& deadline = std::chrono::steady_clock::now() + READ_TIMEOUT;
+
+	for (size_t attempt = 0; ; ++attempt) {
+		// the writer may have died in the middle of the slot copy
+		if (attempt > 0 && std::chrono::steady_clock::now() > deadline) {
+			throw std::runtime_error("shared dump: no stable dump in " + m_path + ", the writer seems to be dead");
+		}
+
+		if (m_segment && header(m_segment)->stale.load(std::memory_order_acquire)) {
+			close();
+		}
+		if (!m_segment && !open()) {
+			return false;
+		}
+
+		segment_header* segment = header(m_segment);
+
+		const uint64_t generation = segment->generation.load(std::memory_order_acquire);
+		if (generation == 0) {
+			return false;
+		}
+
+		const size_t slot_index = generation % 2;
+		const segment_header::slot& slot = segment->slots[slot_index];
+
+		const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+		if (sequence % 2) {
+			// the writer has already lapped us, retry with the new generation
+			std::this_thread::yield();
+			continue;
+		}
+
+		const uint64_t size = slot.size.load(std::memory_order_relaxed);
+		const uint64_t version = slot.version.load(std::memory_order_relaxed);
+		if (size > segment->capacity) {
+			if (slot.sequence.load(std::memory_order_acquire) == sequence) {
+				throw std::invalid_argument("shared dump: invalid dump size in " + m_path);
+			}
+			continue;
+		}
+
+		buffer.assign(slot_data(m_segment, slot_index), size);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+			continue;
+		}
+
+		m_version = version;
+		return true;
+	}
+}
+
+uint64_t reader::version() const {
+	return m_version;
+}
+
+}} // namespace handystats::shared_dump
@@ -0,0 +1,39 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_SHARED_DUMP_IMPL_HPP_
+#define HANDYSTATS_SHARED_DUMP_IMPL_HPP_
+
+#include <string>
+
+#include <handystats/metrics_dump.hpp>
+#include <handystats/shared_dump.hpp>
+
+namespace handystats { namespace shared_dump {
+
+// writer side, used by the dump thread only
+
+// Creates the segment at the path, returns false (with error reported to stderr) on failure
+bool open(const std::string& path);
+// Copies binary representation of the dump into the segment if it's open
+void publish(const metrics_dump::dump_map& dump);
+// Marks the segment stale and removes it
+void close();
+
+}} // namespace handystats::shared_dump
+
+#endif // HANDYSTATS_SHARED_DUMP_IMPL_HPP_
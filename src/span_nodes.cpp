@@ -0,0 +1,78 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <mutex>
+#include <unordered_set>
+#include <handystats/atomic.hpp>
+
+#include "config_impl.hpp"
+
+#include "span_nodes_impl.hpp"
+
+
+namespace handystats { namespace span_nodes {
+
+static std::mutex nodes_mutex;
+static std::unordered_set<std::string> nodes;
+
+// thread-local caches are dropped on generation change
+static std::atomic<uint64_t> generation(0);
+
+static thread_local std::unordered_set<std::string> local_nodes;
+static thread_local uint64_t local_generation = 0;
+
+bool admit(const std::string& path) {
+	const uint64_t current_generation = generation.load(std::memory_order_acquire);
+	if (local_generation != current_generation) {
+		local_nodes.clear();
+		local_generation = current_generation;
+	}
+
+	if (local_nodes.find(path) != local_nodes.end()) {
+		return true;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(nodes_mutex);
+		if (nodes.find(path) == nodes.end()) {
+			if (nodes.size() >= config::metrics::span_opts.max_nodes) {
+				return false;
+			}
+			nodes.insert(path);
+		}
+	}
+
+	local_nodes.insert(path);
+	return true;
+}
+
+size_t size() {
+	std::lock_guard<std::mutex> lock(nodes_mutex);
+	return nodes.size();
+}
+
+void initialize() {
+	finalize();
+}
+
+void finalize() {
+	std::lock_guard<std::mutex> lock(nodes_mutex);
+	nodes.clear();
+	generation.fetch_add(1, std::memory_order_release);
+}
+
+}} // namespace handystats::span_nodes
@@ -0,0 +1,39 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_SPAN_NODES_IMPL_HPP_
+#define HANDYSTATS_SPAN_NODES_IMPL_HPP_
+
+#include <string>
+
+// Registry of span tree nodes (span paths) bounded by max-nodes configuration option
+// Admitted paths are cached thread-locally, so lookups on hot path are lock-free
+namespace handystats { namespace span_nodes {
+
+// returns false if path is new and the tree is already full
+bool admit(const std::string& path);
+
+// number of admitted nodes
+size_t size();
+
+void initialize();
+void finalize();
+
+}} // namespace handystats::span_nodes
+
+
+#endif // HANDYSTATS_SPAN_NODES_IMPL_HPP_
@@ -21,6 +21,7 @@
 #include <iterator>
 #include <vector>
 #include <cmath>
+#include <stdexcept>
 
 #include <handystats/common.h>
 #include <handystats/math_utils.hpp>
@@ -43,50 +44,6 @@ find_z(const long double& a, const long double& b, const long double& c) {
 	throw std::logic_error("find_z: not found (" + std::to_string(a) + ", " + std::to_string(b) + ", " + std::to_string(c) + ")");
 }
 
-static void
-remove_empty_bins(handystats::statistics::histogram_type& histogram) {
-	using handystats::statistics;
-	using handystats::math_utils;
-
-	auto is_empty_bin = [](const statistics::bin_type& bin) {
-		return math_utils::cmp(std::get<statistics::BIN_COUNT>(bin), 0.0) <= 0;
-	};
-
-	// remove leading empty bins
-	auto first_nonempty_bin = std::find_if_not(histogram.begin(), histogram.end(), is_empty_bin);
-	histogram.erase(histogram.begin(), first_nonempty_bin);
-
-	// remove trailing empty bins
-	// NOTE: reverse_iterator.base() returns iterator pointing to the element next
-	// to the one the reverse_iterator is currently pointing to
-	auto last_nonempty_bin = std::find_if_not(histogram.rbegin(), histogram.rend(), is_empty_bin);
-	histogram.erase(last_nonempty_bin.base(), histogram.end());
-
-	// remove empty bins that are surrounded by empty bins
-	for (size_t index = 1; index < histogram.size() - 1;) {
-		if (!is_empty_bin(histogram[index])) {
-			// as the current bin is not empty, next bin could not be surrouned by empty
-			// bins, skip it too
-			index += 2;
-			continue;
-		}
-
-		if (!is_empty_bin(histogram[index + 1])) {
-			// as the bin to the right is not empty it could not be surrounded by empty
-			// bins, as well as the next one
-			index += 3;
-			continue;
-		}
-
-		if (!is_empty_bin(histogram[index - 1])) {
-			index += 1;
-			continue;
-		}
-
-		histogram.erase(histogram.begin() + index);
-	}
-}
-
 namespace handystats {
 
 statistics::quantile_extractor::quantile_extractor(const statistics* const statistics)
@@ -98,33 +55,35 @@ double statistics::quantile_extractor::at(const double& probability) const {
 		return 0;
 	}
 
-	const auto& histogram = m_statistics->m_histogram;
+	const auto& centers = m_statistics->m_bin_centers;
+	const auto& counts = m_statistics->m_bin_counts;
+	const int bins_count = centers.size();
 
-	if (histogram.size() == 0) {
+	if (bins_count == 0) {
 		return 0;
 	}
 
 	double moving_count = 0;
-	for (auto bin = histogram.begin(); bin != histogram.end(); ++bin) {
-		moving_count += std::get<BIN_COUNT>(*bin);
+	for (int index = 0; index < bins_count; ++index) {
+		moving_count += counts[index];
 	}
 
 	if (math_utils::cmp<double>(moving_count, 0) <= 0) {
 		return 0;
 	}
 
-	if (histogram.size() == 1) {
-		return std::get<BIN_CENTER>(histogram[0]);
+	if (bins_count == 1) {
+		return centers[0];
 	}
 
 	double required_count = moving_count * probability;
 
 	int bin_index = -1;
-	for (; bin_index < (int)histogram.size(); ++bin_index) {
+	for (; bin_index < bins_count; ++bin_index) {
 		double volume =
 			(
-				(bin_index == -1 ? 0 : std::get<BIN_COUNT>(histogram[bin_index]))
-				+ (bin_index + 1 == histogram.size() ? 0 : std::get<BIN_COUNT>(histogram[bin_index + 1]))
+				(bin_index == -1 ? 0 : counts[bin_index])
+				+ (bin_index + 1 == bins_count ? 0 : counts[bin_index + 1])
 			) / 2.0;
 
 		if (math_utils::cmp(volume, required_count) > 0) break;
@@ -132,45 +91,41 @@ double statistics::quantile_extractor::at(const double& probability) const {
 		required_count -= volume;
 	}
 
-	bin_type left_bin;
-	bin_type right_bin;
+	// (center, count) of bins surrounding required quantile
+	double left_center, left_count;
+	double right_center, right_count;
 
 	if (bin_index == -1) {
-		left_bin = bin_type{
-			2 * std::get<BIN_CENTER>(histogram[0]) -
-				math_utils::weighted_average(
-						std::get<BIN_CENTER>(histogram[0]), std::get<BIN_COUNT>(histogram[0]),
-						std::get<BIN_CENTER>(histogram[1]), std::get<BIN_COUNT>(histogram[1])
-					),
-			0,
-			time_point()
-		};
-		right_bin = histogram[0];
-	}
-	else if (bin_index + 1 < histogram.size()) {
-		left_bin = histogram[bin_index];
-		right_bin = histogram[bin_index + 1];
+		left_center = 2 * centers[0] - math_utils::weighted_average(centers[0], counts[0], centers[1], counts[1]);
+		left_count = 0;
+		right_center = centers[0];
+		right_count = counts[0];
+	}
+	else if (bin_index + 1 < bins_count) {
+		left_center = centers[bin_index];
+		left_count = counts[bin_index];
+		right_center = centers[bin_index + 1];
+		right_count = counts[bin_index + 1];
 	}
 	else {
-		left_bin = histogram[bin_index];
-		right_bin = bin_type{
-			2 * std::get<BIN_CENTER>(histogram[bin_index]) -
-				math_utils::weighted_average(
-						std::get<BIN_CENTER>(histogram[bin_index - 1]), std::get<BIN_COUNT>(histogram[bin_index - 1]),
-						std::get<BIN_CENTER>(histogram[bin_index]), std::get<BIN_COUNT>(histogram[bin_index])
-					),
-			0,
-			time_point()
-		};
-	}
-
-	const double& a = std::get<BIN_COUNT>(right_bin) - std::get<BIN_COUNT>(left_bin);
-	const double& b = 2 * std::get<BIN_COUNT>(left_bin);
+		left_center = centers[bin_index];
+		left_count = counts[bin_index];
+		right_center =
+			2 * centers[bin_index] -
+			math_utils::weighted_average(
+					centers[bin_index - 1], counts[bin_index - 1],
+					centers[bin_index], counts[bin_index]
+				);
+		right_count = 0;
+	}
+
+	const double& a = right_count - left_count;
+	const double& b = 2 * left_count;
 	const double& c = -2 * required_count;
 
 	const double& z = find_z(a, b, c);
 
-	return std::get<BIN_CENTER>(left_bin) + (std::get<BIN_CENTER>(right_bin) - std::get<BIN_CENTER>(left_bin)) * z;
+	return left_center + (right_center - left_center) * z;
 }
 
 const statistics::tag::type statistics::tag::empty;
@@ -241,55 +196,32 @@ bool statistics::enabled(const statistics::tag::type& t) const HANDYSTATS_NOEXCE
 }
 
 bool statistics::computed(const statistics::tag::type& t) const HANDYSTATS_NOEXCEPT {
-	switch (t) {
-	case tag::value:
-		return enabled(tag::value) || computed(tag::rate);
-
-	case tag::min:
-		return enabled(tag::min);
-
-	case tag::max:
-		return enabled(tag::max);
-
-	case tag::count:
-		return enabled(tag::count) || computed(tag::avg);
-
-	case tag::sum:
-		return enabled(tag::sum) || computed(tag::avg);
-
-	case tag::avg:
-		return enabled(tag::avg);
-
-	case tag::moving_count:
-		return enabled(tag::moving_count) || computed(tag::moving_avg);
-
-	case tag::moving_sum:
-		return enabled(tag::moving_sum) || computed(tag::moving_avg);
-
-	case tag::moving_avg:
-		return enabled(tag::moving_avg);
-
-	case tag::histogram:
-		return enabled(tag::histogram) || computed(tag::quantile) || computed(tag::entropy);
-
-	case tag::quantile:
-		return enabled(tag::quantile);
+	return m_computed_tags & t;
+}
 
-	case tag::timestamp:
-		return enabled(tag::timestamp) ||
-			computed(tag::moving_count) || computed(tag::moving_sum) || computed(tag::moving_avg) ||
-			computed(tag::histogram) || computed(tag::quantile) ||
-			computed(tag::rate);
+static
+statistics::tag::type resolve_computed_tags(const statistics::tag::type& tags) {
+	typedef statistics::tag tag;
 
-	case tag::rate:
-		return enabled(tag::rate);
+	statistics::tag::type computed = tags;
 
-	case tag::entropy:
-		return enabled(tag::entropy);
+	if (computed & tag::rate) {
+		computed |= tag::value;
+	}
+	if (computed & tag::avg) {
+		computed |= tag::count | tag::sum;
+	}
+	if (computed & tag::moving_avg) {
+		computed |= tag::moving_count | tag::moving_sum;
+	}
+	if (computed & (tag::quantile | tag::entropy)) {
+		computed |= tag::histogram;
+	}
+	if (computed & (tag::moving_count | tag::moving_sum | tag::histogram | tag::rate)) {
+		computed |= tag::timestamp;
+	}
 
-	default:
-		return false;
-	};
+	return computed;
 }
 
 statistics::tag::type statistics::tags() const HANDYSTATS_NOEXCEPT {
@@ -305,6 +237,10 @@ statistics::statistics(
 }
 
 void statistics::reset() {
+	m_computed_tags = resolve_computed_tags(m_config.tags);
+	m_interval_unit = m_config.moving_interval.unit();
+	m_interval_count = m_config.moving_interval.count();
+
 	m_value = value_type(0);
 	m_min = std::numeric_limits<value_type>::max();
 	m_max = std::numeric_limits<value_type>::min();
@@ -312,16 +248,31 @@ void statistics::reset() {
 	m_count = 0;
 	m_moving_count = 0.0;
 	m_moving_sum = 0.0;
-	m_histogram.clear();
+	m_bin_centers.clear();
+	m_bin_counts.clear();
+	m_bin_timestamps.clear();
 	if (m_config.histogram_bins > 0) {
-		m_histogram.reserve(m_config.histogram_bins + 1);
+		m_bin_centers.reserve(m_config.histogram_bins + 1);
+		m_bin_counts.reserve(m_config.histogram_bins + 1);
+		m_bin_timestamps.reserve(m_config.histogram_bins + 1);
 	}
+	m_bin_unit = chrono::time_unit::TICK;
+	m_bin_clock = chrono::clock_type::TSC;
 	m_timestamp = time_point();
 	m_rate = 0;
 
 	m_data_timestamp = time_point();
 }
 
+int64_t statistics::moving_interval_count(const chrono::time_unit& unit) {
+	// NOTE: cached TICK count doesn't follow TSC rate refinement, which is within ppm
+	if (unit != m_interval_unit) {
+		m_interval_count = duration::convert_to(unit, m_config.moving_interval).count();
+		m_interval_unit = unit;
+	}
+	return m_interval_count;
+}
+
 double statistics::shift_interval_data(
 		const double& data, const statistics::time_point& data_timestamp,
 		const statistics::time_point& timestamp
@@ -329,6 +280,21 @@ double statistics::shift_interval_data(
 {
 	if (timestamp <= m_timestamp) return data;
 
+	const auto& unit = timestamp.time_since_epoch().unit();
+	if (data_timestamp.time_since_epoch().unit() == unit && m_timestamp.time_since_epoch().unit() == unit &&
+			data_timestamp.clock() == timestamp.clock() && m_timestamp.clock() == timestamp.clock()
+		)
+	{
+		// fast path, raw counts of the same unit
+		const int64_t interval = moving_interval_count(unit);
+		const int64_t data_count = data_timestamp.time_since_epoch().count();
+
+		const int64_t stale_interval = data_count - (timestamp.time_since_epoch().count() - interval);
+		if (stale_interval <= 0) return 0;
+
+		return data * stale_interval / (interval - (m_timestamp.time_since_epoch().count() - data_count));
+	}
+
 	const auto& stale_interval = data_timestamp - (timestamp - m_config.moving_interval);
 
 	if (stale_interval.count() <= 0) return 0;
@@ -342,7 +308,10 @@ double statistics::update_interval_data(
 	)
 {
 	if (timestamp <= m_timestamp) {
-		if (timestamp < m_timestamp - m_config.moving_interval) {
+		const auto& unit = m_timestamp.time_since_epoch().unit();
+		const auto& interval_start =
+			m_timestamp - duration(moving_interval_count(unit), unit);
+		if (timestamp < interval_start) {
 			return data;
 		}
 		else {
@@ -357,98 +326,195 @@ double statistics::update_interval_data(
 }
 
 
+int64_t statistics::to_bin_timestamp(const time_point& timestamp) const {
+	const auto& since_epoch = timestamp.time_since_epoch();
+	if (since_epoch.unit() == m_bin_unit && timestamp.clock() == m_bin_clock) {
+		return since_epoch.count();
+	}
+
+	// NOTE: SYSTEM to TSC clock conversion is not possible,
+	// statistics are expected to be fed with timestamps of the same clock
+	if (timestamp.clock() != m_bin_clock && m_bin_clock == chrono::clock_type::SYSTEM) {
+		return chrono::duration::convert_to(m_bin_unit,
+				time_point::convert_to(chrono::clock_type::SYSTEM, timestamp).time_since_epoch()
+			).count();
+	}
+
+	return chrono::duration::convert_to(m_bin_unit, since_epoch).count();
+}
+
+statistics::time_point statistics::from_bin_timestamp(const int64_t& bin_timestamp) const {
+	return time_point(duration(bin_timestamp, m_bin_unit), m_bin_clock);
+}
+
 void statistics::shift_histogram(const statistics::time_point& timestamp) {
 	if (m_config.histogram_bins == 0) return;
+	if (m_bin_counts.empty()) return;
+	if (timestamp <= m_timestamp) return;
+
+	// same as shift_interval_data, but in raw bin timestamp units
+	const int64_t current_timestamp = to_bin_timestamp(timestamp);
+	const int64_t last_timestamp = to_bin_timestamp(m_timestamp);
+	const int64_t interval = moving_interval_count(m_bin_unit);
+	const int64_t interval_start = current_timestamp - interval;
 
-	for (auto bin = m_histogram.begin(); bin != m_histogram.end(); ++bin) {
-		auto& bin_count = std::get<BIN_COUNT>(*bin);
-		const auto& bin_timestamp = std::get<BIN_TIMESTAMP>(*bin);
+	double* counts = m_bin_counts.data();
+	const int64_t* timestamps = m_bin_timestamps.data();
+	const size_t bins_count = m_bin_counts.size();
 
-		bin_count = shift_interval_data(bin_count, bin_timestamp, timestamp);
+	for (size_t index = 0; index < bins_count; ++index) {
+		const int64_t stale_interval = timestamps[index] - interval_start;
+		counts[index] =
+			stale_interval <= 0 ?
+				0.0 :
+				counts[index] * stale_interval / (interval - (last_timestamp - timestamps[index]));
 	}
 }
 
-static double bin_merge_criteria(
-		const statistics::bin_type& left_bin,
-		const statistics::bin_type& right_bin
-	)
-{
-	// possible variants:
-	// * distance between bins' centers
-	// * sum of bins' weights (number of elements)
-	// * other heuristics
+void statistics::remove_empty_bins() {
+	const size_t bins_count = m_bin_counts.size();
+
+	auto is_empty_bin = [this] (const size_t& index) {
+		return math_utils::cmp(m_bin_counts[index], 0.0) <= 0;
+	};
+
+	// skip leading and trailing empty bins
+	size_t first_bin = 0;
+	while (first_bin < bins_count && is_empty_bin(first_bin)) {
+		++first_bin;
+	}
+	size_t last_bin = bins_count;
+	while (last_bin > first_bin && is_empty_bin(last_bin - 1)) {
+		--last_bin;
+	}
+
+	// remove empty bins that are surrounded by empty bins
+	size_t new_bins_count = 0;
+	for (size_t index = first_bin; index < last_bin; ++index) {
+		if (is_empty_bin(index) &&
+				math_utils::cmp(m_bin_counts[new_bins_count - 1], 0.0) <= 0 &&
+				is_empty_bin(index + 1)
+			)
+		{
+			continue;
+		}
+
+		m_bin_centers[new_bins_count] = m_bin_centers[index];
+		m_bin_counts[new_bins_count] = m_bin_counts[index];
+		m_bin_timestamps[new_bins_count] = m_bin_timestamps[index];
+		++new_bins_count;
+	}
+
+	m_bin_centers.resize(new_bins_count);
+	m_bin_counts.resize(new_bins_count);
+	m_bin_timestamps.resize(new_bins_count);
+}
 
-	// distance between bins' centers
-	return std::get<statistics::BIN_CENTER>(right_bin) - std::get<statistics::BIN_CENTER>(left_bin);
+void statistics::merge_bins(const size_t& index) {
+	auto& left_center = m_bin_centers[index];
+	auto& left_count = m_bin_counts[index];
+	auto& left_timestamp = m_bin_timestamps[index];
 
-	// sum of bins' weights
-	//return std::get<statistics::BIN_COUNT>(left_bin) + std::get<statistics::BIN_COUNT>(right_bin);
+	const auto& right_center = m_bin_centers[index + 1];
+	const auto& right_count = m_bin_counts[index + 1];
+	const auto& right_timestamp = m_bin_timestamps[index + 1];
 
-	// heuristic -- minimum resulted bin square
-	//return (std::get<statistics::BIN_COUNT>(left_bin) + std::get<statistics::BIN_COUNT>(right_bin)) *
-	//	(std::get<statistics::BIN_CENTER>(right_bin) - std::get<statistics::BIN_CENTER>(left_bin));
+	if (math_utils::cmp(left_count, 0.0) <= 0 && math_utils::cmp(right_count, 0.0) <= 0) {
+		left_center = math_utils::weighted_average(left_center, 1, right_center, 1);
+		left_count = 0;
+		left_timestamp = 0;
+	}
+	else {
+		left_center = math_utils::weighted_average(left_center, left_count, right_center, right_count);
+		left_count += right_count;
+		left_timestamp = std::max(left_timestamp, right_timestamp);
+	}
+
+	m_bin_centers.erase(m_bin_centers.begin() + index + 1);
+	m_bin_counts.erase(m_bin_counts.begin() + index + 1);
+	m_bin_timestamps.erase(m_bin_timestamps.begin() + index + 1);
 }
 
 void statistics::update_histogram(const statistics::value_type& value, const statistics::time_point& timestamp)
 {
 	if (m_config.histogram_bins == 0) return;
 
-	statistics::bin_type new_bin(value, 1.0, timestamp);
+	if (m_bin_centers.empty()) {
+		m_bin_unit = timestamp.time_since_epoch().unit();
+		m_bin_clock = timestamp.clock();
+	}
+
+	const size_t insert_index =
+		std::lower_bound(m_bin_centers.begin(), m_bin_centers.end(), value) - m_bin_centers.begin();
 
-	auto insert_iter = std::lower_bound(m_histogram.begin(), m_histogram.end(), new_bin);
-	m_histogram.insert(insert_iter, new_bin);
+	m_bin_centers.insert(m_bin_centers.begin() + insert_index, value);
+	m_bin_counts.insert(m_bin_counts.begin() + insert_index, 1.0);
+	m_bin_timestamps.insert(m_bin_timestamps.begin() + insert_index, to_bin_timestamp(timestamp));
 
 	shift_histogram(timestamp);
 
-	if (m_histogram.size() <= m_config.histogram_bins) {
-		return;
-	}
+	compress_histogram();
+}
 
-	// remove excess empty bins from histogram before merging
-	remove_empty_bins(m_histogram);
-	if (m_histogram.size() <= m_config.histogram_bins) {
+void statistics::compress_histogram() {
+	if (m_bin_centers.size() <= m_config.histogram_bins) {
 		return;
 	}
 
-	size_t best_merge_index = -1;
-	double best_merge_criteria = 0;
-	for (size_t index = 0; index < m_histogram.size() - 1; ++index) {
-		double merge_criteria = bin_merge_criteria(m_histogram[index], m_histogram[index + 1]);
-		if (best_merge_index == -1 || math_utils::cmp(merge_criteria, best_merge_criteria) < 0) {
-			best_merge_index = index;
-			best_merge_criteria = merge_criteria;
+	// remove excess empty bins from histogram before merging
+	remove_empty_bins();
+
+	while (m_bin_centers.size() > m_config.histogram_bins) {
+		// merge bins with the closest centers
+		const value_type* centers = m_bin_centers.data();
+		const size_t bins_count = m_bin_centers.size();
+
+		size_t best_merge_index = 0;
+		double best_merge_distance = centers[1] - centers[0];
+		for (size_t index = 1; index + 1 < bins_count; ++index) {
+			const double distance = centers[index + 1] - centers[index];
+			if (distance < best_merge_distance) {
+				best_merge_index = index;
+				best_merge_distance = distance;
+			}
 		}
-	}
 
-	auto& left_bin = m_histogram[best_merge_index];
-	auto& right_bin = m_histogram[best_merge_index + 1];
+		merge_bins(best_merge_index);
+	}
+}
 
-	if (math_utils::cmp(std::get<BIN_COUNT>(left_bin), 0.0) <= 0 &&
-			math_utils::cmp(std::get<BIN_COUNT>(right_bin), 0.0) <= 0)
-	{
-		std::get<BIN_CENTER>(left_bin) =
-			math_utils::weighted_average(
-					std::get<BIN_CENTER>(left_bin), 1,
-					std::get<BIN_CENTER>(right_bin), 1
-				);
+void statistics::set_histogram(const histogram_type& histogram, const time_point& timestamp) {
+	m_bin_unit = timestamp.time_since_epoch().unit();
+	m_bin_clock = timestamp.clock();
 
-		std::get<BIN_COUNT>(left_bin) = 0;
+	m_bin_centers.clear();
+	m_bin_counts.clear();
+	m_bin_timestamps.clear();
 
-		std::get<BIN_TIMESTAMP>(left_bin) = time_point();
+	for (auto bin = histogram.begin(); bin != histogram.end(); ++bin) {
+		m_bin_centers.push_back(std::get<BIN_CENTER>(*bin));
+		m_bin_counts.push_back(std::get<BIN_COUNT>(*bin));
+		m_bin_timestamps.push_back(
+				math_utils::cmp(std::get<BIN_COUNT>(*bin), 0.0) <= 0 ? 0 : to_bin_timestamp(std::get<BIN_TIMESTAMP>(*bin))
+			);
 	}
-	else {
-		std::get<BIN_CENTER>(left_bin) =
-			math_utils::weighted_average(
-					std::get<BIN_CENTER>(left_bin), std::get<BIN_COUNT>(left_bin),
-					std::get<BIN_CENTER>(right_bin), std::get<BIN_COUNT>(right_bin)
-				);
+}
 
-		std::get<BIN_COUNT>(left_bin) += std::get<BIN_COUNT>(right_bin);
+statistics::histogram_type statistics::get_histogram() const {
+	histogram_type histogram;
+	histogram.reserve(m_bin_centers.size());
 
-		std::get<BIN_TIMESTAMP>(left_bin) = std::max(std::get<BIN_TIMESTAMP>(left_bin), std::get<BIN_TIMESTAMP>(right_bin));
+	for (size_t index = 0; index < m_bin_centers.size(); ++index) {
+		histogram.push_back(
+				bin_type(
+					m_bin_centers[index],
+					m_bin_counts[index],
+					m_bin_timestamps[index] == 0 ? time_point() : from_bin_timestamp(m_bin_timestamps[index])
+				)
+			);
 	}
 
-	m_histogram.erase(m_histogram.begin() + best_merge_index + 1);
+	return histogram;
 }
 
 void statistics::update(const value_type& value, const time_point& timestamp) {
@@ -520,6 +586,309 @@ void statistics::update_time(const time_point& timestamp) {
 	}
 }
 
+bool statistics::settled() const {
+	if (m_moving_count != 0 || m_moving_sum != 0 || m_rate != 0) {
+		return false;
+	}
+
+	for (size_t index = 0; index < m_bin_counts.size(); ++index) {
+		if (m_bin_counts[index] != 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void statistics::merge(const statistics& other) {
+	if (&other == this) {
+		const statistics copy(other);
+		merge(copy);
+		return;
+	}
+
+	// align both statistics to the common timestamp
+	statistics aligned(other);
+	const time_point timestamp = std::max(m_timestamp, other.m_timestamp);
+	update_time(timestamp);
+	aligned.update_time(timestamp);
+
+	if (computed(tag::rate)) {
+		m_rate += aligned.m_rate;
+	}
+
+	if (computed(tag::value)) {
+		if (aligned.m_data_timestamp >= m_data_timestamp) {
+			m_value = aligned.m_value;
+		}
+	}
+
+	if (computed(tag::min)) {
+		m_min = std::min(m_min, aligned.m_min);
+	}
+
+	if (computed(tag::max)) {
+		m_max = std::max(m_max, aligned.m_max);
+	}
+
+	if (computed(tag::sum)) {
+		m_sum += aligned.m_sum;
+	}
+
+	if (computed(tag::count)) {
+		m_count += aligned.m_count;
+	}
+
+	if (computed(tag::moving_count)) {
+		m_moving_count += aligned.m_moving_count;
+	}
+
+	if (computed(tag::moving_sum)) {
+		m_moving_sum += aligned.m_moving_sum;
+	}
+
+	if (computed(tag::histogram) && m_config.histogram_bins > 0 && !aligned.m_bin_centers.empty()) {
+		if (m_bin_centers.empty()) {
+			m_bin_unit = aligned.m_bin_unit;
+			m_bin_clock = aligned.m_bin_clock;
+		}
+
+		const size_t bins_count = m_bin_centers.size() + aligned.m_bin_centers.size();
+
+		std::vector<value_type> centers;
+		std::vector<double> counts;
+		std::vector<int64_t> timestamps;
+		centers.reserve(bins_count);
+		counts.reserve(bins_count);
+		timestamps.reserve(bins_count);
+
+		const bool same_timestamps = m_bin_unit == aligned.m_bin_unit && m_bin_clock == aligned.m_bin_clock;
+
+		size_t left = 0, right = 0;
+		while (left < m_bin_centers.size() || right < aligned.m_bin_centers.size()) {
+			if (right == aligned.m_bin_centers.size() ||
+					(left < m_bin_centers.size() && m_bin_centers[left] <= aligned.m_bin_centers[right])
+				)
+			{
+				centers.push_back(m_bin_centers[left]);
+				counts.push_back(m_bin_counts[left]);
+				timestamps.push_back(m_bin_timestamps[left]);
+				++left;
+			}
+			else {
+				const int64_t& bin_timestamp = aligned.m_bin_timestamps[right];
+				centers.push_back(aligned.m_bin_centers[right]);
+				counts.push_back(aligned.m_bin_counts[right]);
+				timestamps.push_back(
+						same_timestamps || bin_timestamp == 0 ?
+							bin_timestamp :
+							to_bin_timestamp(aligned.from_bin_timestamp(bin_timestamp))
+					);
+				++right;
+			}
+		}
+
+		m_bin_centers.swap(centers);
+		m_bin_counts.swap(counts);
+		m_bin_timestamps.swap(timestamps);
+
+		compress_histogram();
+	}
+
+	if (computed(tag::timestamp)) {
+		m_timestamp = std::max(m_timestamp, aligned.m_timestamp);
+
+		m_data_timestamp = std::max(m_data_timestamp, aligned.m_data_timestamp);
+	}
+}
+
+statistics::statistics(const snapshot_type& snapshot)
+	: m_config(snapshot.config)
+{
+	reset();
+
+	m_value = snapshot.value;
+	m_min = snapshot.min;
+	m_max = snapshot.max;
+	m_sum = snapshot.sum;
+	m_count = snapshot.count;
+	m_moving_count = snapshot.moving_count;
+	m_moving_sum = snapshot.moving_sum;
+	set_histogram(snapshot.histogram, snapshot.data_timestamp);
+	m_timestamp = snapshot.timestamp;
+	m_rate = snapshot.rate;
+
+	m_data_timestamp = snapshot.data_timestamp;
+}
+
+statistics::snapshot_type statistics::snapshot() const {
+	snapshot_type snapshot;
+
+	snapshot.config = m_config;
+
+	snapshot.value = m_value;
+	snapshot.min = m_min;
+	snapshot.max = m_max;
+	snapshot.sum = m_sum;
+	snapshot.count = m_count;
+	snapshot.moving_count = m_moving_count;
+	snapshot.moving_sum = m_moving_sum;
+	snapshot.rate = m_rate;
+	snapshot.histogram = get_histogram();
+	snapshot.timestamp = m_timestamp;
+	snapshot.data_timestamp = m_data_timestamp;
+
+	return snapshot;
+}
+
+// snapshot serialization
+namespace {
+
+static const uint32_t SNAPSHOT_FORMAT_VERSION = 1;
+
+template <typename T>
+void write_raw(std::string& buffer, const T& value) {
+	buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void write_duration(std::string& buffer, const chrono::duration& d) {
+	write_raw<int64_t>(buffer, d.count());
+	write_raw<uint8_t>(buffer, static_cast<uint8_t>(d.unit()));
+}
+
+void write_time_point(std::string& buffer, const chrono::time_point& t) {
+	write_duration(buffer, t.time_since_epoch());
+	write_raw<uint8_t>(buffer, static_cast<uint8_t>(t.clock()));
+}
+
+struct snapshot_reader {
+	snapshot_reader(const std::string& buffer)
+		: m_data(buffer.data())
+		, m_size(buffer.size())
+		, m_offset(0)
+	{}
+
+	template <typename T>
+	T read_raw() {
+		if (m_offset + sizeof(T) > m_size) {
+			throw std::invalid_argument("statistics snapshot: unexpected end of data");
+		}
+		T value;
+		memcpy(&value, m_data + m_offset, sizeof(T));
+		m_offset += sizeof(T);
+		return value;
+	}
+
+	chrono::time_unit read_unit() {
+		const uint8_t unit = read_raw<uint8_t>();
+		if (unit > static_cast<uint8_t>(chrono::time_unit::DAY)) {
+			throw std::invalid_argument("statistics snapshot: invalid time unit");
+		}
+		return static_cast<chrono::time_unit>(unit);
+	}
+
+	chrono::duration read_duration() {
+		const int64_t count = read_raw<int64_t>();
+		return chrono::duration(count, read_unit());
+	}
+
+	chrono::time_point read_time_point() {
+		const chrono::duration since_epoch = read_duration();
+		const uint8_t clock = read_raw<uint8_t>();
+		if (clock > static_cast<uint8_t>(chrono::clock_type::SYSTEM)) {
+			throw std::invalid_argument("statistics snapshot: invalid clock type");
+		}
+		return chrono::time_point(since_epoch, static_cast<chrono::clock_type>(clock));
+	}
+
+	bool finished() const {
+		return m_offset == m_size;
+	}
+
+private:
+	const char* m_data;
+	size_t m_size;
+	size_t m_offset;
+};
+
+} // unnamed namespace
+
+std::string statistics::snapshot_type::serialize() const {
+	std::string buffer;
+	buffer.reserve(128 + histogram.size() * (2 * sizeof(double) + 10));
+
+	write_raw<uint32_t>(buffer, SNAPSHOT_FORMAT_VERSION);
+
+	write_duration(buffer, config.moving_interval);
+	write_raw<uint64_t>(buffer, config.histogram_bins);
+	write_raw<int32_t>(buffer, config.tags);
+	write_raw<uint8_t>(buffer, static_cast<uint8_t>(config.rate_unit));
+
+	write_raw<value_type>(buffer, value);
+	write_raw<value_type>(buffer, min);
+	write_raw<value_type>(buffer, max);
+	write_raw<value_type>(buffer, sum);
+	write_raw<uint64_t>(buffer, count);
+	write_raw<double>(buffer, moving_count);
+	write_raw<double>(buffer, moving_sum);
+	write_raw<double>(buffer, rate);
+	write_time_point(buffer, timestamp);
+	write_time_point(buffer, data_timestamp);
+
+	write_raw<uint64_t>(buffer, histogram.size());
+	for (auto bin = histogram.begin(); bin != histogram.end(); ++bin) {
+		write_raw<value_type>(buffer, std::get<BIN_CENTER>(*bin));
+		write_raw<double>(buffer, std::get<BIN_COUNT>(*bin));
+		write_time_point(buffer, std::get<BIN_TIMESTAMP>(*bin));
+	}
+
+	return buffer;
+}
+
+statistics::snapshot_type statistics::snapshot_type::deserialize(const std::string& buffer) {
+	snapshot_reader reader(buffer);
+
+	if (reader.read_raw<uint32_t>() != SNAPSHOT_FORMAT_VERSION) {
+		throw std::invalid_argument("statistics snapshot: unsupported format version");
+	}
+
+	snapshot_type snapshot;
+
+	snapshot.config.moving_interval = reader.read_duration();
+	snapshot.config.histogram_bins = reader.read_raw<uint64_t>();
+	snapshot.config.tags = reader.read_raw<int32_t>();
+	snapshot.config.rate_unit = reader.read_unit();
+
+	snapshot.value = reader.read_raw<value_type>();
+	snapshot.min = reader.read_raw<value_type>();
+	snapshot.max = reader.read_raw<value_type>();
+	snapshot.sum = reader.read_raw<value_type>();
+	snapshot.count = reader.read_raw<uint64_t>();
+	snapshot.moving_count = reader.read_raw<double>();
+	snapshot.moving_sum = reader.read_raw<double>();
+	snapshot.rate = reader.read_raw<double>();
+	snapshot.timestamp = reader.read_time_point();
+	snapshot.data_timestamp = reader.read_time_point();
+
+	const uint64_t bins_count = reader.read_raw<uint64_t>();
+	if (bins_count > buffer.size()) {
+		throw std::invalid_argument("statistics snapshot: invalid histogram size");
+	}
+	snapshot.histogram.reserve(bins_count);
+	for (uint64_t index = 0; index < bins_count; ++index) {
+		const value_type center = reader.read_raw<value_type>();
+		const double count = reader.read_raw<double>();
+		const time_point timestamp = reader.read_time_point();
+		snapshot.histogram.push_back(bin_type(center, count, timestamp));
+	}
+
+	if (!reader.finished()) {
+		throw std::invalid_argument("statistics snapshot: trailing data");
+	}
+
+	return snapshot;
+}
+
 // get_impl
 template <>
 statistics::result_type<statistics::tag::value>::type
@@ -644,7 +1013,7 @@ statistics::result_type<statistics::tag::histogram>::type
 statistics::get_impl<statistics::tag::histogram>() const
 {
 	if (computed(tag::histogram)) {
-		return m_histogram;
+		return get_histogram();
 	}
 	else {
 		throw invalid_tag_error();
@@ -703,43 +1072,44 @@ statistics::result_type<statistics::tag::entropy>::type
 statistics::get_impl<statistics::tag::entropy>() const
 {
 	if (computed(tag::entropy)) {
-		const auto& histogram = m_histogram;
+		const auto& centers = m_bin_centers;
+		const auto& counts = m_bin_counts;
+		const size_t bins_count = centers.size();
 
-		if (histogram.size() <= 1) {
+		if (bins_count <= 1) {
 			return 0;
 		}
 
 		double moving_count = 0;
-		for (auto bin = histogram.begin(); bin != histogram.end(); ++bin) {
-			moving_count += std::get<BIN_COUNT>(*bin);
+		for (size_t bin_index = 0; bin_index < bins_count; ++bin_index) {
+			moving_count += counts[bin_index];
 		}
 		if (math_utils::cmp<double>(moving_count, 0) <= 0) {
 			return 0;
 		}
 
 		double H = 0;
-		for (size_t bin_index = 0; bin_index < histogram.size(); ++bin_index) {
-			const auto& bin = histogram[bin_index];
-			if (math_utils::cmp<double>(std::get<BIN_COUNT>(bin), 0) <= 0) {
+		for (size_t bin_index = 0; bin_index < bins_count; ++bin_index) {
+			if (math_utils::cmp<double>(counts[bin_index], 0) <= 0) {
 				continue;
 			}
 
 			double bin_width = 0;
 			if (bin_index > 0) {
 				bin_width +=
-					(std::get<BIN_CENTER>(bin) - std::get<BIN_CENTER>(histogram[bin_index - 1])) *
-						std::get<BIN_COUNT>(bin) / (std::get<BIN_COUNT>(bin) + std::get<BIN_COUNT>(histogram[bin_index - 1]));
+					(centers[bin_index] - centers[bin_index - 1]) *
+						counts[bin_index] / (counts[bin_index] + counts[bin_index - 1]);
 			}
-			if (bin_index < histogram.size() - 1) {
+			if (bin_index < bins_count - 1) {
 				bin_width +=
-					(std::get<BIN_CENTER>(histogram[bin_index + 1]) - std::get<BIN_CENTER>(bin)) *
-						std::get<BIN_COUNT>(bin) / (std::get<BIN_COUNT>(bin) + std::get<BIN_COUNT>(histogram[bin_index + 1]));
+					(centers[bin_index + 1] - centers[bin_index]) *
+						counts[bin_index] / (counts[bin_index] + counts[bin_index + 1]);
 			}
-			if (bin_index == 0 || bin_index == histogram.size() - 1) {
+			if (bin_index == 0 || bin_index == bins_count - 1) {
 				bin_width *= 2;
 			}
 
-			H -= std::get<BIN_COUNT>(bin) * log(std::get<BIN_COUNT>(bin) / moving_count / bin_width) / moving_count ;
+			H -= counts[bin_index] * log(counts[bin_index] / moving_count / bin_width) / moving_count ;
 		}
 
 		return H;
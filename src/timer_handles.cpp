@@ -0,0 +1,203 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <map>
+#include <mutex>
+
+#include <handystats/chrono.hpp>
+#include <handystats/metrics.hpp>
+
+#include "events/event_message_impl.hpp"
+#include "events/timer_impl.hpp"
+#include "message_queue_impl.hpp"
+#include "internal_impl.hpp"
+#include "core_impl.hpp"
+
+#include "timer_handles_impl.hpp"
+
+handystats_timer_handle::handystats_timer_handle(const std::string& timer_name, handystats_timer_handle* next)
+	: timer_name(timer_name)
+	, next(next)
+	, enqueue_position(0)
+	, dequeue_position(0)
+	, metric(nullptr)
+	, timer(nullptr)
+	, mismatched(false)
+	, pending(false)
+	, pending_next(nullptr)
+{
+	for (size_t index = 0; index < RING_SIZE; ++index) {
+		ring[index].sequence.store(index, std::memory_order_relaxed);
+	}
+}
+
+/*
+ * http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+ */
+bool handystats_timer_handle::push(const int64_t& start_time, const int64_t& end_time) {
+	uint64_t position = enqueue_position.load(std::memory_order_relaxed);
+	cell* target = nullptr;
+
+	while (true) {
+		target = &ring[position & (RING_SIZE - 1)];
+		const uint64_t sequence = target->sequence.load(std::memory_order_acquire);
+		const int64_t diff = int64_t(sequence) - int64_t(position);
+
+		if (diff == 0) {
+			if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		else if (diff < 0) {
+			return false;
+		}
+		else {
+			position = enqueue_position.load(std::memory_order_relaxed);
+		}
+	}
+
+	target->start_time = start_time;
+	target->end_time = end_time;
+	target->sequence.store(position + 1, std::memory_order_release);
+
+	return true;
+}
+
+bool handystats_timer_handle::pop(int64_t& start_time, int64_t& end_time) {
+	cell& target = ring[dequeue_position & (RING_SIZE - 1)];
+	if (target.sequence.load(std::memory_order_acquire) != dequeue_position + 1) {
+		return false;
+	}
+
+	start_time = target.start_time;
+	end_time = target.end_time;
+	target.sequence.store(dequeue_position + RING_SIZE, std::memory_order_release);
+	++dequeue_position;
+
+	return true;
+}
+
+
+namespace handystats { namespace timer_handles {
+
+static std::mutex handles_mutex;
+static std::map<std::string, handystats_timer_handle*> handles_map;
+static std::atomic<handystats_timer_handle*> handles_list(nullptr);
+
+// handles with new measurements, each handle is in the list at most once (while its pending flag is set)
+static std::atomic<handystats_timer_handle*> pending_list(nullptr);
+
+handystats_timer_handle* resolve(const std::string& timer_name) {
+	std::lock_guard<std::mutex> lock(handles_mutex);
+
+	auto& handle = handles_map[timer_name];
+	if (!handle) {
+		handle = new handystats_timer_handle(timer_name, handles_list.load(std::memory_order_acquire));
+		handles_list.store(handle, std::memory_order_release);
+	}
+
+	return handle;
+}
+
+void record(handystats_timer_handle* handle, const int64_t& start_time, const int64_t& end_time) {
+	if (!handle) {
+		return;
+	}
+
+	if (handle->push(start_time, end_time)) {
+		// exchange orders the push before the flag, so the processor that clears the flag sees the measurement,
+		// otherwise the flag was clear and the handle is listed again
+		if (!handle->pending.exchange(true, std::memory_order_acq_rel)) {
+			handle->pending_next = pending_list.load(std::memory_order_relaxed);
+			while (!pending_list.compare_exchange_weak(handle->pending_next, handle,
+						std::memory_order_release, std::memory_order_relaxed)
+				)
+			{
+			}
+		}
+		return;
+	}
+
+	// processor falls behind, pass measurement as usual event
+	const chrono::time_unit tsc_unit = chrono::tsc_clock::now().time_since_epoch().unit();
+	message_queue::push(
+			events::timer::create_set_event(
+				std::string(handle->timer_name),
+				chrono::duration(end_time - start_time, tsc_unit),
+				chrono::time_point(chrono::duration(end_time, tsc_unit), chrono::clock_type::TSC)
+			)
+		);
+}
+
+void process() {
+	if (!pending_list.load(std::memory_order_relaxed)) {
+		return;
+	}
+
+	const chrono::time_unit tsc_unit = chrono::tsc_clock::now().time_since_epoch().unit();
+
+	auto* handle = pending_list.exchange(nullptr, std::memory_order_acquire);
+	while (handle) {
+		// handle could be listed again once its flag is cleared
+		auto* const next = handle->pending_next;
+		handle->pending.exchange(false, std::memory_order_acq_rel);
+
+		int64_t start_time, end_time;
+		while (handle->pop(start_time, end_time)) {
+			if (handle->mismatched) {
+				continue;
+			}
+			if (!handle->timer) {
+				auto& metric = internal::find_metric(handle->timer_name, events::event_destination_type::TIMER);
+				if (metric.second.metric.which() != metrics::metric_index::TIMER) {
+					handle->mismatched = true;
+					continue;
+				}
+				handle->metric = &metric;
+				handle->timer = boost::get<metrics::timer*>(metric.second.metric);
+			}
+
+			handle->timer->set(
+					chrono::duration(end_time - start_time, tsc_unit),
+					chrono::time_point(chrono::duration(end_time, tsc_unit), chrono::clock_type::TSC)
+				);
+			internal::mark_active(*handle->metric);
+		}
+
+		handle = next;
+	}
+}
+
+void initialize() {
+	finalize();
+}
+
+void finalize() {
+	// drop pending measurements and cached metrics
+	for (auto* handle = handles_list.load(std::memory_order_acquire); handle; handle = handle->next) {
+		int64_t start_time, end_time;
+		while (handle->pop(start_time, end_time)) {
+		}
+		handle->metric = nullptr;
+		handle->timer = nullptr;
+		handle->mismatched = false;
+		handle->pending.store(false, std::memory_order_release);
+	}
+	pending_list.store(nullptr, std::memory_order_release);
+}
+
+}} // namespace handystats::timer_handles
@@ -0,0 +1,85 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_TIMER_HANDLES_IMPL_HPP_
+#define HANDYSTATS_TIMER_HANDLES_IMPL_HPP_
+
+#include <cstdint>
+#include <string>
+
+#include <handystats/atomic.hpp>
+#include <handystats/metrics/timer.hpp>
+#include <handystats/measuring_points/timer.h>
+
+#include "internal_impl.hpp"
+
+/*
+ * Pre-resolved timer handle
+ * Handles are never destroyed, so pointers to them could be stored by the measuring side
+ * Measurements are passed to the processor via bounded lock-free ring, no event is allocated
+ * Ring is kept small since every handle lives forever, overflowing measurements go through message queue
+ */
+struct handystats_timer_handle {
+	static const size_t RING_SIZE = 64;
+
+	struct cell {
+		std::atomic<uint64_t> sequence;
+		int64_t start_time;
+		int64_t end_time;
+	};
+
+	const std::string timer_name;
+	handystats_timer_handle* const next;
+
+	std::atomic<uint64_t> enqueue_position;
+	cell ring[RING_SIZE];
+	uint64_t dequeue_position;
+
+	// processor's side cache of the metric
+	handystats::internal::metrics_map_type::value_type* metric;
+	handystats::metrics::timer* timer;
+	// set if timer's name is bound to other metric's type, measurements are dropped without lookup
+	bool mismatched;
+
+	// set by the measuring side when the handle is put into the list of handles to process
+	std::atomic<bool> pending;
+	handystats_timer_handle* pending_next;
+
+	handystats_timer_handle(const std::string& timer_name, handystats_timer_handle* next);
+
+	// returns false if ring is full
+	bool push(const int64_t& start_time, const int64_t& end_time);
+	bool pop(int64_t& start_time, int64_t& end_time);
+};
+
+namespace handystats { namespace timer_handles {
+
+handystats_timer_handle* resolve(const std::string& timer_name);
+
+void record(handystats_timer_handle* handle, const int64_t& start_time, const int64_t& end_time);
+
+// pass pending measurements to the timers
+// only handles with new measurements are visited
+void process();
+
+void initialize();
+void finalize();
+
+}} // namespace handystats::timer_handles
+
+
+#endif // HANDYSTATS_TIMER_HANDLES_IMPL_HPP_
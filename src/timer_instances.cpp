@@ -0,0 +1,440 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <functional>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+#include "config_impl.hpp"
+
+#include "timer_instances_impl.hpp"
+
+/*
+ * Instances are kept in the table of the thread that has started them,
+ * so restart and stop on the same thread lock only the thread's own (uncontended) mutex and never allocate.
+ * New instance is looked up elsewhere first, so each instance is kept in the single table.
+ * Instances that don't fit the thread's table are kept in the shared table.
+ * Operations on instances started by other threads look them up in the shared table
+ * and then in tables of other threads.
+ * Instances left in the table of finished thread are moved into the shared table.
+ * Expired instances are swept by the processor thread, incrementally for the shared table.
+ */
+
+namespace {
+
+using handystats::metrics::timer;
+
+struct instance_key {
+	std::string timer_name;
+	timer::instance_id_type instance_id;
+
+	bool operator==(const instance_key& other) const {
+		return instance_id == other.instance_id && timer_name == other.timer_name;
+	}
+};
+
+struct instance_key_hash {
+	size_t operator()(const instance_key& key) const {
+		return std::hash<std::string>()(key.timer_name) ^ (key.instance_id * 0x9e3779b97f4a7c15ULL);
+	}
+};
+
+typedef std::unordered_map<instance_key, timer::instance_state, instance_key_hash> instances_map;
+
+const size_t LOCAL_CAPACITY = 16;
+
+struct local_instance {
+	std::string timer_name;
+	timer::instance_id_type instance_id;
+	timer::instance_state state;
+};
+
+struct local_table {
+	std::mutex mutex;
+	// the first `size` instances are running, strings of the others are kept for reuse
+	local_instance instances[LOCAL_CAPACITY];
+	size_t size;
+
+	local_table();
+	~local_table();
+
+	local_instance* find(const std::string& timer_name, const timer::instance_id_type& instance_id) {
+		for (size_t index = 0; index < size; ++index) {
+			if (instances[index].instance_id == instance_id && instances[index].timer_name == timer_name) {
+				return instances + index;
+			}
+		}
+		return nullptr;
+	}
+
+	void erase(local_instance* instance) {
+		--size;
+		if (instance != instances + size) {
+			instance->timer_name.swap(instances[size].timer_name);
+			instance->instance_id = instances[size].instance_id;
+			instance->state = instances[size].state;
+		}
+	}
+};
+
+// lock order: tables_mutex, local_table::mutex, shared_mutex
+std::mutex tables_mutex;
+std::vector<local_table*> tables;
+
+std::mutex shared_mutex;
+instances_map shared_instances;
+
+local_table::local_table()
+	: size(0)
+{
+	std::lock_guard<std::mutex> lock(tables_mutex);
+	tables.push_back(this);
+}
+
+local_table::~local_table() {
+	std::lock_guard<std::mutex> tables_lock(tables_mutex);
+	tables.erase(std::find(tables.begin(), tables.end(), this));
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (size > 0) {
+		std::lock_guard<std::mutex> shared_lock(shared_mutex);
+		for (size_t index = 0; index < size; ++index) {
+			instance_key key = {std::move(instances[index].timer_name), instances[index].instance_id};
+			shared_instances[std::move(key)] = instances[index].state;
+		}
+	}
+}
+
+thread_local local_table this_thread_table;
+
+enum lookup_result {
+	NOT_FOUND,
+	FOUND,
+	// instance has expired and has been removed
+	EXPIRED
+};
+
+// applies action to the instance found in the shared table or in tables of other threads
+template <typename Action>
+lookup_result apply_elsewhere(
+		std::string& timer_name,
+		const timer::instance_id_type& instance_id,
+		const handystats::chrono::time_point& timestamp,
+		Action action
+	)
+{
+	const auto& idle_timeout = handystats::config::metrics::timer_opts.idle_timeout;
+
+	instance_key key = {std::move(timer_name), instance_id};
+	lookup_result result = NOT_FOUND;
+	{
+		std::lock_guard<std::mutex> lock(shared_mutex);
+
+		auto instance = shared_instances.find(key);
+		if (instance != shared_instances.end()) {
+			if (instance->second.expired(idle_timeout, timestamp)) {
+				shared_instances.erase(instance);
+				result = EXPIRED;
+			}
+			else if (action(instance->second)) {
+				shared_instances.erase(instance);
+				result = FOUND;
+			}
+			else {
+				result = FOUND;
+			}
+		}
+	}
+	timer_name = std::move(key.timer_name);
+
+	if (result != NOT_FOUND) {
+		return result;
+	}
+
+	std::lock_guard<std::mutex> tables_lock(tables_mutex);
+	for (auto table_iter = tables.begin(); table_iter != tables.end(); ++table_iter) {
+		local_table& table = **table_iter;
+		if (&table == &this_thread_table) {
+			continue;
+		}
+
+		std::lock_guard<std::mutex> lock(table.mutex);
+		local_instance* instance = table.find(timer_name, instance_id);
+		if (instance) {
+			if (instance->state.expired(idle_timeout, timestamp)) {
+				table.erase(instance);
+				return EXPIRED;
+			}
+			if (action(instance->state)) {
+				table.erase(instance);
+			}
+			return FOUND;
+		}
+	}
+
+	return NOT_FOUND;
+}
+
+// the first expired instances are looked for in the shared table at this bucket
+size_t sweep_bucket = 0;
+bool sweep_running = false;
+handystats::chrono::time_point sweep_timestamp;
+
+// number of buckets of the shared table swept at once
+const size_t SWEEP_BUCKETS = 64;
+
+} // unnamed namespace
+
+namespace handystats { namespace timer_instances {
+
+bool enabled() {
+	return config::metrics::timer_opts.local_instances;
+}
+
+void start(
+		std::string& timer_name,
+		const metrics::timer::instance_id_type& instance_id,
+		const chrono::time_point& timestamp
+	)
+{
+	local_table& table = this_thread_table;
+	{
+		std::lock_guard<std::mutex> lock(table.mutex);
+
+		local_instance* instance = table.find(timer_name, instance_id);
+		if (instance) {
+			instance->state.start_timestamp = timestamp;
+			instance->state.heartbeat_timestamp = timestamp;
+			return;
+		}
+	}
+
+	// instance could have been started by other thread or moved into the shared table, it's restarted in place
+	const lookup_result result = apply_elsewhere(timer_name, instance_id, timestamp,
+			[&timestamp] (metrics::timer::instance_state& state) {
+				state.start_timestamp = timestamp;
+				state.heartbeat_timestamp = timestamp;
+				return false;
+			}
+		);
+	if (result == FOUND) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(table.mutex);
+
+		if (table.size < LOCAL_CAPACITY) {
+			local_instance* instance = table.instances + table.size++;
+			// string's capacity is reused
+			instance->timer_name.assign(timer_name);
+			instance->instance_id = instance_id;
+			instance->state.start_timestamp = timestamp;
+			instance->state.heartbeat_timestamp = timestamp;
+			return;
+		}
+	}
+
+	instance_key key = {std::move(timer_name), instance_id};
+	{
+		std::lock_guard<std::mutex> lock(shared_mutex);
+
+		auto& state = shared_instances[key];
+		state.start_timestamp = timestamp;
+		state.heartbeat_timestamp = timestamp;
+	}
+	timer_name = std::move(key.timer_name);
+}
+
+bool stop(
+		std::string& timer_name,
+		const metrics::timer::instance_id_type& instance_id,
+		const chrono::time_point& timestamp,
+		metrics::timer::value_type& measurement
+	)
+{
+	local_table& table = this_thread_table;
+	{
+		std::lock_guard<std::mutex> lock(table.mutex);
+
+		local_instance* instance = table.find(timer_name, instance_id);
+		if (instance) {
+			const bool measured = !instance->state.expired(config::metrics::timer_opts.idle_timeout, timestamp);
+			if (measured) {
+				measurement = timestamp - instance->state.start_timestamp;
+			}
+			table.erase(instance);
+			return measured;
+		}
+	}
+
+	const lookup_result result = apply_elsewhere(timer_name, instance_id, timestamp,
+			[&measurement, &timestamp] (metrics::timer::instance_state& state) {
+				measurement = timestamp - state.start_timestamp;
+				return true;
+			}
+		);
+
+	return result == FOUND;
+}
+
+void heartbeat(
+		std::string& timer_name,
+		const metrics::timer::instance_id_type& instance_id,
+		const chrono::time_point& timestamp
+	)
+{
+	local_table& table = this_thread_table;
+	{
+		std::lock_guard<std::mutex> lock(table.mutex);
+
+		local_instance* instance = table.find(timer_name, instance_id);
+		if (instance) {
+			if (instance->state.expired(config::metrics::timer_opts.idle_timeout, timestamp)) {
+				table.erase(instance);
+			}
+			else {
+				instance->state.heartbeat_timestamp = timestamp;
+			}
+			return;
+		}
+	}
+
+	apply_elsewhere(timer_name, instance_id, timestamp,
+			[&timestamp] (metrics::timer::instance_state& state) {
+				state.heartbeat_timestamp = timestamp;
+				return false;
+			}
+		);
+}
+
+void discard(
+		std::string& timer_name,
+		const metrics::timer::instance_id_type& instance_id,
+		const chrono::time_point& timestamp
+	)
+{
+	local_table& table = this_thread_table;
+	{
+		std::lock_guard<std::mutex> lock(table.mutex);
+
+		local_instance* instance = table.find(timer_name, instance_id);
+		if (instance) {
+			table.erase(instance);
+			return;
+		}
+	}
+
+	apply_elsewhere(timer_name, instance_id, timestamp,
+			[] (metrics::timer::instance_state&) {
+				return true;
+			}
+		);
+}
+
+void sweep(const chrono::time_point& timestamp) {
+	const auto& idle_timeout = config::metrics::timer_opts.idle_timeout;
+
+	if (!sweep_running) {
+		if (timestamp < sweep_timestamp + idle_timeout) {
+			return;
+		}
+
+		// tables of threads are small, so they are swept at once
+		std::lock_guard<std::mutex> tables_lock(tables_mutex);
+		for (auto table_iter = tables.begin(); table_iter != tables.end(); ++table_iter) {
+			local_table& table = **table_iter;
+			std::lock_guard<std::mutex> lock(table.mutex);
+			for (size_t index = 0; index < table.size; ) {
+				if (table.instances[index].state.expired(idle_timeout, timestamp)) {
+					table.erase(table.instances + index);
+				}
+				else {
+					++index;
+				}
+			}
+		}
+
+		sweep_running = true;
+		sweep_bucket = 0;
+		sweep_timestamp = timestamp;
+	}
+
+	std::vector<instance_key> expired;
+	{
+		std::lock_guard<std::mutex> lock(shared_mutex);
+
+		const size_t buckets_count = shared_instances.bucket_count();
+		const size_t last_bucket = std::min(sweep_bucket + SWEEP_BUCKETS, buckets_count);
+		for (; sweep_bucket < last_bucket; ++sweep_bucket) {
+			for (auto instance = shared_instances.begin(sweep_bucket); instance != shared_instances.end(sweep_bucket); ++instance) {
+				if (instance->second.expired(idle_timeout, timestamp)) {
+					expired.push_back(instance->first);
+				}
+			}
+		}
+		for (auto key = expired.begin(); key != expired.end(); ++key) {
+			shared_instances.erase(*key);
+		}
+
+		if (sweep_bucket >= buckets_count) {
+			sweep_running = false;
+		}
+	}
+}
+
+size_t size() {
+	size_t total_size = 0;
+	{
+		std::lock_guard<std::mutex> tables_lock(tables_mutex);
+		for (auto table_iter = tables.begin(); table_iter != tables.end(); ++table_iter) {
+			std::lock_guard<std::mutex> lock((*table_iter)->mutex);
+			total_size += (*table_iter)->size;
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lock(shared_mutex);
+		total_size += shared_instances.size();
+	}
+	return total_size;
+}
+
+void initialize() {
+	finalize();
+}
+
+void finalize() {
+	{
+		std::lock_guard<std::mutex> tables_lock(tables_mutex);
+		for (auto table_iter = tables.begin(); table_iter != tables.end(); ++table_iter) {
+			std::lock_guard<std::mutex> lock((*table_iter)->mutex);
+			(*table_iter)->size = 0;
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lock(shared_mutex);
+		shared_instances.clear();
+	}
+
+	sweep_running = false;
+	sweep_bucket = 0;
+	sweep_timestamp = chrono::time_point();
+}
+
+}} // namespace handystats::timer_instances
@@ -0,0 +1,72 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#ifndef HANDYSTATS_TIMER_INSTANCES_IMPL_HPP_
+#define HANDYSTATS_TIMER_INSTANCES_IMPL_HPP_
+
+#include <string>
+
+#include <handystats/chrono.hpp>
+#include <handystats/metrics/timer.hpp>
+
+// Measuring side table of running timer instances
+// Instances are keyed by (timer name, instance id), start and stop on the same thread are the cheapest,
+// but they could be called from different threads as well
+namespace handystats { namespace timer_instances {
+
+bool enabled();
+
+void start(
+		std::string& timer_name,
+		const metrics::timer::instance_id_type& instance_id,
+		const chrono::time_point& timestamp
+	);
+
+// returns true if instance was running and hasn't expired
+// timer_name is left intact
+bool stop(
+		std::string& timer_name,
+		const metrics::timer::instance_id_type& instance_id,
+		const chrono::time_point& timestamp,
+		metrics::timer::value_type& measurement
+	);
+
+void heartbeat(
+		std::string& timer_name,
+		const metrics::timer::instance_id_type& instance_id,
+		const chrono::time_point& timestamp
+	);
+
+void discard(
+		std::string& timer_name,
+		const metrics::timer::instance_id_type& instance_id,
+		const chrono::time_point& timestamp
+	);
+
+// Removes expired instances, called by the processor thread only.
+// Shared table is swept incrementally, so the call never takes long.
+void sweep(const chrono::time_point& timestamp);
+
+size_t size();
+
+void initialize();
+void finalize();
+
+}} // namespace handystats::timer_instances
+
+
+#endif // HANDYSTATS_TIMER_INSTANCES_IMPL_HPP_
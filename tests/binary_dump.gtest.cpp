@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) YANDEX LLC. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+
+#include <string>
+#include <memory>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include <handystats/core.hpp>
+#include <handystats/measuring_points.hpp>
+#include <handystats/metrics_dump.hpp>
+#include <handystats/binary_dump.hpp>
+
+#include "message_queue_helper.hpp"
+#include "metrics_dump_helper.hpp"
+
+using handystats::statistics;
+using handystats::metrics::metric_index;
+
+namespace {
+
+uint64_t system_timestamp(const handystats::chrono::time_point& timestamp) {
+	const auto& system_time = handystats::chrono::time_point::convert_to(handystats::chrono::clock_type::SYSTEM, timestamp);
+	return handystats::chrono::duration::convert_to(handystats::chrono::time_unit::MSEC, system_time.time_since_epoch()).count();
+}
+
+void check_statistics(const statistics& expected, const handystats::binary::statistics_view& actual) {
+	ASSERT_EQ(expected.tags(), actual.tags());
+
+	if (expected.enabled(statistics::tag::value)) {
+		ASSERT_DOUBLE_EQ(expected.get<statistics::tag::value>(), actual.get(statistics::tag::value));
+	}
+	if (expected.enabled(statistics::tag::min)) {
+		ASSERT_DOUBLE_EQ(expected.get<statistics::tag::min>(), actual.get(statistics::tag::min));
+	}
+	if (expected.enabled(statistics::tag::max)) {
+		ASSERT_DOUBLE_EQ(expected.get<statistics::tag::max>(), actual.get(statistics::tag::max));
+	}
+	if (expected.enabled(statistics::tag::count)) {
+		ASSERT_EQ(expected.get<statistics::tag::count>(), actual.count());
+	}
+	if (expected.enabled(statistics::tag::sum)) {
+		ASSERT_DOUBLE_EQ(expected.get<statistics::tag::sum>(), actual.get(statistics::tag::sum));
+	}
+	if (expected.enabled(statistics::tag::avg)) {
+		ASSERT_DOUBLE_EQ(expected.get<statistics::tag::avg>(), actual.get(statistics::tag::avg));
+	}
+	if (expected.enabled(statistics::tag::moving_avg)) {
+		ASSERT_DOUBLE_EQ(expected.get<statistics::tag::moving_avg>(), actual.get(statistics::tag::moving_avg));
+	}
+	if (expected.enabled(statistics::tag::rate)) {
+		ASSERT_DOUBLE_EQ(expected.get<statistics::tag::rate>(), actual.get(statistics::tag::rate));
+	}
+	if (expected.enabled(statistics::tag::quantile)) {
+		for (size_t index = 0; index < handystats::binary::statistics_view::QUANTILES_COUNT; ++index) {
+			ASSERT_DOUBLE_EQ(
+					expected.get<statistics::tag::quantile>().at(handystats::binary::statistics_view::QUANTILES[index]),
+					actual.quantile(index)
+				);
+		}
+	}
+	if (expected.enabled(statistics::tag::histogram)) {
+		const auto& histogram = expected.get<statistics::tag::histogram>();
+		ASSERT_EQ(histogram.size(), actual.histogram_size());
+		for (size_t index = 0; index < histogram.size(); ++index) {
+			ASSERT_DOUBLE_EQ(std::get<statistics::BIN_CENTER>(histogram[index]), actual.histogram_bin(index).first);
+			ASSERT_DOUBLE_EQ(std::get<statistics::BIN_COUNT>(histogram[index]), actual.histogram_bin(index).second);
+		}
+	}
+	if (expected.enabled(statistics::tag::timestamp)) {
+		// tsc to system time conversion may drift between calls
+		ASSERT_NEAR(system_timestamp(expected.get<statistics::tag::timestamp>()), actual.timestamp(), 1);
+	}
+}
+
+} // unnamed namespace
+
+class BinaryDumpTest : public ::testing::Test {
+protected:
+	virtual void SetUp() {
+		HANDY_CONFIG_JSON(
+				"{\
+					\"dump-interval\": 10,\
+					\"gauge\": {\
+						\"tags\": [\"value\", \"min\", \"max\", \"count\", \"avg\", \"rate\", \"histogram\", \"quantile\", \"timestamp\"],\
+						\"histogram-bins\": 10\
+					},\
+					\"timer\": {\
+						\"exemplars\": 3\
+					},\
+					\"topk\": {\
+						\"size\": 2\
+					}\
+				}"
+			);
+
+		HANDY_INIT();
+	}
+	virtual void TearDown() {
+		HANDY_FINALIZE();
+	}
+};
+
+TEST_F(BinaryDumpTest, RoundTrip) {
+	for (int step = 0; step < 100; ++step) {
+		HANDY_GAUGE_SET("load", step % 17 - 5);
+		HANDY_COUNTER_INCREMENT("requests", step);
+		HANDY_TIMER_SET("request.time", handystats::chrono::duration(step, handystats::chrono::time_unit::MSEC));
+		HANDY_UNIQUE_ADD("users", uint64_t(step % 30));
+		HANDY_TOPK_ADD("clients", "client-" + std::to_string(step % 5), step % 5);
+		HANDY_SPAN_SCOPE("handler");
+	}
+
+	HANDY_ATTRIBUTE_SET_BOOL("attr.bool", true);
+	HANDY_ATTRIBUTE_SET_INT("attr.int", -42);
+	HANDY_ATTRIBUTE_SET_UINT("attr.uint", 42u);
+	HANDY_ATTRIBUTE_SET_INT64("attr.int64", -(int64_t(1) << 40));
+	HANDY_ATTRIBUTE_SET_UINT64("attr.uint64", uint64_t(1) << 63);
+	HANDY_ATTRIBUTE_SET_DOUBLE("attr.double", 0.125);
+	HANDY_ATTRIBUTE_SET_STRING("attr.string", "binary");
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	auto metrics_dump = HANDY_METRICS_DUMP();
+	const std::string& buffer = handystats::binary::to_string(*metrics_dump);
+
+	handystats::binary::reader reader(buffer);
+	ASSERT_EQ(reader.format_version(), handystats::binary::FORMAT_VERSION);
+	ASSERT_EQ(reader.version(), metrics_dump->version());
+	ASSERT_EQ(reader.size(), metrics_dump->size());
+
+	size_t index = 0;
+	for (auto metric_iter = metrics_dump->cbegin(); metric_iter != metrics_dump->cend(); ++metric_iter, ++index) {
+		const auto& view = reader[index];
+		ASSERT_EQ(metric_iter->first, view.name());
+		ASSERT_EQ(reader.find(metric_iter->first), index);
+		ASSERT_EQ(metric_iter->second.which(), view.type());
+
+		switch (view.type()) {
+			case metric_index::GAUGE:
+				check_statistics(boost::get<handystats::metrics::gauge>(metric_iter->second).values(), view.values());
+				break;
+			case metric_index::COUNTER:
+				check_statistics(boost::get<handystats::metrics::counter>(metric_iter->second).values(), view.values());
+				break;
+			case metric_index::TIMER:
+				{
+					const auto& timer = boost::get<handystats::metrics::timer>(metric_iter->second);
+					check_statistics(timer.values(), view.values());
+
+					const auto& expected = timer.exemplars();
+					const auto& actual = view.exemplars();
+					ASSERT_EQ(expected.size(), actual.size());
+					for (size_t exemplar = 0; exemplar < expected.size(); ++exemplar) {
+						ASSERT_EQ(expected[exemplar].value.count(), actual[exemplar].value);
+						ASSERT_EQ(expected[exemplar].instance_id, actual[exemplar].instance_id);
+					}
+					break;
+				}
+			case metric_index::ATTRIBUTE:
+				ASSERT_TRUE(boost::get<handystats::metrics::attribute>(metric_iter->second).value() == view.attribute_value());
+				break;
+			case metric_index::UNIQUE:
+				{
+					const auto& unique = boost::get<handystats::metrics::unique>(metric_iter->second);
+					ASSERT_DOUBLE_EQ(unique.estimate(), view.estimate());
+					ASSERT_DOUBLE_EQ(unique.total(), view.total());
+					ASSERT_NEAR(system_timestamp(unique.timestamp()), view.timestamp(), 1);
+					break;
+				}
+			case metric_index::TOPK:
+				{
+					const auto& topk = boost::get<handystats::metrics::topk>(metric_iter->second);
+					ASSERT_DOUBLE_EQ(topk.total(), view.total());
+
+					const auto& expected = topk.top();
+					const auto& actual = view.top();
+					ASSERT_EQ(expected.size(), actual.size());
+					for (size_t entry = 0; entry < expected.size(); ++entry) {
+						ASSERT_EQ(expected[entry].key, std::string(actual[entry].key_data, actual[entry].key_size));
+						ASSERT_DOUBLE_EQ(expected[entry].count, actual[entry].count);
+						ASSERT_DOUBLE_EQ(expected[entry].error, actual[entry].error);
+					}
+					ASSERT_NEAR(system_timestamp(topk.timestamp()), view.timestamp(), 1);
+					break;
+				}
+			case metric_index::SPAN:
+				{
+					const auto& span = boost::get<handystats::metrics::span>(metric_iter->second);
+					check_statistics(span.inclusive(), view.inclusive());
+					check_statistics(span.self(), view.self());
+					break;
+				}
+		}
+	}
+
+	ASSERT_EQ(reader.find("no.such.metric"), reader.size());
+
+	// metrics of every type took part in round trip
+	ASSERT_EQ(reader[reader.find("load")].values().histogram_size(), 10);
+	ASSERT_EQ(reader[reader.find("request.time")].exemplars().size(), 3);
+	ASSERT_EQ(boost::get<std::string>(reader[reader.find("attr.string")].attribute_value()), "binary");
+	ASSERT_EQ(boost::get<uint64_t>(reader[reader.find("attr.uint64")].attribute_value()), uint64_t(1) << 63);
+	ASSERT_EQ(reader[reader.find("clients")].top().size(), 2);
+	ASSERT_EQ(reader[reader.find("handler")].inclusive().count(), 100);
+	ASSERT_THROW(reader[reader.find("users")].values(), std::invalid_argument);
+}
+
+TEST_F(BinaryDumpTest, SharedBinaryIsRenderedOncePerVersion) {
+	HANDY_GAUGE_SET("gauge", 1);
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	auto metrics_dump = HANDY_METRICS_DUMP();
+	const auto& first = handystats::binary::to_shared_string(*metrics_dump);
+	const auto& second = handystats::binary::to_shared_string(*metrics_dump);
+	ASSERT_EQ(first.get(), second.get());
+
+	handystats::binary::reader reader(*first);
+	ASSERT_EQ(reader.version(), metrics_dump->version());
+	ASSERT_LT(reader.find("gauge"), reader.size());
+
+	handystats::binary::reader global(HANDY_BINARY_DUMP());
+	ASSERT_GE(global.version(), metrics_dump->version());
+}
+
+TEST_F(BinaryDumpTest, DumpViewIsSerialized) {
+	HANDY_GAUGE_SET("db.pool.size", 4);
+	HANDY_TIMER_SET("db.query.time", handystats::chrono::duration(1, handystats::chrono::time_unit::MSEC));
+	HANDY_COUNTER_INCREMENT("queue.size");
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	const auto& db_view = HANDY_METRICS_DUMP_PREFIX("db.");
+	handystats::binary::reader reader(handystats::binary::to_string(db_view));
+	ASSERT_EQ(reader.version(), db_view.version());
+	ASSERT_EQ(reader.size(), 2);
+	ASSERT_EQ(reader[0].name(), "db.pool.size");
+	ASSERT_EQ(reader[1].name(), "db.query.time");
+	ASSERT_EQ(reader.find("queue.size"), reader.size());
+
+	const auto& time_view = HANDY_METRICS_DUMP_GLOB("*.time");
+	handystats::binary::reader time_reader(handystats::binary::to_string(time_view));
+	ASSERT_EQ(time_reader.size(), 1);
+	ASSERT_EQ(time_reader[0].name(), "db.query.time");
+	ASSERT_EQ(time_reader[0].type(), handystats::metrics::metric_index::TIMER);
+}
+
+TEST(BinaryDumpReaderTest, MalformedDataThrows) {
+	handystats::metrics_dump::dump_map empty;
+	const std::string& buffer = handystats::binary::to_string(empty);
+
+	handystats::binary::reader reader(buffer);
+	ASSERT_EQ(reader.size(), 0);
+
+	ASSERT_THROW(handystats::binary::reader(std::string()), std::invalid_argument);
+	ASSERT_THROW(handystats::binary::reader(buffer.substr(0, buffer.size() - 1)), std::invalid_argument);
+	ASSERT_THROW(handystats::binary::reader(buffer + "x"), std::invalid_argument);
+	ASSERT_THROW(handystats::binary::reader("XSBD" + buffer.substr(4)), std::invalid_argument);
+	ASSERT_THROW(reader[0], std::invalid_argument);
+}
@@ -84,6 +84,17 @@ TEST(CBindingTest, TestScopedTimer) {
 	ASSERT_GE(test_scoped_timer.values().get<handystats::statistics::tag::min>(), TEST_SCOPED_TIMER_NANOSLEEP_COUNT / 1000.0);
 }
 
+TEST(CBindingTest, TestHandleTimer) {
+	auto metrics_dump = HANDY_METRICS_DUMP();
+
+	ASSERT_TRUE(metrics_dump->find("test." TEST_HANDLE_TIMER_NAME) != metrics_dump->end());
+
+	const auto& test_handle_timer = boost::get<handystats::metrics::timer>(metrics_dump->at("test." TEST_HANDLE_TIMER_NAME));
+
+	ASSERT_EQ(test_handle_timer.values().get<handystats::statistics::tag::count>(), TEST_HANDLE_TIMER_NANOSLEEP_COUNT);
+	ASSERT_GE(test_handle_timer.values().get<handystats::statistics::tag::min>(), TEST_HANDLE_TIMER_NANOSLEEP_TIME / 1000.0);
+}
+
 TEST(CBindingTest, TestBoolAttr) {
 	auto metrics_dump = HANDY_METRICS_DUMP();
 
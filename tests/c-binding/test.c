@@ -81,6 +81,21 @@ void run_test_scoped_timer(void) {
 	}
 }
 
+void run_test_handle_timer(void) {
+	struct timespec rqtp;
+	rqtp.tv_sec = 0;
+	rqtp.tv_nsec = TEST_HANDLE_TIMER_NANOSLEEP_TIME;
+
+	struct handystats_timer_handle* timer_handle = HANDY_TIMER_RESOLVE("test." TEST_HANDLE_TIMER_NAME);
+
+	int cycle;
+
+	for (cycle = 0; cycle < TEST_HANDLE_TIMER_NANOSLEEP_COUNT; ++cycle) {
+		HANDY_TIMER_HANDLE_SCOPE(timer_handle);
+		nanosleep(&rqtp, NULL);
+	}
+}
+
 void run_test_bool_attr(void) {
 	HANDY_ATTRIBUTE_SET_BOOL(("%s." TEST_BOOL_ATTR_NAME, "test"), TEST_BOOL_ATTR_VALUE);
 }
@@ -128,6 +143,7 @@ int main(int argc, char** argv) {
 	run_test_scoped_counter();
 	run_test_timer();
 	run_test_scoped_timer();
+	run_test_handle_timer();
 	run_test_attr();
 
 	int ret = check_tests(argc, argv);
@@ -38,6 +38,10 @@
 #define TEST_SCOPED_TIMER_NANOSLEEP_TIME 20000
 #define TEST_SCOPED_TIMER_NANOSLEEP_COUNT 5
 
+#define TEST_HANDLE_TIMER_NAME "handle.timer"
+#define TEST_HANDLE_TIMER_NANOSLEEP_TIME 20000
+#define TEST_HANDLE_TIMER_NANOSLEEP_COUNT 7
+
 #define TEST_BOOL_ATTR_NAME "bool.attr"
 #define TEST_BOOL_ATTR_VALUE 1
 
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) YANDEX LLC. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <gtest/gtest.h>
+
+#include <handystats/chrono.hpp>
+
+#include "chrono_impl.hpp"
+
+using namespace handystats::chrono;
+
+static const char* const CALIBRATION_CHILD_ENV = "HANDYSTATS_CHRONO_CALIBRATION_CHILD";
+
+static
+bool tsc_source(const clock_source& source) {
+	return source != clock_source::MONOTONIC && source != clock_source::REALTIME;
+}
+
+// calibration state of the process is checked in fresh process, so other tests don't affect it
+TEST(ChronoCalibrationTest, LazyCalibrationInFreshProcess) {
+	const std::string& env = std::string(CALIBRATION_CHILD_ENV) + "=1";
+	char* const envp[] = {const_cast<char*>(env.c_str()), nullptr};
+
+	const pid_t pid = fork();
+	ASSERT_GE(pid, 0);
+	if (pid == 0) {
+		execle("/proc/self/exe", "/proc/self/exe", "--gtest_filter=ChronoCalibrationProcess.*", (char*)NULL, envp);
+		_exit(1);
+	}
+
+	int status = 0;
+	ASSERT_EQ(waitpid(pid, &status, 0), pid);
+	ASSERT_TRUE(WIFEXITED(status));
+	ASSERT_EQ(WEXITSTATUS(status), 0);
+}
+
+TEST(ChronoCalibrationTest, StartupCost) {
+	// process startup used to pay at least 15ms for TSC calibration,
+	// the bound is generous to tolerate loaded hosts, measured value is reported for tracking
+	const auto& max_startup_time = std::chrono::seconds(1);
+	std::chrono::steady_clock::duration min_startup_time = std::chrono::hours(1);
+
+	for (int run = 0; run < 5; ++run) {
+		const auto& start_time = std::chrono::steady_clock::now();
+
+		const pid_t pid = fork();
+		ASSERT_GE(pid, 0);
+		if (pid == 0) {
+			// child process only loads the library and exits
+			execl("/proc/self/exe", "/proc/self/exe", "--gtest_list_tests", "--gtest_filter=-*", (char*)NULL);
+			_exit(1);
+		}
+		int status = 0;
+		ASSERT_EQ(waitpid(pid, &status, 0), pid);
+		ASSERT_TRUE(WIFEXITED(status));
+		ASSERT_EQ(WEXITSTATUS(status), 0);
+
+		min_startup_time = std::min(min_startup_time, std::chrono::steady_clock::now() - start_time);
+	}
+
+	RecordProperty("startup_usec", std::chrono::duration_cast<std::chrono::microseconds>(min_startup_time).count());
+	ASSERT_LT(min_startup_time, max_startup_time);
+}
+
+// executed in the process spawned by ChronoCalibrationTest.LazyCalibrationInFreshProcess
+TEST(ChronoCalibrationProcess, CalibratedOnFirstConversion) {
+	if (!getenv(CALIBRATION_CHILD_ENV)) {
+		return;
+	}
+
+	// startup and time points don't calibrate
+	const auto& start_time = tsc_clock::now();
+	ASSERT_FALSE(calibrated_flag.load());
+	ASSERT_EQ(calibrated_by(), calibration_source::NONE);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	const auto& end_time = tsc_clock::now();
+	ASSERT_FALSE(calibrated_flag.load());
+
+	const auto& measured = duration::convert_to(time_unit::MSEC, end_time - start_time);
+
+	// the first conversion calibrates with the source matching the clock source chosen on startup
+	ASSERT_TRUE(calibrated_flag.load());
+	if (tsc_source(tsc_clock::source())) {
+		ASSERT_NE(calibrated_by(), calibration_source::NONE);
+		ASSERT_NE(calibrated_by(), calibration_source::POSIX);
+	}
+	else {
+		ASSERT_EQ(calibrated_by(), calibration_source::POSIX);
+	}
+
+	// nominal rate could be slightly off, upper bound is left for loaded hosts
+	ASSERT_GE(measured.count(), 45);
+	ASSERT_LT(measured.count(), 10000);
+}
+
+TEST(ChronoCalibrationTest, RefinementKeepsRate) {
+	calibrate();
+	const double initial_rate = cycles_per_nanosec.load();
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+	refine_calibration();
+
+	ASSERT_NEAR(cycles_per_nanosec.load(), initial_rate, 0.01 * initial_rate);
+}
+
+TEST(ChronoSystemTimeTest, ConversionMatchesSystemClock) {
+	for (int iteration = 0; iteration < 100; ++iteration) {
+		const auto& system_before = system_clock::now();
+		const auto& converted = time_point::convert_to(clock_type::SYSTEM, tsc_clock::now());
+		const auto& system_after = system_clock::now();
+
+		const duration tolerance(100, time_unit::USEC);
+		ASSERT_TRUE(converted >= system_before - tolerance);
+		ASSERT_TRUE(converted <= system_after + tolerance);
+	}
+}
+
+TEST(ChronoSystemTimeTest, MappingUpdateIsRateLimited) {
+	// mapping is published on the first conversion
+	time_point::convert_to(clock_type::SYSTEM, tsc_clock::now());
+	std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+
+	ASSERT_TRUE(update_system_time_mapping());
+	ASSERT_FALSE(update_system_time_mapping());
+
+	// TSC and system clock shouldn't drift apart by more than a millisecond per second
+	ASSERT_LT(std::abs(system_time_drift()), 1000 * 1000);
+}
@@ -0,0 +1,363 @@
+/*
+ * Copyright (c) YANDEX LLC. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include <handystats/metrics_dump.hpp>
+#include <handystats/metrics/attribute.hpp>
+
+using handystats::metrics_dump::dump_map;
+using handystats::metrics::attribute;
+
+static
+std::string metric_name(const int& index) {
+	char name[32];
+	snprintf(name, sizeof(name), "metric.%06d", index);
+	return name;
+}
+
+static
+dump_map::entry_ptr make_entry(const int& index, const int& value, const uint64_t& version) {
+	attribute attr;
+	attr.set(value);
+	return std::make_shared<const dump_map::entry>(metric_name(index), attr, version);
+}
+
+static
+int entry_value(const dump_map& dump, const int& index) {
+	return boost::get<int>(boost::get<attribute>(dump.at(metric_name(index))).value());
+}
+
+TEST(DumpMapTest, EmptyDump) {
+	dump_map dump;
+
+	ASSERT_TRUE(dump.empty());
+	ASSERT_EQ(dump.size(), 0);
+	ASSERT_EQ(dump.version(), 0);
+	ASSERT_TRUE(dump.begin() == dump.end());
+	ASSERT_TRUE(dump.find("metric") == dump.end());
+	ASSERT_THROW(dump.at("metric"), std::out_of_range);
+}
+
+TEST(DumpMapTest, CopyToStdMap) {
+	std::vector<dump_map::entry_ptr> changed;
+	for (size_t index = 0; index < 3 * dump_map::MAX_BLOCK_SIZE; ++index) {
+		changed.push_back(make_entry(index, index, 1));
+	}
+	const dump_map& dump = dump_map().update(changed, std::vector<std::string>(), 1);
+
+	// the way to get dump in pre-2.0 format
+	const std::map<std::string, handystats::metrics::metric_variant> metrics_map(dump.begin(), dump.end());
+
+	ASSERT_EQ(metrics_map.size(), dump.size());
+	ASSERT_EQ(boost::get<int>(boost::get<attribute>(metrics_map.at(metric_name(10))).value()), 10);
+}
+
+TEST(DumpMapTest, SortedIteration) {
+	const int METRICS_COUNT = 10 * dump_map::MAX_BLOCK_SIZE + 3;
+
+	std::vector<dump_map::entry_ptr> changed;
+	for (int index = 0; index < METRICS_COUNT; ++index) {
+		changed.push_back(make_entry(index, index, 1));
+	}
+
+	const dump_map& dump = dump_map().update(changed, std::vector<std::string>(), 1);
+
+	ASSERT_EQ(dump.version(), 1);
+	ASSERT_EQ(dump.size(), METRICS_COUNT);
+
+	int index = 0;
+	for (auto iter = dump.begin(); iter != dump.end(); ++iter, ++index) {
+		ASSERT_EQ(iter->first, metric_name(index));
+		ASSERT_EQ(iter.version(), 1);
+	}
+	ASSERT_EQ(index, METRICS_COUNT);
+
+	auto iter = dump.end();
+	for (index = METRICS_COUNT - 1; index >= 0; --index) {
+		--iter;
+		ASSERT_EQ(iter->first, metric_name(index));
+	}
+	ASSERT_TRUE(iter == dump.begin());
+
+	for (index = 0; index < METRICS_COUNT; ++index) {
+		ASSERT_EQ(dump.count(metric_name(index)), 1);
+		ASSERT_EQ(entry_value(dump, index), index);
+	}
+	ASSERT_EQ(dump.count(metric_name(METRICS_COUNT)), 0);
+	ASSERT_EQ(dump.count(""), 0);
+}
+
+TEST(DumpMapTest, UnchangedEntriesAreShared) {
+	const int METRICS_COUNT = 10 * dump_map::MAX_BLOCK_SIZE;
+
+	std::vector<dump_map::entry_ptr> changed;
+	for (int index = 0; index < METRICS_COUNT; index += 2) {
+		changed.push_back(make_entry(index, index, 1));
+	}
+	const dump_map& first = dump_map().update(changed, std::vector<std::string>(), 1);
+
+	// update one metric and insert new ones
+	changed.clear();
+	changed.push_back(make_entry(1, -1, 2));
+	changed.push_back(make_entry(100, -100, 2));
+	changed.push_back(make_entry(METRICS_COUNT + 1, -1, 2));
+	const dump_map& second = first.update(changed, std::vector<std::string>(), 2);
+
+	ASSERT_EQ(second.version(), 2);
+	ASSERT_EQ(second.size(), first.size() + 2);
+
+	ASSERT_EQ(entry_value(second, 1), -1);
+	ASSERT_EQ(entry_value(second, 100), -100);
+	ASSERT_EQ(entry_value(second, METRICS_COUNT + 1), -1);
+	ASSERT_EQ(second.find(metric_name(100)).version(), 2);
+
+	// previous dump is unaffected
+	ASSERT_EQ(first.count(metric_name(1)), 0);
+	ASSERT_EQ(entry_value(first, 100), 100);
+
+	// snapshots of unchanged metrics are the same objects
+	for (int index = 0; index < METRICS_COUNT; index += 2) {
+		if (index == 100) {
+			continue;
+		}
+		ASSERT_EQ(&*first.find(metric_name(index)), &*second.find(metric_name(index)));
+		ASSERT_EQ(second.find(metric_name(index)).version(), 1);
+	}
+
+	int index = 0;
+	std::string prev_name;
+	for (auto iter = second.begin(); iter != second.end(); ++iter, ++index) {
+		ASSERT_LT(prev_name, iter->first);
+		prev_name = iter->first;
+	}
+	ASSERT_EQ(index, second.size());
+}
+
+TEST(DumpMapTest, RemovedEntries) {
+	const int METRICS_COUNT = 3 * dump_map::MAX_BLOCK_SIZE;
+
+	std::vector<dump_map::entry_ptr> changed;
+	for (int index = 0; index < METRICS_COUNT; ++index) {
+		changed.push_back(make_entry(index, index, 1));
+	}
+	const dump_map& first = dump_map().update(changed, std::vector<std::string>(), 1);
+
+	std::vector<std::string> removed;
+	for (int index = 0; index < METRICS_COUNT; index += 3) {
+		removed.push_back(metric_name(index));
+	}
+	removed.push_back(metric_name(METRICS_COUNT + 10));
+
+	const dump_map& second = first.update(std::vector<dump_map::entry_ptr>(), removed, 2);
+
+	ASSERT_EQ(second.size(), METRICS_COUNT - METRICS_COUNT / 3);
+	for (int index = 0; index < METRICS_COUNT; ++index) {
+		ASSERT_EQ(second.count(metric_name(index)), index % 3 == 0 ? 0 : 1);
+	}
+
+	// removing everything results in empty dump
+	removed.clear();
+	for (auto iter = second.begin(); iter != second.end(); ++iter) {
+		removed.push_back(iter->first);
+	}
+	const dump_map& third = second.update(std::vector<dump_map::entry_ptr>(), removed, 3);
+
+	ASSERT_TRUE(third.empty());
+	ASSERT_TRUE(third.begin() == third.end());
+}
+
+TEST(DumpMapTest, DeltaSinceVersion) {
+	const int METRICS_COUNT = 10 * dump_map::MAX_BLOCK_SIZE;
+
+	std::vector<dump_map::entry_ptr> changed;
+	for (int index = 0; index < METRICS_COUNT; ++index) {
+		changed.push_back(make_entry(index, index, 1));
+	}
+	const dump_map& first = dump_map().update(changed, std::vector<std::string>(), 1);
+
+	changed.clear();
+	changed.push_back(make_entry(5, -5, 2));
+	changed.push_back(make_entry(METRICS_COUNT / 2, -1, 2));
+	std::vector<std::string> removed;
+	removed.push_back(metric_name(7));
+	removed.push_back(metric_name(METRICS_COUNT + 10));
+	const dump_map& second = first.update(changed, removed, 2);
+
+	changed.clear();
+	changed.push_back(make_entry(7, 7, 3));
+	changed.push_back(make_entry(METRICS_COUNT - 1, -1, 3));
+	removed.clear();
+	removed.push_back(metric_name(8));
+	const dump_map& third = second.update(changed, removed, 3);
+
+	auto delta = third.delta(3);
+	ASSERT_FALSE(delta.full);
+	ASSERT_EQ(delta.since, 3);
+	ASSERT_EQ(delta.version, 3);
+	ASSERT_TRUE(delta.changed.empty());
+	ASSERT_TRUE(delta.removed.empty());
+
+	delta = third.delta(2);
+	ASSERT_FALSE(delta.full);
+	ASSERT_EQ(delta.changed.size(), 2);
+	ASSERT_EQ(delta.changed[0]->value.first, metric_name(7));
+	ASSERT_EQ(delta.changed[1]->value.first, metric_name(METRICS_COUNT - 1));
+	ASSERT_EQ(delta.removed, std::vector<std::string>(1, metric_name(8)));
+
+	// metric removed and added back is reported as changed only
+	delta = third.delta(1);
+	ASSERT_FALSE(delta.full);
+	ASSERT_EQ(delta.changed.size(), 4);
+	ASSERT_EQ(delta.changed[0]->value.first, metric_name(5));
+	ASSERT_EQ(delta.changed[1]->value.first, metric_name(7));
+	ASSERT_EQ(delta.changed[2]->value.first, metric_name(METRICS_COUNT / 2));
+	ASSERT_EQ(delta.changed[3]->value.first, metric_name(METRICS_COUNT - 1));
+	ASSERT_EQ(delta.removed, std::vector<std::string>(1, metric_name(8)));
+
+	// unknown version results in the whole dump
+	delta = third.delta(4);
+	ASSERT_TRUE(delta.full);
+	ASSERT_EQ(delta.changed.size(), third.size());
+	ASSERT_TRUE(delta.removed.empty());
+}
+
+TEST(DumpMapTest, DeltaBeyondRemovalsHorizon) {
+	const int METRICS_COUNT = dump_map::MAX_REMOVALS + 1;
+
+	std::vector<dump_map::entry_ptr> changed;
+	for (int index = 0; index < METRICS_COUNT; ++index) {
+		changed.push_back(make_entry(index, index, 1));
+	}
+	const dump_map& first = dump_map().update(changed, std::vector<std::string>(), 1);
+
+	std::vector<std::string> removed;
+	removed.push_back(metric_name(0));
+	const dump_map& second = first.update(std::vector<dump_map::entry_ptr>(), removed, 2);
+
+	removed.clear();
+	for (int index = 1; index < METRICS_COUNT; ++index) {
+		removed.push_back(metric_name(index));
+	}
+	const dump_map& third = second.update(std::vector<dump_map::entry_ptr>(), removed, 3);
+
+	ASSERT_TRUE(third.empty());
+
+	// removal at version 2 is forgotten
+	auto delta = third.delta(1);
+	ASSERT_TRUE(delta.full);
+	ASSERT_TRUE(delta.changed.empty());
+	ASSERT_TRUE(delta.removed.empty());
+
+	delta = third.delta(2);
+	ASSERT_FALSE(delta.full);
+	ASSERT_EQ(delta.removed.size(), METRICS_COUNT - 1);
+}
+
+TEST(DumpMapTest, LowerAndUpperBound) {
+	const int METRICS_COUNT = 3 * dump_map::MAX_BLOCK_SIZE;
+
+	std::vector<dump_map::entry_ptr> changed;
+	for (int index = 0; index < METRICS_COUNT; index += 2) {
+		changed.push_back(make_entry(index, index, 1));
+	}
+	const dump_map& dump = dump_map().update(changed, std::vector<std::string>(), 1);
+
+	for (int index = 0; index < METRICS_COUNT; ++index) {
+		const auto& lower = dump.lower_bound(metric_name(index));
+		const auto& upper = dump.upper_bound(metric_name(index));
+		const int expected_lower = (index + 1) / 2 * 2;
+		const int expected_upper = index / 2 * 2 + 2;
+
+		if (expected_lower >= METRICS_COUNT) {
+			ASSERT_TRUE(lower == dump.end());
+		}
+		else {
+			ASSERT_EQ(lower->first, metric_name(expected_lower));
+		}
+		if (expected_upper >= METRICS_COUNT) {
+			ASSERT_TRUE(upper == dump.end());
+		}
+		else {
+			ASSERT_EQ(upper->first, metric_name(expected_upper));
+		}
+	}
+
+	ASSERT_TRUE(dump.lower_bound("") == dump.begin());
+	ASSERT_TRUE(dump.lower_bound("z") == dump.end());
+}
+
+TEST(DumpMapTest, PrefixAndGlobViews) {
+	std::vector<std::string> names;
+	names.push_back("cache.hits");
+	names.push_back("db");
+	names.push_back("db.query.count");
+	names.push_back("db.query.time");
+	names.push_back("db.write.time");
+	names.push_back("db2.query.time");
+	names.push_back("queue.size");
+
+	std::vector<dump_map::entry_ptr> changed;
+	for (size_t index = 0; index < names.size(); ++index) {
+		attribute attr;
+		attr.set(int(index));
+		changed.push_back(std::make_shared<const dump_map::entry>(names[index], attr, 1));
+	}
+	const auto& dump = std::make_shared<const dump_map>(dump_map().update(changed, std::vector<std::string>(), 1));
+
+	auto view_names = [] (const handystats::metrics_dump::dump_view& view) {
+		std::vector<std::string> result;
+		for (auto iter = view.begin(); iter != view.end(); ++iter) {
+			result.push_back(iter->first);
+		}
+		return result;
+	};
+
+	const auto& db_view = handystats::metrics_dump::dump_view::prefix(dump, "db.");
+	ASSERT_EQ(db_view.version(), 1);
+	ASSERT_EQ(db_view.size(), 3);
+	ASSERT_EQ(view_names(db_view),
+			std::vector<std::string>(names.begin() + 2, names.begin() + 5)
+		);
+
+	ASSERT_EQ(handystats::metrics_dump::dump_view::prefix(dump, "db").size(), 5);
+	ASSERT_EQ(handystats::metrics_dump::dump_view::prefix(dump, "").size(), names.size());
+	ASSERT_TRUE(handystats::metrics_dump::dump_view::prefix(dump, "http.").empty());
+
+	const auto& time_view = handystats::metrics_dump::dump_view::glob(dump, "db*.time");
+	std::vector<std::string> expected;
+	expected.push_back("db.query.time");
+	expected.push_back("db.write.time");
+	expected.push_back("db2.query.time");
+	ASSERT_EQ(view_names(time_view), expected);
+
+	ASSERT_EQ(handystats::metrics_dump::dump_view::glob(dump, "*.size").size(), 1);
+	ASSERT_EQ(handystats::metrics_dump::dump_view::glob(dump, "db").size(), 1);
+	ASSERT_TRUE(handystats::metrics_dump::dump_view::glob(dump, "db.*.size").empty());
+
+	// view of the whole dump
+	const auto& whole_view = handystats::metrics_dump::dump_view(dump);
+	ASSERT_EQ(whole_view.size(), names.size());
+	ASSERT_EQ(whole_view.dump().get(), dump.get());
+}
@@ -31,9 +31,11 @@
 #include <handystats/core.hpp>
 #include <handystats/measuring_points.hpp>
 #include <handystats/metrics_dump.hpp>
+#include <handystats/json_dump.hpp>
 
 #include "message_queue_helper.hpp"
 #include "metrics_dump_helper.hpp"
+#include "timer_instances_impl.hpp"
 
 class HandyTimerTest : public ::testing::Test {
 protected:
@@ -156,3 +158,172 @@ TEST_F(HandyTimerTest, TestConcurrentlyMultiInstanceTimer) {
 				handystats::chrono::duration(sleep_time.count(), handystats::chrono::time_unit::MSEC)).count()
 		);
 }
+
+class HandyLocalInstancesTimerTest : public ::testing::Test {
+protected:
+	virtual void SetUp() {
+		HANDY_CONFIG_JSON(
+				"{\
+					\"timer\": {\
+						\"idle-timeout\": 100,\
+						\"local-instances\": true,\
+						\"exemplars\": 5\
+					},\
+					\"dump-interval\": 10\
+				}"
+			);
+
+		HANDY_INIT();
+	}
+	virtual void TearDown() {
+		HANDY_FINALIZE();
+	}
+};
+
+TEST_F(HandyLocalInstancesTimerTest, TestConcurrentlyMultiInstanceTimer) {
+	const int COUNT = 100;
+	const int THREADS = 4;
+	auto sleep_time = std::chrono::milliseconds(1);
+
+	for (int step = 0; step < THREADS * COUNT; ++step) {
+		HANDY_TIMER_START("sleep.time", step);
+	}
+
+	std::this_thread::sleep_for(sleep_time);
+
+	// instances are stopped from other threads
+	std::vector<std::thread> threads;
+	for (int thread = 0; thread < THREADS; ++thread) {
+		threads.push_back(std::thread([thread, COUNT] () {
+				for (int step = thread * COUNT; step < (thread + 1) * COUNT; ++step) {
+					if (step % 10 == 0) {
+						HANDY_TIMER_DISCARD("sleep.time", step);
+					}
+					else {
+						HANDY_TIMER_HEARTBEAT("sleep.time", step);
+						HANDY_TIMER_STOP("sleep.time", step);
+					}
+				}
+			}));
+	}
+	for (auto thread_iter = threads.begin(); thread_iter != threads.end(); ++thread_iter) {
+		thread_iter->join();
+	}
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	auto metrics_dump = HANDY_METRICS_DUMP();
+
+	const auto& timer = boost::get<handystats::metrics::timer>(metrics_dump->at("sleep.time"));
+	ASSERT_EQ(timer.instances_count(), 0);
+
+	const auto& agg_stats = timer.values();
+	ASSERT_EQ(agg_stats.get<handystats::statistics::tag::count>(), THREADS * COUNT * 9 / 10);
+	ASSERT_GE(
+			agg_stats.get<handystats::statistics::tag::min>(),
+			handystats::chrono::duration::convert_to(handystats::metrics::timer::value_unit,
+				handystats::chrono::duration(sleep_time.count(), handystats::chrono::time_unit::MSEC)).count()
+		);
+}
+
+TEST_F(HandyLocalInstancesTimerTest, TestIdleInstancesAreDropped) {
+	HANDY_TIMER_START("idle.time", 1);
+	HANDY_TIMER_START("idle.time", 2);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(150));
+
+	HANDY_TIMER_STOP("idle.time", 1);
+	HANDY_TIMER_START("idle.time", 3);
+	HANDY_TIMER_STOP("idle.time", 3);
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	auto metrics_dump = HANDY_METRICS_DUMP();
+
+	const auto& agg_stats = boost::get<handystats::metrics::timer>(metrics_dump->at("idle.time")).values();
+	ASSERT_EQ(agg_stats.get<handystats::statistics::tag::count>(), 1);
+}
+
+TEST_F(HandyLocalInstancesTimerTest, TestInstancesOfFinishedThread) {
+	const int COUNT = 100;
+
+	// most instances don't fit the thread's table
+	std::thread([COUNT] () {
+			for (int step = 0; step < COUNT; ++step) {
+				HANDY_TIMER_START("thread.time", step);
+			}
+		}).join();
+
+	for (int step = 0; step < COUNT; ++step) {
+		HANDY_TIMER_STOP("thread.time", step);
+	}
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	auto metrics_dump = HANDY_METRICS_DUMP();
+
+	const auto& agg_stats = boost::get<handystats::metrics::timer>(metrics_dump->at("thread.time")).values();
+	ASSERT_EQ(agg_stats.get<handystats::statistics::tag::count>(), COUNT);
+	ASSERT_EQ(handystats::timer_instances::size(), 0);
+}
+
+TEST_F(HandyLocalInstancesTimerTest, TestRestartOfInstanceOfOtherThread) {
+	// the first instances stay in the thread's table, the last ones overflow into the shared table,
+	// all of them are moved into the shared table as the thread finishes
+	std::thread([] () {
+			for (int step = 0; step < 20; ++step) {
+				HANDY_TIMER_START("restart.time", step);
+			}
+		}).join();
+	ASSERT_EQ(handystats::timer_instances::size(), 20);
+
+	// instances are restarted in place instead of being copied into this thread's table
+	for (int step = 0; step < 20; ++step) {
+		HANDY_TIMER_START("restart.time", step);
+	}
+	ASSERT_EQ(handystats::timer_instances::size(), 20);
+
+	for (int step = 0; step < 20; ++step) {
+		HANDY_TIMER_STOP("restart.time", step);
+	}
+	ASSERT_EQ(handystats::timer_instances::size(), 0);
+}
+
+TEST_F(HandyLocalInstancesTimerTest, TestIdleInstancesAreSwept) {
+	for (int step = 0; step < 1000; ++step) {
+		HANDY_TIMER_START("swept.time", step);
+	}
+	ASSERT_EQ(handystats::timer_instances::size(), 1000);
+
+	// instances expire after idle timeout (100 ms) and are swept within the next one
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	while (handystats::timer_instances::size() > 0 && std::chrono::steady_clock::now() < deadline) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	ASSERT_EQ(handystats::timer_instances::size(), 0);
+}
+
+TEST_F(HandyLocalInstancesTimerTest, TestExemplarsCarryInstanceId) {
+	for (int step = 0; step < 20; ++step) {
+		const auto timestamp = handystats::metrics::timer::clock::now();
+		HANDY_TIMER_START("exemplar.time", step, timestamp);
+		HANDY_TIMER_STOP("exemplar.time", step, timestamp + handystats::chrono::duration(step, handystats::chrono::time_unit::MSEC));
+	}
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	auto metrics_dump = HANDY_METRICS_DUMP();
+
+	const auto& exemplars = boost::get<handystats::metrics::timer>(metrics_dump->at("exemplar.time")).exemplars();
+	ASSERT_EQ(exemplars.size(), 5);
+	for (size_t index = 0; index < exemplars.size(); ++index) {
+		ASSERT_EQ(exemplars[index].instance_id, 19 - index);
+	}
+
+	const std::string& json_dump = HANDY_JSON_DUMP();
+	ASSERT_TRUE(json_dump.find("\"exemplars\"") != std::string::npos);
+}
@@ -18,6 +18,8 @@
 #include <thread>
 #include <chrono>
 #include <string>
+#include <cstdio>
+#include <unistd.h>
 
 #include <gtest/gtest.h>
 
@@ -141,3 +143,127 @@ TEST(JsonDumpTest, CheckEmptyStatisticsNotShown) {
 
 	HANDY_FINALIZE();
 }
+
+TEST(JsonDumpTest, CompactAndStreamingOutput) {
+	HANDY_CONFIG_JSON(
+			"{\
+				\"dump-interval\": 1\
+			}"
+		);
+
+	HANDY_INIT();
+
+	for (int i = 0; i < 10; ++i) {
+		HANDY_GAUGE_SET("test.gauge", i);
+		HANDY_COUNTER_INCREMENT("test.counter", i);
+		HANDY_ATTRIBUTE_SET("test.attribute", std::string("quoted \"value\""));
+	}
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	auto metrics_dump = HANDY_METRICS_DUMP();
+
+	const std::string& pretty_dump = handystats::json::to_string(*metrics_dump);
+	const std::string& compact_dump = handystats::json::to_string(*metrics_dump, true);
+
+	ASSERT_TRUE(compact_dump.find('\n') == std::string::npos);
+	ASSERT_LT(compact_dump.size(), pretty_dump.size());
+	check_full_json_dump(compact_dump);
+
+	rapidjson::Document dump;
+	dump.Parse<0>(compact_dump.c_str());
+	ASSERT_TRUE(dump.IsObject());
+	ASSERT_TRUE(dump.HasMember("test.attribute"));
+	ASSERT_EQ(std::string(dump["test.attribute"]["value"].GetString()), "quoted \"value\"");
+
+	// buffer's content is replaced
+	std::string buffer("garbage");
+	handystats::json::write(*metrics_dump, buffer, true);
+	ASSERT_EQ(buffer, compact_dump);
+
+	FILE* file = tmpfile();
+	ASSERT_TRUE(file != NULL);
+	ASSERT_TRUE(handystats::json::write(*metrics_dump, fileno(file)));
+
+	std::string file_dump(pretty_dump.size() + 1, '\0');
+	rewind(file);
+	file_dump.resize(fread(&file_dump[0], 1, file_dump.size(), file));
+	fclose(file);
+	ASSERT_EQ(file_dump, pretty_dump);
+
+	ASSERT_FALSE(handystats::json::write(*metrics_dump, -1));
+
+	HANDY_FINALIZE();
+}
+
+TEST(JsonDumpTest, SharedJsonIsRenderedOncePerVersion) {
+	HANDY_CONFIG_JSON(
+			"{\
+				\"dump-interval\": 1\
+			}"
+		);
+
+	HANDY_INIT();
+
+	HANDY_COUNTER_INCREMENT("test.counter");
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	auto metrics_dump = HANDY_METRICS_DUMP();
+
+	const auto& first = handystats::json::to_shared_string(*metrics_dump);
+	const auto& second = handystats::json::to_shared_string(*metrics_dump);
+	ASSERT_EQ(first.get(), second.get());
+	ASSERT_EQ(*first, handystats::json::to_string(*metrics_dump));
+
+	const auto& compact = handystats::json::to_shared_string(*metrics_dump, true);
+	ASSERT_NE(first.get(), compact.get());
+	ASSERT_EQ(*compact, handystats::json::to_string(*metrics_dump, true));
+
+	HANDY_COUNTER_INCREMENT("test.counter");
+	const auto& new_dump =
+		HANDY_METRICS_DUMP_WAIT(metrics_dump->version(), handystats::chrono::duration(1, handystats::chrono::time_unit::SEC));
+	ASSERT_GT(new_dump->version(), metrics_dump->version());
+	ASSERT_NE(handystats::json::to_shared_string(*new_dump).get(), first.get());
+
+	HANDY_FINALIZE();
+}
+
+TEST(JsonDumpTest, DumpViewOutput) {
+	HANDY_CONFIG_JSON(
+			"{\
+				\"dump-interval\": 1\
+			}"
+		);
+
+	HANDY_INIT();
+
+	HANDY_COUNTER_INCREMENT("db.query.count");
+	HANDY_GAUGE_SET("db.pool.size", 4);
+	HANDY_GAUGE_SET("queue.size", 1);
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	const auto& db_view = HANDY_METRICS_DUMP_PREFIX("db.");
+	const std::string& json_view = handystats::json::to_string(db_view, true);
+
+	rapidjson::Document dump;
+	dump.Parse<0>(json_view.c_str());
+	ASSERT_TRUE(dump.IsObject());
+	ASSERT_TRUE(dump.HasMember("db.query.count"));
+	ASSERT_TRUE(dump.HasMember("db.pool.size"));
+	ASSERT_FALSE(dump.HasMember("queue.size"));
+
+	std::string buffer;
+	handystats::json::write(HANDY_METRICS_DUMP_GLOB("*.size"), buffer, true);
+	dump.Parse<0>(buffer.c_str());
+	ASSERT_TRUE(dump.IsObject());
+	ASSERT_TRUE(dump.HasMember("db.pool.size"));
+	ASSERT_TRUE(dump.HasMember("queue.size"));
+	ASSERT_FALSE(dump.HasMember("db.query.count"));
+
+	HANDY_FINALIZE();
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) YANDEX LLC. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+#include <string>
+#include <memory>
+#include <thread>
+#include <atomic>
+
+#include <gtest/gtest.h>
+
+#include <handystats/core.hpp>
+#include <handystats/measuring_points.hpp>
+#include <handystats/metrics_dump.hpp>
+#include <handystats/metric_reader.hpp>
+
+#include "message_queue_helper.hpp"
+#include "metrics_dump_helper.hpp"
+
+using handystats::metrics_dump::metric_reader;
+
+class MetricReaderTest : public ::testing::Test {
+protected:
+	virtual void SetUp() {
+		HANDY_CONFIG_JSON(
+				"{\
+					\"dump-interval\": 10\
+				}"
+			);
+
+		HANDY_INIT();
+	}
+	virtual void TearDown() {
+		HANDY_FINALIZE();
+	}
+};
+
+TEST_F(MetricReaderTest, FollowsPublishedDumps) {
+	HANDY_COUNTER_INCREMENT("counter", 10);
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	metric_reader reader("counter");
+	ASSERT_EQ(reader.name(), "counter");
+
+	auto metrics_dump = HANDY_METRICS_DUMP();
+	auto entry = reader.load();
+	ASSERT_TRUE(entry != nullptr);
+	ASSERT_EQ(entry->value.first, "counter");
+	ASSERT_GE(metrics_dump->version(), entry->version);
+	ASSERT_EQ(boost::get<handystats::metrics::counter>(entry->value.second).values().get<handystats::statistics::tag::value>(), 10);
+
+	HANDY_COUNTER_INCREMENT("counter", 5);
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	metrics_dump = HANDY_METRICS_DUMP();
+	entry = reader.load();
+	ASSERT_EQ(boost::get<handystats::metrics::counter>(entry->value.second).values().get<handystats::statistics::tag::value>(), 15);
+
+	// reader shares the snapshot with the dump
+	ASSERT_EQ(&entry->value, &*metrics_dump->find("counter"));
+}
+
+TEST_F(MetricReaderTest, MetricAppearsAndIsRemoved) {
+	metric_reader reader("gauge");
+	ASSERT_TRUE(reader.load() == nullptr);
+
+	// handles of the same metric share the snapshot
+	metric_reader other_reader("gauge");
+
+	HANDY_GAUGE_SET("gauge", 3);
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	ASSERT_TRUE(reader.load() != nullptr);
+	ASSERT_EQ(reader.load(), other_reader.load());
+	ASSERT_EQ(boost::get<handystats::metrics::gauge>(reader.load()->value.second).values().get<handystats::statistics::tag::value>(), 3);
+
+	// finalization removes all metrics
+	HANDY_FINALIZE();
+	ASSERT_TRUE(reader.load() == nullptr);
+
+	HANDY_INIT();
+}
+
+TEST_F(MetricReaderTest, ConcurrentReads) {
+	metric_reader reader("counter");
+
+	std::atomic<bool> stop(false);
+	std::atomic<uint64_t> last_version(0);
+	std::thread health_check(
+			[&reader, &stop, &last_version] () {
+				while (!stop.load()) {
+					const auto& entry = reader.load();
+					if (entry) {
+						// snapshots are never taken back
+						EXPECT_GE(entry->version, last_version.load());
+						last_version.store(entry->version);
+					}
+				}
+			}
+		);
+
+	for (int step = 0; step < 100; ++step) {
+		HANDY_COUNTER_INCREMENT("counter");
+		if (step % 10 == 0) {
+			handystats::message_queue::wait_until_empty();
+			handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+		}
+	}
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	stop.store(true);
+	health_check.join();
+
+	ASSERT_GT(last_version.load(), 0);
+	ASSERT_EQ(boost::get<handystats::metrics::counter>(reader.load()->value.second).values().get<handystats::statistics::tag::value>(), 100);
+}
@@ -24,6 +24,7 @@
 #include <map>
 #include <memory>
 #include <chrono>
+#include <algorithm>
 
 #include <gtest/gtest.h>
 
@@ -31,6 +32,7 @@
 #include <handystats/core.hpp>
 #include <handystats/measuring_points.hpp>
 #include <handystats/metrics_dump.hpp>
+#include <handystats/json_dump.hpp>
 
 #include "message_queue_helper.hpp"
 #include "metrics_dump_helper.hpp"
@@ -121,3 +123,130 @@ TEST_F(MetricsDumpTest, SampleGauge) {
 	ASSERT_EQ(gauge.values().get<handystats::statistics::tag::max>(), MAX_VALUE);
 	ASSERT_EQ(gauge.values().get<handystats::statistics::tag::avg>(), (MAX_VALUE + MIN_VALUE) / 2.0);
 }
+
+TEST_F(MetricsDumpTest, SystemTimeDrift) {
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	auto metrics_dump = HANDY_METRICS_DUMP();
+
+	ASSERT_TRUE(metrics_dump->find("handystats.chrono.system_time_drift") != metrics_dump->end());
+	const auto& drift = boost::get<handystats::metrics::gauge>(metrics_dump->at("handystats.chrono.system_time_drift"));
+	ASSERT_TRUE(drift.values().computed(handystats::statistics::tag::max));
+}
+
+TEST_F(MetricsDumpTest, IdleMetricIsShared) {
+	HANDY_ATTRIBUTE_SET("attribute", 1);
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	auto first_dump = HANDY_METRICS_DUMP();
+	ASSERT_TRUE(first_dump->find("attribute") != first_dump->end());
+
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	auto second_dump = HANDY_METRICS_DUMP();
+	ASSERT_GT(second_dump->version(), first_dump->version());
+
+	// snapshot of unchanged metric is taken only once
+	ASSERT_EQ(&*first_dump->find("attribute"), &*second_dump->find("attribute"));
+	ASSERT_EQ(first_dump->find("attribute").version(), second_dump->find("attribute").version());
+}
+
+TEST_F(MetricsDumpTest, DumpTimeIsMeasured) {
+	for (int index = 0; index < 1000; ++index) {
+		HANDY_COUNTER_INCREMENT("counter." + std::to_string(index % 100));
+	}
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	auto metrics_dump = HANDY_METRICS_DUMP();
+
+	// dump version is assigned by the processor, so the dump thread may coalesce several of them
+	ASSERT_GT(metrics_dump->version(), 0);
+	ASSERT_TRUE(metrics_dump->find("counter.99") != metrics_dump->end());
+
+	ASSERT_TRUE(metrics_dump->find("handystats.metrics_dump.dump_time") != metrics_dump->end());
+	const auto& dump_time = boost::get<handystats::metrics::gauge>(metrics_dump->at("handystats.metrics_dump.dump_time"));
+	ASSERT_TRUE(dump_time.values().computed(handystats::statistics::tag::moving_avg));
+}
+
+TEST_F(MetricsDumpTest, WaitForNewVersion) {
+	const auto& initial_dump = HANDY_METRICS_DUMP();
+	ASSERT_EQ(HANDY_METRICS_DUMP_VERSION(), initial_dump->version());
+
+	HANDY_COUNTER_INCREMENT("counter");
+
+	auto metrics_dump = initial_dump;
+	while (metrics_dump->find("counter") == metrics_dump->end()) {
+		const auto& new_dump =
+			HANDY_METRICS_DUMP_WAIT(metrics_dump->version(), handystats::chrono::duration(1, handystats::chrono::time_unit::SEC));
+		ASSERT_GT(new_dump->version(), metrics_dump->version());
+		metrics_dump = new_dump;
+	}
+
+	// finalization publishes empty dump
+	HANDY_FINALIZE();
+
+	const auto& final_dump = HANDY_METRICS_DUMP();
+	ASSERT_GT(final_dump->version(), metrics_dump->version());
+	ASSERT_TRUE(final_dump->empty());
+
+	// without new dumps the wait expires
+	const auto& same_dump =
+		HANDY_METRICS_DUMP_WAIT(final_dump->version(), handystats::chrono::duration(10, handystats::chrono::time_unit::MSEC));
+	ASSERT_EQ(same_dump->version(), final_dump->version());
+
+	HANDY_INIT();
+	ASSERT_GT(HANDY_METRICS_DUMP_VERSION(), final_dump->version());
+}
+
+TEST_F(MetricsDumpTest, DeltaSinceVersion) {
+	HANDY_ATTRIBUTE_SET("idle", 1);
+	HANDY_COUNTER_INCREMENT("counter");
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	const auto& first_dump = HANDY_METRICS_DUMP();
+	ASSERT_TRUE(first_dump->find("idle") != first_dump->end());
+
+	HANDY_COUNTER_INCREMENT("counter");
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	const auto& delta = HANDY_METRICS_DUMP_SINCE(first_dump->version());
+	ASSERT_FALSE(delta.full);
+	ASSERT_EQ(delta.since, first_dump->version());
+	ASSERT_GT(delta.version, first_dump->version());
+	ASSERT_TRUE(delta.removed.empty());
+
+	bool counter_changed = false;
+	for (auto entry_iter = delta.changed.begin(); entry_iter != delta.changed.end(); ++entry_iter) {
+		// unchanged metric is not reported
+		ASSERT_NE((*entry_iter)->value.first, "idle");
+		ASSERT_GT((*entry_iter)->version, first_dump->version());
+		counter_changed |= (*entry_iter)->value.first == "counter";
+	}
+	ASSERT_TRUE(counter_changed);
+
+	const std::string& json_delta = HANDY_JSON_DUMP_SINCE(first_dump->version(), true);
+	ASSERT_TRUE(json_delta.find("\"full\":false") != std::string::npos);
+	ASSERT_TRUE(json_delta.find("\"counter\":{") != std::string::npos);
+	ASSERT_TRUE(json_delta.find("\"idle\"") == std::string::npos);
+	ASSERT_TRUE(json_delta.find("\"removed\":[]") != std::string::npos);
+
+	// finalization removes all metrics
+	const uint64_t last_version = HANDY_METRICS_DUMP_VERSION();
+	HANDY_FINALIZE();
+
+	const auto& final_delta = HANDY_METRICS_DUMP_SINCE(last_version);
+	ASSERT_FALSE(final_delta.full);
+	ASSERT_TRUE(final_delta.changed.empty());
+	ASSERT_TRUE(std::binary_search(final_delta.removed.begin(), final_delta.removed.end(), "idle"));
+	ASSERT_TRUE(std::binary_search(final_delta.removed.begin(), final_delta.removed.end(), "counter"));
+
+	HANDY_INIT();
+}
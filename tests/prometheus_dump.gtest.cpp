@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) YANDEX LLC. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include <handystats/core.hpp>
+#include <handystats/measuring_points.hpp>
+#include <handystats/metrics_dump.hpp>
+#include <handystats/prometheus_dump.hpp>
+
+#include "message_queue_helper.hpp"
+#include "metrics_dump_helper.hpp"
+
+using handystats::metrics_dump::dump_map;
+using handystats::statistics;
+
+static
+dump_map::entry_ptr make_entry(const std::string& name, const handystats::metrics::metric_variant& metric, const uint64_t& version) {
+	return std::make_shared<const dump_map::entry>(name, metric, version);
+}
+
+static
+dump_map make_dump(const std::vector<dump_map::entry_ptr>& entries, const uint64_t& version) {
+	return dump_map().update(entries, std::vector<std::string>(), version);
+}
+
+static
+bool contains(const std::string& text, const std::string& line) {
+	return text.find(line) != std::string::npos;
+}
+
+TEST(PrometheusDumpTest, MetricTypesMapping) {
+	handystats::metrics::gauge gauge;
+	gauge.set(-1.5);
+
+	handystats::metrics::counter counter;
+	counter.increment(10);
+	counter.increment(-3);
+
+	handystats::config::metrics::timer summary_opts;
+	summary_opts.values.tags = statistics::tag::quantile | statistics::tag::sum | statistics::tag::count;
+	handystats::metrics::timer summary(summary_opts);
+
+	handystats::config::metrics::timer histogram_opts;
+	histogram_opts.values.tags = statistics::tag::histogram | statistics::tag::count;
+	histogram_opts.values.histogram_bins = 5;
+	handystats::metrics::timer histogram(histogram_opts);
+
+	for (int value = 1; value <= 100; ++value) {
+		summary.set(handystats::chrono::duration(value, handystats::chrono::time_unit::USEC));
+		histogram.set(handystats::chrono::duration(value, handystats::chrono::time_unit::USEC));
+	}
+
+	handystats::metrics::attribute flag;
+	flag.set(true);
+	handystats::metrics::attribute version;
+	version.set(std::string("1.2 \"beta\"\n"));
+
+	handystats::metrics::topk clients;
+	clients.add("client-1", 3);
+	clients.add("client-2", 1);
+
+	std::vector<dump_map::entry_ptr> entries;
+	entries.push_back(make_entry("app.counter", counter, 1));
+	entries.push_back(make_entry("app.flag", flag, 1));
+	entries.push_back(make_entry("app.gauge", gauge, 1));
+	entries.push_back(make_entry("app.histogram", histogram, 1));
+	entries.push_back(make_entry("app.summary", summary, 1));
+	entries.push_back(make_entry("app.top-clients", clients, 1));
+	entries.push_back(make_entry("app.version", version, 1));
+
+	const std::string& text = handystats::prometheus::to_string(make_dump(entries, 1));
+
+	ASSERT_TRUE(contains(text, "# TYPE app_gauge gauge\napp_gauge -1.5\n"));
+	ASSERT_TRUE(contains(text, "# TYPE app_counter gauge\napp_counter 7\n"));
+	ASSERT_TRUE(contains(text, "# TYPE app_flag gauge\napp_flag 1\n"));
+
+	ASSERT_TRUE(contains(text, "# TYPE app_summary summary\n"));
+	ASSERT_TRUE(contains(text, "app_summary{quantile=\"0.5\"} "));
+	ASSERT_TRUE(contains(text, "app_summary{quantile=\"0.95\"} "));
+	ASSERT_TRUE(contains(text, "app_summary_sum 5050\n"));
+	ASSERT_TRUE(contains(text, "app_summary_count 100\n"));
+
+	// bins cover moving interval and may decrease, so they are not exposed as histogram's counters
+	ASSERT_FALSE(contains(text, " histogram\n"));
+	ASSERT_TRUE(contains(text, "# TYPE app_histogram_bucket gauge\n"));
+	// their counts are approximate
+	ASSERT_TRUE(contains(text, "app_histogram_bucket{le=\"+Inf\"} "));
+	ASSERT_TRUE(contains(text, "# TYPE app_histogram_count gauge\napp_histogram_count "));
+	ASSERT_FALSE(contains(text, "app_histogram_sum"));
+
+	ASSERT_TRUE(contains(text, "# TYPE app_top_clients gauge\n"));
+	ASSERT_TRUE(contains(text, "app_top_clients{key=\"client-1\"} 3\n"));
+	ASSERT_TRUE(contains(text, "app_top_clients{key=\"client-2\"} 1\n"));
+
+	ASSERT_TRUE(contains(text, "app_version{value=\"1.2 \\\"beta\\\"\\n\"} 1\n"));
+}
+
+TEST(PrometheusDumpTest, NamesAreSanitized) {
+	handystats::metrics::gauge gauge;
+	gauge.set(1);
+
+	std::vector<dump_map::entry_ptr> entries;
+	entries.push_back(make_entry("1st.db:query-time/p", gauge, 1));
+
+	const std::string& text = handystats::prometheus::to_string(make_dump(entries, 1));
+
+	ASSERT_EQ(text, "# TYPE _1st_db:query_time_p gauge\n_1st_db:query_time_p 1\n");
+}
+
+static
+size_t count(const std::string& text, const std::string& line) {
+	size_t occurrences = 0;
+	for (size_t pos = text.find(line); pos != std::string::npos; pos = text.find(line, pos + line.size())) {
+		++occurrences;
+	}
+	return occurrences;
+}
+
+TEST(PrometheusDumpTest, CollidingNamesAreRenderedOnce) {
+	handystats::metrics::gauge gauge;
+	gauge.set(1);
+	handystats::metrics::gauge other;
+	other.set(2);
+
+	handystats::metrics::span span;
+	span.set(
+			handystats::chrono::duration(10, handystats::chrono::time_unit::USEC),
+			handystats::chrono::duration(4, handystats::chrono::time_unit::USEC),
+			handystats::metrics::span::clock::now()
+		);
+
+	std::vector<dump_map::entry_ptr> entries;
+	entries.push_back(make_entry("a.b", gauge, 1));
+	entries.push_back(make_entry("a_b", other, 1));
+	entries.push_back(make_entry("x", span, 1));
+	entries.push_back(make_entry("x_self", other, 1));
+	const dump_map& dump = make_dump(entries, 1);
+
+	// rendered text is taken from the cache the second time
+	for (int render = 0; render < 2; ++render) {
+		const std::string& text = handystats::prometheus::to_string(dump);
+
+		ASSERT_EQ(count(text, "# TYPE a_b "), 1);
+		ASSERT_EQ(count(text, "# TYPE x "), 1);
+		ASSERT_EQ(count(text, "# TYPE x_self "), 1);
+
+		// the later metric in dump's order is skipped
+		ASSERT_TRUE(contains(text, "a_b 1\n"));
+		ASSERT_FALSE(contains(text, "a_b 2\n"));
+		ASSERT_FALSE(contains(text, "x_self 2\n"));
+		ASSERT_TRUE(contains(text, "# handystats: metric \"a_b\" is skipped"));
+		ASSERT_TRUE(contains(text, "# handystats: metric \"x_self\" is skipped"));
+	}
+
+	// name is released as soon as colliding metric is gone
+	const dump_map& without_span = dump.update(
+			std::vector<dump_map::entry_ptr>(), std::vector<std::string>(1, "x"), 2
+		);
+	const std::string& text = handystats::prometheus::to_string(without_span);
+	ASSERT_TRUE(contains(text, "# TYPE x_self gauge\nx_self 2\n"));
+}
+
+TEST(PrometheusDumpTest, OnlyChangedMetricsAreRerendered) {
+	handystats::metrics::gauge gauge;
+	gauge.set(1);
+	handystats::metrics::gauge other;
+	other.set(2);
+
+	std::vector<dump_map::entry_ptr> entries;
+	entries.push_back(make_entry("incremental.gauge", gauge, 1));
+	entries.push_back(make_entry("incremental.other", other, 1));
+	const dump_map& first = make_dump(entries, 1);
+
+	const std::string& first_text = handystats::prometheus::to_string(first);
+	ASSERT_TRUE(contains(first_text, "incremental_gauge 1\n"));
+	ASSERT_TRUE(contains(first_text, "incremental_other 2\n"));
+
+	// snapshot of the same version is taken from the cache even if it's different
+	gauge.set(10);
+	other.set(20);
+	std::vector<dump_map::entry_ptr> changed;
+	changed.push_back(make_entry("incremental.gauge", gauge, 1));
+	changed.push_back(make_entry("incremental.other", other, 2));
+	const dump_map& second = first.update(changed, std::vector<std::string>(), 2);
+
+	const std::string& second_text = handystats::prometheus::to_string(second);
+	ASSERT_TRUE(contains(second_text, "incremental_gauge 1\n"));
+	ASSERT_TRUE(contains(second_text, "incremental_other 20\n"));
+
+	// removed metric is not rendered anymore
+	const dump_map& third = second.update(
+			std::vector<dump_map::entry_ptr>(), std::vector<std::string>(1, "incremental.gauge"), 3
+		);
+	const std::string& third_text = handystats::prometheus::to_string(third);
+	ASSERT_FALSE(contains(third_text, "incremental_gauge"));
+	ASSERT_TRUE(contains(third_text, "incremental_other 20\n"));
+}
+
+class HandyPrometheusDumpTest : public ::testing::Test {
+protected:
+	virtual void SetUp() {
+		HANDY_CONFIG_JSON(
+				"{\
+					\"dump-interval\": 10\
+				}"
+			);
+
+		HANDY_INIT();
+	}
+	virtual void TearDown() {
+		HANDY_FINALIZE();
+	}
+};
+
+TEST_F(HandyPrometheusDumpTest, SharedTextIsRenderedOncePerVersion) {
+	HANDY_GAUGE_SET("prometheus.gauge", 42);
+	HANDY_TIMER_SET("prometheus.timer", handystats::chrono::duration(5, handystats::chrono::time_unit::MSEC));
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	auto metrics_dump = HANDY_METRICS_DUMP();
+	const auto& first = handystats::prometheus::to_shared_string(*metrics_dump);
+	const auto& second = handystats::prometheus::to_shared_string(*metrics_dump);
+	ASSERT_EQ(first.get(), second.get());
+
+	ASSERT_TRUE(contains(*first, "prometheus_gauge 42\n"));
+	ASSERT_TRUE(contains(*first, "# TYPE prometheus_timer gauge\nprometheus_timer 5000\n"));
+	ASSERT_TRUE(contains(*first, "# TYPE handystats_message_queue_size gauge\n"));
+
+	ASSERT_TRUE(contains(HANDY_PROMETHEUS_DUMP(), "prometheus_gauge 42\n"));
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) YANDEX LLC. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <handystats/atomic.hpp>
+
+#include "published_ptr_impl.hpp"
+
+using handystats::published_ptr;
+
+TEST(PublishedPtrTest, LoadReturnsLastStored) {
+	published_ptr<const int> ptr;
+	ASSERT_FALSE(ptr.load());
+
+	for (int value = 0; value < 10; ++value) {
+		ptr.store(std::make_shared<const int>(value));
+		ASSERT_EQ(*ptr.load(), value);
+	}
+}
+
+TEST(PublishedPtrTest, ReadersSeeMonotonicValues) {
+	const int STORES_COUNT = 100000;
+	const size_t READERS_COUNT = 4;
+
+	published_ptr<const int> ptr(std::make_shared<const int>(0));
+	std::atomic<bool> stop(false);
+	std::atomic<bool> failed(false);
+
+	std::vector<std::thread> readers;
+	for (size_t index = 0; index < READERS_COUNT; ++index) {
+		readers.push_back(std::thread([&ptr, &stop, &failed] () {
+					int last_value = 0;
+					while (!stop.load()) {
+						const auto& value = ptr.load();
+						if (!value || *value < last_value) {
+							failed.store(true);
+						}
+						last_value = *value;
+					}
+				}));
+	}
+
+	for (int value = 1; value <= STORES_COUNT; ++value) {
+		ptr.store(std::make_shared<const int>(value));
+	}
+
+	stop.store(true);
+	for (auto reader = readers.begin(); reader != readers.end(); ++reader) {
+		reader->join();
+	}
+
+	ASSERT_FALSE(failed.load());
+	ASSERT_EQ(*ptr.load(), STORES_COUNT);
+}
+
+TEST(PublishedPtrTest, PreviousValuesAreReleased) {
+	published_ptr<const int> ptr;
+
+	std::weak_ptr<const int> first;
+	{
+		auto value = std::make_shared<const int>(1);
+		first = value;
+		ptr.store(value);
+	}
+
+	ptr.store(std::make_shared<const int>(2));
+	ptr.store(std::make_shared<const int>(3));
+
+	ASSERT_TRUE(first.expired());
+}
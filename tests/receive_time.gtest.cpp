@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) YANDEX LLC. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <handystats/core.hpp>
+#include <handystats/measuring_points.hpp>
+#include <handystats/metrics_dump.hpp>
+
+#include "receive_time_impl.hpp"
+
+#include "message_queue_helper.hpp"
+#include "metrics_dump_helper.hpp"
+
+class ReceiveTimeTest : public ::testing::Test {
+protected:
+	virtual void SetUp() {
+		HANDY_CONFIG_JSON(
+				"{\
+					\"dump-interval\": 10,\
+					\"defaults\": {\
+						\"tags\": [\"value\", \"count\", \"timestamp\"]\
+					},\
+					\"gauge\": {\
+						\"receive-time\": true\
+					},\
+					\"rt.*\": {\
+						\"receive-time\": true\
+					}\
+				}"
+			);
+
+		HANDY_INIT();
+	}
+	virtual void TearDown() {
+		HANDY_FINALIZE();
+	}
+};
+
+TEST_F(ReceiveTimeTest, ModeIsResolvedByPattern) {
+	const handystats::chrono::time_point unset;
+	const auto& timestamp = handystats::chrono::tsc_clock::now();
+
+	ASSERT_TRUE(handystats::receive_time::is_unset(handystats::receive_time::counter_timestamp("rt.counter", unset)));
+	ASSERT_FALSE(handystats::receive_time::is_unset(handystats::receive_time::counter_timestamp("counter", unset)));
+
+	// gauges are in receive-time mode by default
+	ASSERT_TRUE(handystats::receive_time::is_unset(handystats::receive_time::gauge_timestamp("gauge", unset)));
+
+	// explicit timestamp is kept as is
+	ASSERT_TRUE(handystats::receive_time::counter_timestamp("rt.counter", timestamp) == timestamp);
+}
+
+TEST_F(ReceiveTimeTest, CacheOfDynamicNamesIsBounded) {
+	const handystats::chrono::time_point unset;
+
+	for (size_t index = 0; index < 3 * handystats::receive_time::MAX_CACHED_NAMES; ++index) {
+		const std::string& suffix = std::to_string(index);
+		ASSERT_TRUE(handystats::receive_time::is_unset(handystats::receive_time::counter_timestamp("rt.counter." + suffix, unset)));
+		ASSERT_FALSE(handystats::receive_time::is_unset(handystats::receive_time::counter_timestamp("counter." + suffix, unset)));
+		ASSERT_TRUE(handystats::receive_time::is_unset(handystats::receive_time::gauge_timestamp("gauge." + suffix, unset)));
+
+		ASSERT_LE(handystats::receive_time::cached_names(), 2 * handystats::receive_time::MAX_CACHED_NAMES);
+	}
+}
+
+TEST_F(ReceiveTimeTest, EventsAreTimestampedOnReceive) {
+	const auto& start_time = handystats::chrono::tsc_clock::now();
+
+	const int COUNT = 1000;
+	for (int index = 0; index < COUNT; ++index) {
+		HANDY_COUNTER_INCREMENT("rt.counter");
+		HANDY_COUNTER_INCREMENT("counter");
+		HANDY_GAUGE_SET("gauge", index);
+	}
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	auto metrics_dump = HANDY_METRICS_DUMP();
+
+	const auto& rt_counter = boost::get<handystats::metrics::counter>(metrics_dump->at("rt.counter"));
+	ASSERT_EQ(rt_counter.values().get<handystats::statistics::tag::value>(), COUNT);
+	ASSERT_TRUE(rt_counter.values().get<handystats::statistics::tag::timestamp>() > start_time);
+
+	const auto& counter = boost::get<handystats::metrics::counter>(metrics_dump->at("counter"));
+	ASSERT_EQ(counter.values().get<handystats::statistics::tag::value>(), COUNT);
+
+	const auto& gauge = boost::get<handystats::metrics::gauge>(metrics_dump->at("gauge"));
+	ASSERT_EQ(gauge.values().get<handystats::statistics::tag::count>(), COUNT);
+	ASSERT_EQ(gauge.values().get<handystats::statistics::tag::value>(), COUNT - 1);
+	ASSERT_TRUE(gauge.values().get<handystats::statistics::tag::timestamp>() > start_time);
+
+	ASSERT_TRUE(metrics_dump->find("handystats.message_queue.receive_time_skew") != metrics_dump->end());
+	const auto& skew = boost::get<handystats::metrics::gauge>(metrics_dump->at("handystats.message_queue.receive_time_skew"));
+	ASSERT_GE(skew.values().get<handystats::statistics::tag::max>(), 0);
+}
@@ -24,6 +24,7 @@
 #include <map>
 #include <memory>
 #include <chrono>
+#include <atomic>
 
 #include <gtest/gtest.h>
 
@@ -34,6 +35,7 @@
 
 #include "message_queue_helper.hpp"
 #include "metrics_dump_helper.hpp"
+#include "timer_handles_impl.hpp"
 
 class HandyScopedTimerTest : public ::testing::Test {
 protected:
@@ -207,3 +209,120 @@ TEST_F(HandyScopedTimerTest, TestSeveralScopedTimersInOneScope) {
 		);
 }
 
+
+TEST_F(HandyScopedTimerTest, TestHandleScopedTimer) {
+	const int COUNT = 1000;
+	const int THREADS = 4;
+
+	auto timer_handle = HANDY_TIMER_RESOLVE("handle.time");
+	ASSERT_TRUE(timer_handle == HANDY_TIMER_RESOLVE(std::string("handle") + ".time"));
+
+	std::vector<std::thread> threads;
+	for (int thread = 0; thread < THREADS; ++thread) {
+		threads.push_back(std::thread([timer_handle, COUNT] () {
+				for (int step = 0; step < COUNT; ++step) {
+					HANDY_TIMER_HANDLE_SCOPE(timer_handle);
+				}
+			}));
+	}
+	for (auto thread_iter = threads.begin(); thread_iter != threads.end(); ++thread_iter) {
+		thread_iter->join();
+	}
+
+	{
+		HANDY_TIMER_HANDLE_SCOPE(timer_handle);
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	handystats::message_queue::wait_until_empty();
+	// measurements recorded via handles are passed to the timer by the processor loop
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	auto metrics_dump = HANDY_METRICS_DUMP();
+
+	ASSERT_TRUE(metrics_dump->find("handle.time") != metrics_dump->end());
+
+	const auto& agg_stats =
+		boost::get<handystats::metrics::timer>(metrics_dump->at("handle.time"))
+		.values();
+
+	ASSERT_EQ(agg_stats.get<handystats::statistics::tag::count>(), THREADS * COUNT + 1);
+	ASSERT_GE(
+			agg_stats.get<handystats::statistics::tag::max>(),
+			handystats::chrono::duration::convert_to(handystats::metrics::timer::value_unit,
+				handystats::chrono::duration(1, handystats::chrono::time_unit::MSEC)).count()
+		);
+}
+
+TEST_F(HandyScopedTimerTest, TestHandlesAreProcessedUnderLoad) {
+	const int HANDLES = 50;
+	const int COUNT = 100;
+
+	std::vector<handystats_timer_handle*> handles;
+	for (int index = 0; index < HANDLES; ++index) {
+		handles.push_back(HANDY_TIMER_RESOLVE("load.time." + std::to_string(index)));
+	}
+
+	// message queue is never empty, so measurements are not passed on idle processor's passes
+	std::atomic<bool> stop(false);
+	std::thread load([&stop] () {
+			while (!stop.load()) {
+				HANDY_COUNTER_INCREMENT("load.counter");
+			}
+		});
+
+	std::vector<std::thread> threads;
+	for (int thread = 0; thread < 2; ++thread) {
+		threads.push_back(std::thread([&handles, COUNT] () {
+				for (int step = 0; step < COUNT; ++step) {
+					for (auto handle = handles.begin(); handle != handles.end(); ++handle) {
+						HANDY_TIMER_HANDLE_SCOPE(*handle);
+					}
+				}
+			}));
+	}
+	for (auto thread_iter = threads.begin(); thread_iter != threads.end(); ++thread_iter) {
+		thread_iter->join();
+	}
+
+	bool processed = false;
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	while (!processed && std::chrono::steady_clock::now() < deadline) {
+		handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+		auto metrics_dump = HANDY_METRICS_DUMP();
+
+		processed = true;
+		for (int index = 0; index < HANDLES && processed; ++index) {
+			auto metric_iter = metrics_dump->find("load.time." + std::to_string(index));
+			processed = metric_iter != metrics_dump->end() &&
+				boost::get<handystats::metrics::timer>(metric_iter->second).values().get<handystats::statistics::tag::count>() == 2 * COUNT;
+		}
+	}
+
+	stop.store(true);
+	load.join();
+
+	ASSERT_TRUE(processed);
+}
+
+TEST_F(HandyScopedTimerTest, TestHandleBoundToOtherMetricType) {
+	HANDY_GAUGE_SET("handle.mismatch", 1);
+	handystats::message_queue::wait_until_empty();
+
+	handystats_timer_handle* handle = HANDY_TIMER_RESOLVE("handle.mismatch");
+	for (int step = 0; step < 10; ++step) {
+		HANDY_TIMER_HANDLE_SCOPE(handle);
+	}
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	// the mismatch is remembered, so the metric isn't looked up for every measurement
+	ASSERT_TRUE(handle->mismatched);
+
+	auto metrics_dump = HANDY_METRICS_DUMP();
+	auto metric_iter = metrics_dump->find("handle.mismatch");
+	ASSERT_TRUE(metric_iter != metrics_dump->end());
+	ASSERT_EQ(metric_iter->second.which(), handystats::metrics::metric_index::GAUGE);
+}
@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) YANDEX LLC. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include <gtest/gtest.h>
+
+#include <handystats/core.hpp>
+#include <handystats/measuring_points.hpp>
+#include <handystats/metrics_dump.hpp>
+#include <handystats/binary_dump.hpp>
+#include <handystats/shared_dump.hpp>
+
+#include "message_queue_helper.hpp"
+#include "metrics_dump_helper.hpp"
+
+static const char* const READER_PATH_ENV = "HANDYSTATS_SHARED_DUMP_READER_PATH";
+
+static std::string segment_path() {
+	return "/dev/shm/handystats-shared-dump-test." + std::to_string(getpid());
+}
+
+static bool segment_exists(const std::string& path) {
+	struct stat file_stat;
+	return stat(path.c_str(), &file_stat) == 0;
+}
+
+class SharedDumpTest : public ::testing::Test {
+protected:
+	virtual void SetUp() {
+		path = segment_path();
+
+		const std::string& config =
+			"{\
+				\"dump-interval\": 1,\
+				\"dump-shared-memory\": \"" + path + "\"\
+			}";
+		HANDY_CONFIG_JSON(config.c_str());
+
+		HANDY_INIT();
+	}
+	virtual void TearDown() {
+		HANDY_FINALIZE();
+	}
+
+	std::string path;
+};
+
+TEST_F(SharedDumpTest, ReadInProcess) {
+	handystats::shared_dump::reader reader(path);
+	std::string buffer;
+
+	// empty dump is published on start
+	ASSERT_TRUE(reader.read(buffer));
+	ASSERT_EQ(handystats::binary::reader(buffer).size(), 0);
+
+	HANDY_GAUGE_SET("gauge", 42);
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+	HANDY_METRICS_DUMP_WAIT(HANDY_METRICS_DUMP_VERSION(), handystats::chrono::duration(1, handystats::chrono::time_unit::SEC));
+
+	ASSERT_TRUE(reader.read(buffer));
+	ASSERT_GE(reader.version(), HANDY_METRICS_DUMP_VERSION() - 1);
+
+	handystats::binary::reader dump(buffer);
+	ASSERT_EQ(dump.version(), reader.version());
+	ASSERT_LT(dump.find("gauge"), dump.size());
+	ASSERT_DOUBLE_EQ(dump[dump.find("gauge")].values().get(handystats::statistics::tag::value), 42);
+}
+
+TEST_F(SharedDumpTest, SegmentGrowsWithDump) {
+	handystats::shared_dump::reader reader(path);
+	std::string buffer;
+	ASSERT_TRUE(reader.read(buffer));
+
+	const size_t METRICS_COUNT = 1000;
+	for (size_t index = 0; index < METRICS_COUNT; ++index) {
+		HANDY_GAUGE_SET("shared_dump.test.growing.gauge." + std::to_string(index), index);
+	}
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+	HANDY_METRICS_DUMP_WAIT(HANDY_METRICS_DUMP_VERSION(), handystats::chrono::duration(1, handystats::chrono::time_unit::SEC));
+
+	// reader follows the segment that has been replaced by the larger one
+	ASSERT_TRUE(reader.read(buffer));
+	ASSERT_GT(buffer.size(), 64 * 1024);
+
+	handystats::binary::reader dump(buffer);
+	const size_t last = dump.find("shared_dump.test.growing.gauge." + std::to_string(METRICS_COUNT - 1));
+	ASSERT_LT(last, dump.size());
+	ASSERT_DOUBLE_EQ(dump[last].values().get(handystats::statistics::tag::value), METRICS_COUNT - 1);
+}
+
+// runs reader in separate process while dumps keep being published
+TEST_F(SharedDumpTest, ReadFromOtherProcess) {
+	HANDY_GAUGE_SET("shared_dump.test.gauge", 0);
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	const std::string& env = std::string(READER_PATH_ENV) + "=" + path;
+	char* const envp[] = {const_cast<char*>(env.c_str()), nullptr};
+
+	const pid_t pid = fork();
+	ASSERT_GE(pid, 0);
+	if (pid == 0) {
+		execle("/proc/self/exe", "/proc/self/exe", "--gtest_filter=SharedDumpReaderProcess.*", (char*)NULL, envp);
+		_exit(1);
+	}
+
+	int status = 0;
+	int value = 0;
+	const auto& deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+	while (waitpid(pid, &status, WNOHANG) == 0) {
+		if (std::chrono::steady_clock::now() > deadline) {
+			kill(pid, SIGKILL);
+			waitpid(pid, &status, 0);
+			FAIL() << "reader process hasn't finished in time";
+		}
+
+		HANDY_GAUGE_SET("shared_dump.test.gauge", ++value);
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	ASSERT_TRUE(WIFEXITED(status));
+	ASSERT_EQ(WEXITSTATUS(status), 0);
+}
+
+TEST(SharedDumpLifetimeTest, SegmentIsRemovedOnFinalize) {
+	const std::string& path = segment_path();
+	const std::string& config = "{\"dump-shared-memory\": \"" + path + "\"}";
+	HANDY_CONFIG_JSON(config.c_str());
+
+	HANDY_INIT();
+	ASSERT_TRUE(segment_exists(path));
+
+	HANDY_FINALIZE();
+	ASSERT_FALSE(segment_exists(path));
+
+	std::string buffer;
+	handystats::shared_dump::reader reader(path);
+	ASSERT_FALSE(reader.read(buffer));
+}
+
+TEST(SharedDumpLifetimeTest, PlantedSymlinkIsNotFollowed) {
+	const std::string& path = segment_path();
+	const std::string& victim = path + ".victim";
+	{
+		std::ofstream victim_file(victim.c_str());
+		victim_file << "precious";
+	}
+	// previous versions prepared the segment at this predictable path
+	ASSERT_EQ(symlink(victim.c_str(), (path + ".tmp").c_str()), 0);
+
+	const std::string& config = "{\"dump-shared-memory\": \"" + path + "\"}";
+	HANDY_CONFIG_JSON(config.c_str());
+
+	HANDY_INIT();
+	ASSERT_TRUE(segment_exists(path));
+	HANDY_FINALIZE();
+
+	std::string content;
+	std::getline(std::ifstream(victim.c_str()), content);
+	ASSERT_EQ(content, "precious");
+
+	unlink((path + ".tmp").c_str());
+	unlink(victim.c_str());
+}
+
+TEST(SharedDumpLifetimeTest, ReaderGivesUpOnAbandonedSlot) {
+	const std::string& path = segment_path();
+
+	// segment which writer has died while copying the current slot:
+	// magic, layout version, capacity, stale flag, reserved, generation and slots' sequence, size and version
+	const uint64_t CAPACITY = 4096;
+	std::string segment(4096 + 2 * CAPACITY, '\0');
+	memcpy(&segment[0], "HSSM", 4);
+	const uint32_t layout_version = 1;
+	memcpy(&segment[4], &layout_version, sizeof(layout_version));
+	memcpy(&segment[8], &CAPACITY, sizeof(CAPACITY));
+	const uint64_t generation = 1;
+	memcpy(&segment[24], &generation, sizeof(generation));
+	const uint64_t sequence = 1;
+	memcpy(&segment[32 + 24 * 1], &sequence, sizeof(sequence));
+	{
+		std::ofstream segment_file(path.c_str(), std::ios::binary);
+		segment_file.write(segment.data(), segment.size());
+	}
+
+	std::string buffer;
+	handystats::shared_dump::reader reader(path);
+	ASSERT_THROW(reader.read(buffer), std::runtime_error);
+
+	unlink(path.c_str());
+}
+
+// executed in the reader process spawned by SharedDumpTest.ReadFromOtherProcess
+TEST(SharedDumpReaderProcess, ReadConsistentDumps) {
+	const char* path = getenv(READER_PATH_ENV);
+	if (!path) {
+		return;
+	}
+
+	handystats::shared_dump::reader reader(path);
+	std::string buffer;
+
+	uint64_t last_version = 0;
+	double last_value = -1;
+	size_t dumps_count = 0;
+	while (dumps_count < 20) {
+		ASSERT_TRUE(reader.read(buffer));
+		if (reader.version() == last_version) {
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+			continue;
+		}
+		ASSERT_GT(reader.version(), last_version);
+		last_version = reader.version();
+
+		// every read dump is complete
+		handystats::binary::reader dump(buffer);
+		ASSERT_EQ(dump.version(), reader.version());
+
+		const size_t index = dump.find("shared_dump.test.gauge");
+		ASSERT_LT(index, dump.size());
+
+		const double value = dump[index].values().get(handystats::statistics::tag::value);
+		ASSERT_GE(value, last_value);
+		last_value = value;
+
+		++dumps_count;
+	}
+}
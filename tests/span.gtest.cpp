@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) YANDEX LLC. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+
+#include <string>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include <handystats/core.hpp>
+#include <handystats/measuring_points.hpp>
+#include <handystats/metrics_dump.hpp>
+#include <handystats/json_dump.hpp>
+#include <handystats/metrics/span.hpp>
+
+#include "message_queue_helper.hpp"
+#include "metrics_dump_helper.hpp"
+#include "span_nodes_impl.hpp"
+
+using handystats::metrics::span;
+using handystats::statistics;
+
+TEST(SpanTest, InclusiveAndSelfStatistics) {
+	span metric;
+
+	const auto timestamp = span::clock::now();
+	metric.set(
+			handystats::chrono::duration(10, handystats::chrono::time_unit::MSEC),
+			handystats::chrono::duration(4, handystats::chrono::time_unit::MSEC),
+			timestamp
+		);
+
+	ASSERT_EQ(metric.inclusive().get<statistics::tag::count>(), 1);
+	ASSERT_EQ(metric.self().get<statistics::tag::count>(), 1);
+	ASSERT_DOUBLE_EQ(metric.inclusive().get<statistics::tag::value>(), 10000);
+	ASSERT_DOUBLE_EQ(metric.self().get<statistics::tag::value>(), 4000);
+}
+
+class HandySpanTest : public ::testing::Test {
+protected:
+	virtual void SetUp() {
+		HANDY_CONFIG_JSON(
+				"{\
+					\"dump-interval\": 10,\
+					\"span\": {\
+						\"max-depth\": 3\
+					}\
+				}"
+			);
+
+		HANDY_INIT();
+	}
+	virtual void TearDown() {
+		HANDY_FINALIZE();
+	}
+};
+
+TEST_F(HandySpanTest, NestedSpansSelfTime) {
+	using handystats::chrono::duration;
+	using handystats::chrono::time_unit;
+
+	const size_t REQUESTS_COUNT = 10;
+
+	auto timestamp = span::clock::now();
+	for (size_t request = 0; request < REQUESTS_COUNT; ++request) {
+		handystats::measuring_points::span_enter("req", timestamp);
+		timestamp += duration(1, time_unit::MSEC);
+
+		handystats::measuring_points::span_enter("db", timestamp);
+		timestamp += duration(2, time_unit::MSEC);
+
+		handystats::measuring_points::span_enter("retry", timestamp);
+		timestamp += duration(3, time_unit::MSEC);
+
+		// nested deeper than max-depth, accounted in "req.db.retry" self time
+		handystats::measuring_points::span_enter("backoff", timestamp);
+		timestamp += duration(4, time_unit::MSEC);
+		handystats::measuring_points::span_exit(timestamp);
+
+		handystats::measuring_points::span_exit(timestamp);
+
+		timestamp += duration(5, time_unit::MSEC);
+		handystats::measuring_points::span_exit(timestamp);
+
+		timestamp += duration(6, time_unit::MSEC);
+		handystats::measuring_points::span_exit(timestamp);
+	}
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	auto metrics_dump = HANDY_METRICS_DUMP();
+
+	ASSERT_TRUE(metrics_dump->find("req.db.retry.backoff") == metrics_dump->end());
+
+	const struct {
+		const char* name;
+		double inclusive;
+		double self;
+	} expected[] = {
+		{"req", 21000, 7000},
+		{"req.db", 14000, 7000},
+		{"req.db.retry", 7000, 7000}
+	};
+
+	for (size_t index = 0; index < sizeof(expected) / sizeof(*expected); ++index) {
+		ASSERT_TRUE(metrics_dump->find(expected[index].name) != metrics_dump->end());
+		const auto& node = boost::get<span>(metrics_dump->at(expected[index].name));
+
+		ASSERT_EQ(node.inclusive().get<statistics::tag::count>(), REQUESTS_COUNT);
+		// tsc ticks conversion could be off by a microsecond
+		ASSERT_NEAR(node.inclusive().get<statistics::tag::avg>(), expected[index].inclusive, 2);
+		ASSERT_NEAR(node.self().get<statistics::tag::avg>(), expected[index].self, 2);
+	}
+
+	const std::string& json_dump = HANDY_JSON_DUMP();
+	ASSERT_TRUE(json_dump.find("\"span\"") != std::string::npos);
+	ASSERT_TRUE(json_dump.find("\"self\"") != std::string::npos);
+}
+
+TEST_F(HandySpanTest, ScopedSpans) {
+	for (int request = 0; request < 100; ++request) {
+		HANDY_SPAN_SCOPE("request");
+		{
+			HANDY_SPAN_SCOPE(("stage.%d", request % 2));
+		}
+	}
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	auto metrics_dump = HANDY_METRICS_DUMP();
+
+	ASSERT_EQ(boost::get<span>(metrics_dump->at("request")).inclusive().get<statistics::tag::count>(), 100);
+	ASSERT_EQ(boost::get<span>(metrics_dump->at("request.stage.0")).inclusive().get<statistics::tag::count>(), 50);
+	ASSERT_EQ(boost::get<span>(metrics_dump->at("request.stage.1")).inclusive().get<statistics::tag::count>(), 50);
+
+	const auto& request = boost::get<span>(metrics_dump->at("request"));
+	ASSERT_LE(request.self().get<statistics::tag::sum>(), request.inclusive().get<statistics::tag::sum>());
+}
+
+TEST_F(HandySpanTest, DisabledSpansAreNotAdmitted) {
+	HANDY_FINALIZE();
+
+	{
+		HANDY_SPAN_SCOPE("disabled");
+		{
+			HANDY_SPAN_SCOPE("nested");
+		}
+		ASSERT_EQ(handystats::span_nodes::size(), 0);
+
+		HANDY_INIT();
+	}
+
+	// stack is balanced, so the next span is the root one
+	{
+		HANDY_SPAN_SCOPE("enabled");
+	}
+	ASSERT_EQ(handystats::span_nodes::size(), 1);
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	auto metrics_dump = HANDY_METRICS_DUMP();
+	ASSERT_TRUE(metrics_dump->find("enabled") != metrics_dump->end());
+	ASSERT_TRUE(metrics_dump->find("disabled") == metrics_dump->end());
+}
@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) YANDEX LLC. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+#include <random>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include <handystats/statistics.hpp>
+
+#include <handystats/chrono.hpp>
+
+using handystats::statistics;
+
+class StatisticsMergeTest : public ::testing::TestWithParam<unsigned> {
+protected:
+	virtual void SetUp() {
+		opts = handystats::config::statistics();
+		opts.tags =
+			statistics::tag::value | statistics::tag::min | statistics::tag::max |
+			statistics::tag::count | statistics::tag::sum | statistics::tag::avg |
+			statistics::tag::moving_count | statistics::tag::moving_sum | statistics::tag::moving_avg |
+			statistics::tag::quantile | statistics::tag::timestamp;
+		opts.histogram_bins = 30;
+
+		start = statistics::clock::now();
+	}
+
+	// feeds random data stream into `single` and splits the same stream between `left` and `right`
+	void feed(statistics& single, statistics& left, statistics& right,
+			const size_t& count, const handystats::chrono::duration& step
+		)
+	{
+		std::mt19937 gen(GetParam());
+		std::uniform_real_distribution<double> value_dist(0.0, 1000.0);
+		std::bernoulli_distribution side_dist(0.3);
+
+		auto timestamp = start;
+		for (size_t index = 0; index < count; ++index) {
+			const double value = value_dist(gen);
+			timestamp += step;
+
+			single.update(value, timestamp);
+			if (side_dist(gen)) {
+				left.update(value, timestamp);
+			}
+			else {
+				right.update(value, timestamp);
+			}
+		}
+	}
+
+	static void check_equivalent(const statistics& expected, const statistics& actual,
+			const double& moving_tolerance, const double& quantile_tolerance
+		)
+	{
+		ASSERT_DOUBLE_EQ(expected.get<statistics::tag::value>(), actual.get<statistics::tag::value>());
+		ASSERT_DOUBLE_EQ(expected.get<statistics::tag::min>(), actual.get<statistics::tag::min>());
+		ASSERT_DOUBLE_EQ(expected.get<statistics::tag::max>(), actual.get<statistics::tag::max>());
+		ASSERT_EQ(expected.get<statistics::tag::count>(), actual.get<statistics::tag::count>());
+		ASSERT_NEAR(expected.get<statistics::tag::sum>(), actual.get<statistics::tag::sum>(), 1E-6 * expected.get<statistics::tag::sum>());
+		ASSERT_NEAR(expected.get<statistics::tag::avg>(), actual.get<statistics::tag::avg>(), 1E-6);
+		ASSERT_TRUE(expected.get<statistics::tag::timestamp>() == actual.get<statistics::tag::timestamp>());
+
+		ASSERT_NEAR(
+				expected.get<statistics::tag::moving_count>(),
+				actual.get<statistics::tag::moving_count>(),
+				moving_tolerance * expected.get<statistics::tag::moving_count>()
+			);
+		ASSERT_NEAR(
+				expected.get<statistics::tag::moving_sum>(),
+				actual.get<statistics::tag::moving_sum>(),
+				moving_tolerance * expected.get<statistics::tag::moving_sum>()
+			);
+		ASSERT_NEAR(
+				expected.get<statistics::tag::moving_avg>(),
+				actual.get<statistics::tag::moving_avg>(),
+				moving_tolerance * expected.get<statistics::tag::moving_avg>()
+			);
+
+		ASSERT_LE(actual.get<statistics::tag::histogram>().size(), 30);
+
+		const double probabilities[] = {0.1, 0.25, 0.5, 0.75, 0.9, 0.99};
+		for (size_t index = 0; index < sizeof(probabilities) / sizeof(*probabilities); ++index) {
+			ASSERT_NEAR(
+					expected.get<statistics::tag::quantile>().at(probabilities[index]),
+					actual.get<statistics::tag::quantile>().at(probabilities[index]),
+					quantile_tolerance
+				);
+		}
+	}
+
+	handystats::config::statistics opts;
+	statistics::time_point start;
+};
+
+TEST_P(StatisticsMergeTest, MergeWithinMovingInterval) {
+	opts.moving_interval = handystats::chrono::duration(10, handystats::chrono::time_unit::SEC);
+
+	statistics single(opts), left(opts), right(opts);
+	feed(single, left, right, 5000, handystats::chrono::duration(1, handystats::chrono::time_unit::MSEC));
+
+	left.merge(right);
+
+	// values are in [0, 1000), quantile tolerance is 3% of the range
+	check_equivalent(single, left, 0.01, 30.0);
+}
+
+TEST_P(StatisticsMergeTest, MergeBeyondMovingInterval) {
+	opts.moving_interval = handystats::chrono::duration(500, handystats::chrono::time_unit::MSEC);
+
+	statistics single(opts), left(opts), right(opts);
+	feed(single, left, right, 5000, handystats::chrono::duration(1, handystats::chrono::time_unit::MSEC));
+
+	left.merge(right);
+
+	check_equivalent(single, left, 0.05, 50.0);
+}
+
+TEST_P(StatisticsMergeTest, MergeIsSymmetric) {
+	opts.moving_interval = handystats::chrono::duration(1, handystats::chrono::time_unit::SEC);
+
+	statistics single(opts), left(opts), right(opts);
+	feed(single, left, right, 3000, handystats::chrono::duration(1, handystats::chrono::time_unit::MSEC));
+
+	statistics left_right(left);
+	left_right.merge(right);
+
+	statistics right_left(right);
+	right_left.merge(left);
+
+	ASSERT_EQ(left_right.get<statistics::tag::count>(), right_left.get<statistics::tag::count>());
+	ASSERT_DOUBLE_EQ(left_right.get<statistics::tag::value>(), right_left.get<statistics::tag::value>());
+	ASSERT_DOUBLE_EQ(left_right.get<statistics::tag::min>(), right_left.get<statistics::tag::min>());
+	ASSERT_DOUBLE_EQ(left_right.get<statistics::tag::max>(), right_left.get<statistics::tag::max>());
+	ASSERT_NEAR(left_right.get<statistics::tag::moving_count>(), right_left.get<statistics::tag::moving_count>(), 1E-6);
+	ASSERT_NEAR(left_right.get<statistics::tag::moving_sum>(), right_left.get<statistics::tag::moving_sum>(), 1E-3);
+	ASSERT_NEAR(
+			left_right.get<statistics::tag::quantile>().at(0.5),
+			right_left.get<statistics::tag::quantile>().at(0.5),
+			30.0
+		);
+}
+
+INSTANTIATE_TEST_CASE_P(RandomStreams, StatisticsMergeTest, ::testing::Values(1u, 7u, 42u, 1337u, 2015u));
+
+TEST(StatisticsMergeRateTest, RateIsSummed) {
+	handystats::config::statistics opts;
+	opts.tags = statistics::tag::rate;
+	opts.moving_interval = handystats::chrono::duration(1, handystats::chrono::time_unit::SEC);
+	opts.rate_unit = handystats::chrono::time_unit::SEC;
+
+	statistics left(opts), right(opts);
+
+	auto timestamp = statistics::clock::now();
+	for (int value = 1; value <= 100; ++value) {
+		timestamp += handystats::chrono::duration(1, handystats::chrono::time_unit::MSEC);
+		left.update(value, timestamp);
+		right.update(2 * value, timestamp);
+	}
+
+	const double expected_rate = left.get<statistics::tag::rate>() + right.get<statistics::tag::rate>();
+
+	left.merge(right);
+
+	ASSERT_NEAR(left.get<statistics::tag::rate>(), expected_rate, 1E-6);
+}
+
+TEST(StatisticsMergeRateTest, MergeIntoEmpty) {
+	handystats::config::statistics opts;
+	opts.tags = statistics::tag::value | statistics::tag::min | statistics::tag::max |
+		statistics::tag::count | statistics::tag::moving_count | statistics::tag::histogram;
+
+	statistics empty(opts), data(opts);
+
+	auto timestamp = statistics::clock::now();
+	for (int value = 1; value <= 100; ++value) {
+		timestamp += handystats::chrono::duration(1, handystats::chrono::time_unit::MSEC);
+		data.update(value, timestamp);
+	}
+
+	empty.merge(data);
+
+	ASSERT_DOUBLE_EQ(empty.get<statistics::tag::value>(), 100);
+	ASSERT_DOUBLE_EQ(empty.get<statistics::tag::min>(), 1);
+	ASSERT_DOUBLE_EQ(empty.get<statistics::tag::max>(), 100);
+	ASSERT_EQ(empty.get<statistics::tag::count>(), 100);
+	ASSERT_NEAR(empty.get<statistics::tag::moving_count>(), data.get<statistics::tag::moving_count>(), 1E-6);
+	ASSERT_EQ(empty.get<statistics::tag::histogram>().size(), data.get<statistics::tag::histogram>().size());
+}
+
+TEST(StatisticsSnapshotTest, SerializationRoundTrip) {
+	handystats::config::statistics opts;
+	opts.tags = statistics::tag::value | statistics::tag::min | statistics::tag::max |
+		statistics::tag::count | statistics::tag::sum | statistics::tag::moving_avg |
+		statistics::tag::quantile | statistics::tag::rate | statistics::tag::timestamp;
+
+	statistics stats(opts);
+	auto timestamp = statistics::clock::now();
+	for (int value = 1; value <= 1000; ++value) {
+		timestamp += handystats::chrono::duration(100, handystats::chrono::time_unit::USEC);
+		stats.update(value % 97, timestamp);
+	}
+
+	const std::string& data = stats.snapshot().serialize();
+	statistics restored(statistics::snapshot_type::deserialize(data));
+
+	ASSERT_EQ(restored.tags(), stats.tags());
+	ASSERT_DOUBLE_EQ(restored.get<statistics::tag::value>(), stats.get<statistics::tag::value>());
+	ASSERT_DOUBLE_EQ(restored.get<statistics::tag::min>(), stats.get<statistics::tag::min>());
+	ASSERT_DOUBLE_EQ(restored.get<statistics::tag::max>(), stats.get<statistics::tag::max>());
+	ASSERT_EQ(restored.get<statistics::tag::count>(), stats.get<statistics::tag::count>());
+	ASSERT_DOUBLE_EQ(restored.get<statistics::tag::sum>(), stats.get<statistics::tag::sum>());
+	ASSERT_DOUBLE_EQ(restored.get<statistics::tag::moving_avg>(), stats.get<statistics::tag::moving_avg>());
+	ASSERT_DOUBLE_EQ(restored.get<statistics::tag::rate>(), stats.get<statistics::tag::rate>());
+	ASSERT_DOUBLE_EQ(restored.get<statistics::tag::quantile>().at(0.5), stats.get<statistics::tag::quantile>().at(0.5));
+	ASSERT_TRUE(restored.get<statistics::tag::timestamp>() == stats.get<statistics::tag::timestamp>());
+
+	// restored statistics should continue to accumulate data
+	timestamp += handystats::chrono::duration(100, handystats::chrono::time_unit::USEC);
+	stats.update(1000, timestamp);
+	restored.update(1000, timestamp);
+	ASSERT_DOUBLE_EQ(restored.get<statistics::tag::max>(), stats.get<statistics::tag::max>());
+	ASSERT_DOUBLE_EQ(restored.get<statistics::tag::moving_avg>(), stats.get<statistics::tag::moving_avg>());
+}
+
+TEST(StatisticsSnapshotTest, MalformedDataThrows) {
+	statistics stats;
+	stats.update(1);
+
+	std::string data = stats.snapshot().serialize();
+	ASSERT_THROW(statistics::snapshot_type::deserialize(data.substr(0, data.size() - 1)), std::invalid_argument);
+	ASSERT_THROW(statistics::snapshot_type::deserialize(data + "x"), std::invalid_argument);
+	ASSERT_THROW(statistics::snapshot_type::deserialize(std::string()), std::invalid_argument);
+}
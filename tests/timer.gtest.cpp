@@ -63,3 +63,111 @@ TEST(TimerTest, CheckNotStoppedTimerHasNoDuration) {
 	ASSERT_EQ(inter.values().get<handystats::statistics::tag::value>(), 0);
 }
 
+
+TEST(TimerTest, CheckIdleInstancesExpire) {
+	handystats::config::metrics::timer opts;
+	opts.idle_timeout = handystats::chrono::duration(100, handystats::chrono::time_unit::MSEC);
+
+	timer inter(opts);
+
+	auto timestamp = timer::clock::now();
+	for (timer::instance_id_type instance_id = 0; instance_id < 10000; ++instance_id) {
+		inter.start(instance_id, timestamp);
+	}
+	ASSERT_EQ(inter.instances_count(), 10000);
+
+	// half of instances are kept alive by heartbeats
+	for (int step = 0; step < 10; ++step) {
+		timestamp += handystats::chrono::duration(30, handystats::chrono::time_unit::MSEC);
+		for (timer::instance_id_type instance_id = 0; instance_id < 10000; instance_id += 2) {
+			inter.heartbeat(instance_id, timestamp);
+		}
+	}
+	ASSERT_EQ(inter.instances_count(), 5000);
+
+	for (timer::instance_id_type instance_id = 0; instance_id < 10000; ++instance_id) {
+		inter.stop(instance_id, timestamp);
+	}
+	ASSERT_EQ(inter.instances_count(), 0);
+	ASSERT_EQ(inter.values().get<handystats::statistics::tag::count>(), 5000);
+	ASSERT_NEAR(inter.values().get<handystats::statistics::tag::max>(),
+			handystats::chrono::duration::convert_to(timer::value_unit,
+				handystats::chrono::duration(300, handystats::chrono::time_unit::MSEC)).count(),
+			1
+		);
+
+	// instances expire without any further events of their own
+	for (timer::instance_id_type instance_id = 0; instance_id < 1000; ++instance_id) {
+		inter.start(instance_id, timestamp);
+	}
+	timestamp += handystats::chrono::duration(1, handystats::chrono::time_unit::HOUR);
+	inter.discard(timer::DEFAULT_INSTANCE_ID, timestamp);
+	ASSERT_EQ(inter.instances_count(), 0);
+}
+
+TEST(TimerTest, CheckInstancesSlotsAreReused) {
+	timer inter;
+
+	auto timestamp = timer::clock::now();
+	for (int round = 0; round < 100; ++round) {
+		for (timer::instance_id_type instance_id = 0; instance_id < 100; ++instance_id) {
+			inter.start(instance_id * 7919 + round, timestamp);
+		}
+		timestamp += handystats::chrono::duration(1, handystats::chrono::time_unit::MSEC);
+		for (timer::instance_id_type instance_id = 0; instance_id < 100; ++instance_id) {
+			inter.stop(instance_id * 7919 + round, timestamp);
+		}
+		ASSERT_EQ(inter.instances_count(), 0);
+	}
+
+	ASSERT_EQ(inter.values().get<handystats::statistics::tag::count>(), 10000);
+}
+
+TEST(TimerTest, CheckSlowestExemplarsAreKept) {
+	handystats::config::metrics::timer opts;
+	opts.exemplars = 3;
+	opts.values.moving_interval = handystats::chrono::duration(1, handystats::chrono::time_unit::SEC);
+
+	timer inter(opts);
+
+	auto timestamp = timer::clock::now();
+	for (int instance = 0; instance < 100; ++instance) {
+		// the slowest instances are 27, 54 and 81 (values 99, 98 and 97)
+		const int value = (instance * 37) % 100;
+		inter.start(instance, timestamp);
+		inter.stop(instance, timestamp + handystats::chrono::duration(value, handystats::chrono::time_unit::USEC));
+	}
+	inter.update_statistics(timestamp);
+
+	// tsc ticks conversion could be off by a microsecond
+	const auto& exemplars = inter.exemplars();
+	ASSERT_EQ(exemplars.size(), 3);
+	ASSERT_EQ(exemplars[0].instance_id, 27);
+	ASSERT_NEAR(exemplars[0].value.count(), 99, 1);
+	ASSERT_EQ(exemplars[1].instance_id, 54);
+	ASSERT_NEAR(exemplars[1].value.count(), 98, 1);
+	ASSERT_EQ(exemplars[2].instance_id, 81);
+	ASSERT_NEAR(exemplars[2].value.count(), 97, 1);
+
+	// exemplars older than moving interval are dropped
+	timestamp += handystats::chrono::duration(1500, handystats::chrono::time_unit::MSEC);
+	inter.set(handystats::chrono::duration(1, handystats::chrono::time_unit::USEC), timestamp, 1000);
+
+	ASSERT_EQ(inter.exemplars().size(), 1);
+	ASSERT_EQ(inter.exemplars()[0].instance_id, 1000);
+
+	timestamp += handystats::chrono::duration(3, handystats::chrono::time_unit::SEC);
+	inter.update_statistics(timestamp);
+
+	ASSERT_TRUE(inter.exemplars().empty());
+}
+
+TEST(TimerTest, CheckExemplarsAreDisabledByDefault) {
+	timer inter;
+
+	inter.set(handystats::chrono::duration(10, handystats::chrono::time_unit::USEC));
+	inter.start(1);
+	inter.stop(1);
+
+	ASSERT_TRUE(inter.exemplars().empty());
+}
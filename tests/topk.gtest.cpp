@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) YANDEX LLC. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+
+#include <string>
+#include <cmath>
+#include <random>
+#include <map>
+
+#include <gtest/gtest.h>
+
+#include <handystats/core.hpp>
+#include <handystats/measuring_points.hpp>
+#include <handystats/metrics_dump.hpp>
+#include <handystats/json_dump.hpp>
+#include <handystats/metrics/topk.hpp>
+
+#include "message_queue_helper.hpp"
+#include "metrics_dump_helper.hpp"
+
+using handystats::metrics::topk;
+
+TEST(TopkTest, ExactWithinCapacity) {
+	handystats::config::metrics::topk opts;
+	opts.capacity = 10;
+	opts.size = 3;
+
+	topk metric(opts);
+
+	for (int key = 0; key < 10; ++key) {
+		for (int times = 0; times <= key; ++times) {
+			metric.add("key-" + std::to_string(key));
+		}
+	}
+
+	ASSERT_DOUBLE_EQ(metric.total(), 55);
+
+	const topk::entries_type& top = metric.top();
+	ASSERT_EQ(top.size(), 3);
+	for (size_t index = 0; index < top.size(); ++index) {
+		ASSERT_EQ(top[index].key, "key-" + std::to_string(9 - index));
+		ASSERT_DOUBLE_EQ(top[index].count, 10 - index);
+		ASSERT_DOUBLE_EQ(top[index].error, 0);
+	}
+}
+
+TEST(TopkTest, NonPositiveWeightsAreIgnored) {
+	handystats::config::metrics::topk opts;
+	opts.capacity = 3;
+	opts.size = 3;
+
+	topk metric(opts);
+
+	metric.add("a", 5);
+	metric.add("b", 3);
+	metric.add("c", 1);
+
+	// negative weight would move "a" below the heap's minimum
+	metric.add("a", -10);
+	metric.add("b", 0);
+	metric.add("c", std::nan(""));
+
+	ASSERT_DOUBLE_EQ(metric.total(), 9);
+
+	// the minimal entry is still evicted
+	metric.add("d", 1);
+
+	const topk::entries_type& top = metric.top();
+	ASSERT_EQ(top.size(), 3);
+	ASSERT_EQ(top[0].key, "a");
+	ASSERT_DOUBLE_EQ(top[0].count, 5);
+	ASSERT_EQ(top[1].key, "b");
+	ASSERT_EQ(top[2].key, "d");
+	ASSERT_DOUBLE_EQ(top[2].count, 2);
+	ASSERT_DOUBLE_EQ(top[2].error, 1);
+}
+
+TEST(TopkTest, HeavyHittersWithinErrorBounds) {
+	handystats::config::metrics::topk opts;
+	opts.capacity = 50;
+	opts.size = 5;
+
+	topk metric(opts);
+
+	std::mt19937 gen(42);
+	std::uniform_int_distribution<int> noise_dist(0, 100000);
+	std::map<std::string, double> exact;
+
+	const size_t EVENTS_COUNT = 100000;
+	for (size_t index = 0; index < EVENTS_COUNT; ++index) {
+		std::string key;
+		double weight = 1;
+		if (index % 4 == 0) {
+			// 5 heavy keys with different weights
+			key = "heavy-" + std::to_string(index % 5);
+			weight = 1 + index % 5;
+		}
+		else {
+			key = "noise-" + std::to_string(noise_dist(gen));
+		}
+
+		metric.add(key, weight);
+		exact[key] += weight;
+	}
+
+	const topk::entries_type& top = metric.top();
+	ASSERT_EQ(top.size(), 5);
+
+	for (size_t index = 0; index < top.size(); ++index) {
+		ASSERT_EQ(top[index].key.substr(0, 6), "heavy-");
+
+		const double exact_count = exact[top[index].key];
+		// estimated count never underestimates and overestimates by at most error
+		ASSERT_GE(top[index].count, exact_count);
+		ASSERT_LE(top[index].count - top[index].error, exact_count);
+		// error is bounded by total / capacity
+		ASSERT_LE(top[index].error, metric.total() / opts.capacity);
+
+		if (index > 0) {
+			ASSERT_GE(top[index - 1].count, top[index].count);
+		}
+	}
+}
+
+TEST(TopkTest, MergeSummaries) {
+	handystats::config::metrics::topk opts;
+	opts.capacity = 20;
+	opts.size = 3;
+
+	topk left(opts), right(opts), single(opts);
+
+	for (int index = 0; index < 10000; ++index) {
+		const std::string& key = (index % 3 == 0) ? "hot-" + std::to_string(index % 2) : "cold-" + std::to_string(index);
+		if (index % 2) {
+			left.add(key);
+		}
+		else {
+			right.add(key);
+		}
+		single.add(key);
+	}
+
+	left.merge(right);
+
+	ASSERT_DOUBLE_EQ(left.total(), single.total());
+
+	const topk::entries_type& merged_top = left.top();
+	const topk::entries_type& single_top = single.top();
+	ASSERT_EQ(merged_top.size(), 3);
+
+	for (size_t index = 0; index < 2; ++index) {
+		ASSERT_EQ(merged_top[index].key.substr(0, 4), "hot-");
+		// each hot key is seen 1667 times (index % 6 == 0 or index % 6 == 3)
+		ASSERT_GE(merged_top[index].count, 1666);
+		ASSERT_LE(merged_top[index].count - merged_top[index].error, 1667);
+		ASSERT_EQ(merged_top[index].key.substr(0, 4), single_top[index].key.substr(0, 4));
+	}
+}
+
+class HandyTopkTest : public ::testing::Test {
+protected:
+	virtual void SetUp() {
+		HANDY_CONFIG_JSON(
+				"{\
+					\"dump-interval\": 10,\
+					\"topk\": {\
+						\"capacity\": 20,\
+						\"size\": 2\
+					}\
+				}"
+			);
+
+		HANDY_INIT();
+	}
+	virtual void TearDown() {
+		HANDY_FINALIZE();
+	}
+};
+
+TEST_F(HandyTopkTest, TopkMeasuringPoints) {
+	for (int request = 0; request < 1000; ++request) {
+		HANDY_TOPK_ADD("clients", "client-" + std::to_string(request % 10), request % 10);
+	}
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	auto metrics_dump = HANDY_METRICS_DUMP();
+
+	ASSERT_TRUE(metrics_dump->find("clients") != metrics_dump->end());
+	const auto& clients = boost::get<topk>(metrics_dump->at("clients"));
+	ASSERT_DOUBLE_EQ(clients.total(), 4500);
+
+	const topk::entries_type& top = clients.top();
+	ASSERT_EQ(top.size(), 2);
+	ASSERT_EQ(top[0].key, "client-9");
+	ASSERT_DOUBLE_EQ(top[0].count, 900);
+	ASSERT_EQ(top[1].key, "client-8");
+
+	const std::string& json_dump = HANDY_JSON_DUMP();
+	ASSERT_TRUE(json_dump.find("\"topk\"") != std::string::npos);
+	ASSERT_TRUE(json_dump.find("\"client-9\"") != std::string::npos);
+}
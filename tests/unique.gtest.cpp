@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) YANDEX LLC. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+#include <string>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include <handystats/core.hpp>
+#include <handystats/measuring_points.hpp>
+#include <handystats/metrics_dump.hpp>
+#include <handystats/json_dump.hpp>
+#include <handystats/metrics/unique.hpp>
+
+#include "message_queue_helper.hpp"
+#include "metrics_dump_helper.hpp"
+
+using handystats::metrics::unique;
+
+TEST(UniqueTest, EstimateWithinError) {
+	handystats::config::metrics::unique opts;
+	opts.precision = 12;
+	opts.moving_interval = handystats::chrono::duration(1, handystats::chrono::time_unit::HOUR);
+
+	unique metric(opts);
+
+	const auto timestamp = unique::clock::now();
+	const uint64_t KEYS_COUNT = 100000;
+	for (uint64_t key = 0; key < KEYS_COUNT; ++key) {
+		// each key is added several times
+		metric.add(key, timestamp);
+		metric.add(key, timestamp);
+		metric.add(key % 100, timestamp);
+	}
+
+	// standard error for precision 12 is about 1.6%
+	ASSERT_NEAR(metric.estimate(), KEYS_COUNT, 0.05 * KEYS_COUNT);
+	ASSERT_NEAR(metric.total(), KEYS_COUNT, 0.05 * KEYS_COUNT);
+}
+
+TEST(UniqueTest, SmallCardinality) {
+	unique metric;
+
+	const auto timestamp = unique::clock::now();
+	for (uint64_t key = 0; key < 10; ++key) {
+		metric.add(key, timestamp);
+	}
+
+	ASSERT_NEAR(metric.estimate(), 10, 1);
+	ASSERT_NEAR(metric.total(), 10, 1);
+}
+
+TEST(UniqueTest, MovingIntervalExpiration) {
+	handystats::config::metrics::unique opts;
+	opts.moving_interval = handystats::chrono::duration(100, handystats::chrono::time_unit::MSEC);
+
+	unique metric(opts);
+
+	auto timestamp = unique::clock::now();
+	for (uint64_t key = 0; key < 1000; ++key) {
+		metric.add(key, timestamp);
+	}
+	ASSERT_NEAR(metric.estimate(), 1000, 100);
+
+	timestamp += handystats::chrono::duration(1, handystats::chrono::time_unit::SEC);
+	for (uint64_t key = 1000; key < 1100; ++key) {
+		metric.add(key, timestamp);
+	}
+
+	// keys added before moving interval are forgotten
+	ASSERT_NEAR(metric.estimate(), 100, 10);
+	ASSERT_NEAR(metric.total(), 1100, 110);
+
+	timestamp += handystats::chrono::duration(1, handystats::chrono::time_unit::SEC);
+	metric.update_statistics(timestamp);
+
+	ASSERT_DOUBLE_EQ(metric.estimate(), 0);
+	ASSERT_NEAR(metric.total(), 1100, 110);
+}
+
+TEST(UniqueTest, MergeOverlappingSets) {
+	handystats::config::metrics::unique opts;
+	opts.precision = 12;
+	opts.moving_interval = handystats::chrono::duration(1, handystats::chrono::time_unit::HOUR);
+
+	unique left(opts), right(opts);
+
+	const auto timestamp = unique::clock::now();
+	for (uint64_t key = 0; key < 20000; ++key) {
+		left.add(key, timestamp);
+	}
+	for (uint64_t key = 10000; key < 30000; ++key) {
+		right.add(key, timestamp);
+	}
+
+	left.merge(right);
+
+	ASSERT_NEAR(left.estimate(), 30000, 0.05 * 30000);
+	ASSERT_NEAR(left.total(), 30000, 0.05 * 30000);
+
+	handystats::config::metrics::unique other_opts;
+	other_opts.precision = 8;
+	ASSERT_THROW(left.merge(unique(other_opts)), unique::incompatible_error);
+}
+
+TEST(UniqueTest, PrecisionIsBounded) {
+	handystats::config::metrics::unique opts;
+	opts.precision = 16;
+
+	// sketches of higher precision would take hundreds of KB per metric
+	ASSERT_EQ(unique(opts).precision(), unique::MAX_PRECISION);
+}
+
+class HandyUniqueTest : public ::testing::Test {
+protected:
+	virtual void SetUp() {
+		HANDY_CONFIG_JSON(
+				"{\
+					\"dump-interval\": 10,\
+					\"unique\": {\
+						\"precision\": 12,\
+						\"moving-interval\": 60000\
+					}\
+				}"
+			);
+
+		HANDY_INIT();
+	}
+	virtual void TearDown() {
+		HANDY_FINALIZE();
+	}
+};
+
+TEST_F(HandyUniqueTest, UniqueMeasuringPoints) {
+	for (int user = 0; user < 1000; ++user) {
+		HANDY_UNIQUE_ADD("users", "user-" + std::to_string(user % 500));
+		HANDY_UNIQUE_ADD("ids", uint64_t(user));
+	}
+
+	handystats::message_queue::wait_until_empty();
+	handystats::metrics_dump::wait_until(handystats::chrono::system_clock::now());
+
+	auto metrics_dump = HANDY_METRICS_DUMP();
+
+	ASSERT_TRUE(metrics_dump->find("users") != metrics_dump->end());
+	const auto& users = boost::get<unique>(metrics_dump->at("users"));
+	ASSERT_EQ(users.precision(), 12);
+	ASSERT_NEAR(users.estimate(), 500, 15);
+
+	ASSERT_TRUE(metrics_dump->find("ids") != metrics_dump->end());
+	ASSERT_NEAR(boost::get<unique>(metrics_dump->at("ids")).estimate(), 1000, 30);
+
+	const std::string& json_dump = HANDY_JSON_DUMP();
+	ASSERT_TRUE(json_dump.find("\"unique\"") != std::string::npos);
+	ASSERT_TRUE(json_dump.find("\"estimate\"") != std::string::npos);
+}
@@ -0,0 +1,192 @@
+/*
+* Copyright (c) YANDEX LLC. All rights reserved.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.
+*/
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <exception>
+
+#include <unistd.h>
+
+#include <handystats/binary_dump.hpp>
+#include <handystats/shared_dump.hpp>
+
+/*
+ * Reads dumps published by handystats into shared memory segment ("dump-shared-memory" option)
+ * and prints them in text form, one metric per line.
+ */
+
+static const char* const TYPE_NAMES[] = {"counter", "gauge", "timer", "attribute", "unique", "topk", "span"};
+
+static const handystats::statistics::tag::type DOUBLE_TAGS[] = {
+	handystats::statistics::tag::value,
+	handystats::statistics::tag::min,
+	handystats::statistics::tag::max,
+	handystats::statistics::tag::sum,
+	handystats::statistics::tag::avg,
+	handystats::statistics::tag::moving_count,
+	handystats::statistics::tag::moving_sum,
+	handystats::statistics::tag::moving_avg,
+	handystats::statistics::tag::rate,
+	handystats::statistics::tag::entropy
+};
+
+static const char* const DOUBLE_TAG_NAMES[] = {
+	"value", "min", "max", "sum", "avg", "moving-count", "moving-sum", "moving-avg", "rate", "entropy"
+};
+
+static void print_statistics(const handystats::binary::statistics_view& values, const std::string& prefix) {
+	for (size_t index = 0; index < sizeof(DOUBLE_TAGS) / sizeof(*DOUBLE_TAGS); ++index) {
+		if (values.enabled(DOUBLE_TAGS[index])) {
+			std::cout << " " << prefix << DOUBLE_TAG_NAMES[index] << "=" << values.get(DOUBLE_TAGS[index]);
+		}
+	}
+	if (values.enabled(handystats::statistics::tag::count)) {
+		std::cout << " " << prefix << "count=" << values.count();
+	}
+	if (values.enabled(handystats::statistics::tag::quantile)) {
+		for (size_t index = 0; index < handystats::binary::statistics_view::QUANTILES_COUNT; ++index) {
+			std::cout << " " << prefix << "p" << int(handystats::binary::statistics_view::QUANTILES[index] * 100 + 0.5)
+				<< "=" << values.quantile(index);
+		}
+	}
+	if (values.enabled(handystats::statistics::tag::timestamp)) {
+		std::cout << " " << prefix << "timestamp=" << values.timestamp();
+	}
+}
+
+struct attribute_printer : public boost::static_visitor<void> {
+	template <typename T>
+	void operator() (const T& value) const {
+		std::cout << " value=" << value;
+	}
+	void operator() (const bool& value) const {
+		std::cout << " value=" << (value ? "true" : "false");
+	}
+};
+
+static void print_dump(const std::string& buffer) {
+	const handystats::binary::reader dump(buffer);
+
+	std::cout << "# version " << dump.version() << ", timestamp " << dump.timestamp() << std::endl;
+
+	for (size_t index = 0; index < dump.size(); ++index) {
+		const handystats::binary::metric_view& metric = dump[index];
+
+		std::cout << metric.name() << " " << TYPE_NAMES[metric.type()];
+
+		switch (metric.type()) {
+			case handystats::metrics::metric_index::GAUGE:
+			case handystats::metrics::metric_index::COUNTER:
+			case handystats::metrics::metric_index::TIMER:
+				print_statistics(metric.values(), "");
+				break;
+			case handystats::metrics::metric_index::ATTRIBUTE:
+				boost::apply_visitor(attribute_printer(), metric.attribute_value());
+				break;
+			case handystats::metrics::metric_index::UNIQUE:
+				std::cout << " estimate=" << metric.estimate() << " total=" << metric.total();
+				break;
+			case handystats::metrics::metric_index::TOPK:
+				{
+					std::cout << " total=" << metric.total();
+					const auto& top = metric.top();
+					for (auto entry = top.begin(); entry != top.end(); ++entry) {
+						std::cout << " " << std::string(entry->key_data, entry->key_size) << "=" << entry->count;
+					}
+					break;
+				}
+			case handystats::metrics::metric_index::SPAN:
+				print_statistics(metric.inclusive(), "inclusive.");
+				print_statistics(metric.self(), "self.");
+				break;
+		}
+
+		std::cout << std::endl;
+	}
+}
+
+static void usage(const char* program) {
+	std::cerr << "Usage: " << program << " [-r] [-f] [-i <interval in msec>] <segment path>" << std::endl
+		<< "  -r  write raw binary dump to stdout" << std::endl
+		<< "  -f  follow the segment and print every new dump" << std::endl
+		<< "  -i  polling interval for -f, 100 msec by default" << std::endl;
+}
+
+int main(int argc, char** argv) {
+	bool raw = false;
+	bool follow = false;
+	int interval = 100;
+
+	int option;
+	while ((option = getopt(argc, argv, "rfi:h")) != -1) {
+		switch (option) {
+			case 'r':
+				raw = true;
+				break;
+			case 'f':
+				follow = true;
+				break;
+			case 'i':
+				interval = std::stoi(optarg);
+				break;
+			default:
+				usage(argv[0]);
+				return 2;
+		}
+	}
+
+	if (optind + 1 != argc) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	try {
+		handystats::shared_dump::reader reader(argv[optind]);
+		std::string buffer;
+		uint64_t last_version = 0;
+
+		while (true) {
+			if (reader.read(buffer) && reader.version() != last_version) {
+				last_version = reader.version();
+
+				if (raw) {
+					std::cout.write(buffer.data(), buffer.size());
+				}
+				else {
+					print_dump(buffer);
+				}
+				std::cout.flush();
+
+				if (!follow) {
+					return 0;
+				}
+			}
+			else if (!follow) {
+				std::cerr << "No dump is published to " << argv[optind] << std::endl;
+				return 1;
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+		}
+	}
+	catch (const std::exception& error) {
+		std::cerr << error.what() << std::endl;
+		return 1;
+	}
+}